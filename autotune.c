@@ -0,0 +1,31 @@
+#include "./include/base.h"
+#include "./include/tune.h"
+
+/*
+slach_autotune [-q] [file]: benchmark the tunable parameters on this machine and store them
+under the CPU model in file (default: SLACH_TUNE_FILE, else $HOME/.slach_tune), where the
+library picks them up on its next start. -q runs the quick, smaller benchmarks.
+ */
+int main(int argc, char** argv){
+    char model[256];
+    const char* path = NULL;
+    const SlachTune* t;
+    int quick = 0, i;
+    for (i=1; i<argc; i++){
+        if (strcmp(argv[i], "-q") == 0) quick = 1;
+        else path = argv[i];
+    }
+    slach_cpu_model(model, sizeof(model));
+    printf("tuning for %s ...\n", model);
+    if (slach_autotune(path, quick) != 0){
+        fprintf(stderr, "cannot write the tuning file\n");
+        return 1;
+    }
+    t = slach_tune();
+    printf("gemm_mc = %zu\ngemm_kc = %zu\ngemm_nc = %zu\n", t->gemmMC, t->gemmKC, t->gemmNC);
+    printf("transpose_block = %zu\nstrassen_cutoff = %zu\nstrassen_auto_min = %zu\n",
+           t->transposeBlock, t->strassenCutoff, t->strassenAutoMin);
+    printf("syrk_block = %zu\ntrsm_block = %zu\nlu_block = %zu\n", t->syrkBlock, t->trsmBlock, t->luBlock);
+    printf("par_min = %zu\nmap_par_min = %zu\n", t->parMin, t->mapParMin);
+    return 0;
+}
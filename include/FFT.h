@@ -58,6 +58,7 @@ void fftPhase(float* src, size_t len1, float* dest, size_t len2, int N1, int N2)
 void fftshift(float* src, int len, int N);
 complex* DFT_naive(complex* x, int N);
 complex* FFT_CooleyTukey(complex* input, int N, int N1, int N2);
+void fftRadix2(complex* x, int N, int inverse);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,122 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef GEMM_H_
+#define GEMM_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+#include "operation.h"
+#include "TRSM.h"
+
+/*
+GEMM epilogue, applied to each output tile before it leaves registers:
+    C = op(alpha*A*B + beta*C + colBias + rowBias)
+colBias: column vector, length = rows of C, colBias[i] is added to row i (NULL: none)
+rowBias: row vector, length = cols of C, rowBias[j] is added to column j (NULL: none)
+op: element-wise function (EW_* in operation.h), order is the exponent of EW_POW
+When beta == 0, C is never read, so it may hold garbage.
+*/
+typedef struct _GemmEpilogue_{
+    float alpha;
+    float beta;
+    float* colBias;
+    float* rowBias;
+    EwOp op;
+    double order;
+}GemmEpilogue;
+
+void gemmEpilogueInit(OUT GemmEpilogue* ep); //alpha=1, beta=0, no bias, no op
+
+/*
+blocked GEMM engine on row-major arrays with leading dimensions:
+C(m x n) = epilogue(op(A)(m x k) * op(B)(k x n)), op(X) = X^T when trans is 1
+In the reproducible mode (slach_set_reproducible) every element is accumulated in double in
+k order and rounded once by the epilogue, about 5x slower than the packed float kernel;
+mmMul never picks Strassen automatically then.
+*/
+void gemmEx(int transA, int transB, size_t m, size_t n, size_t k,
+            IN float* A, size_t lda, IN float* B, size_t ldb,
+            INOUT float* C, size_t ldc, IN GemmEpilogue* ep);
+/*
+Strassen-Winograd GEMM, same contract as gemmEx: recurses on the largest products and
+falls back to gemmEx below a cutoff. Its error bound is normwise rather than
+componentwise, see src/strassen.c. mmMul and mmMulEx pick the algorithm from
+gemmSetAlgo(): GEMM_ALGO_AUTO (default) uses Strassen only when every dimension is
+very large; gemmEx and the BLAS interface are always classical.
+*/
+typedef enum _GemmAlgo_{
+    GEMM_ALGO_AUTO = 0,
+    GEMM_ALGO_CLASSIC,
+    GEMM_ALGO_STRASSEN
+}GemmAlgo;
+
+void gemmStrassen(int transA, int transB, size_t m, size_t n, size_t k,
+                  IN float* A, size_t lda, IN float* B, size_t ldb,
+                  INOUT float* C, size_t ldc, IN GemmEpilogue* ep);
+void gemmSetAlgo(GemmAlgo algo);
+GemmAlgo gemmGetAlgo(void);
+int gemmUseStrassen(size_t m, size_t n, size_t k);
+
+/*
+symmetric rank-k update on the GEMM engine, only the uplo (SLACH_UPPER/SLACH_LOWER) triangle
+of C (n x n) is computed, about half the flops of gemmEx:
+ trans == 0: C = alpha*A*A^T + beta*C, A is n x k
+ trans == 1: C = alpha*A^T*A + beta*C, A is k x n
+mirror == 1 copies the triangle to the other one, otherwise the other triangle is untouched.
+*/
+void syrkEx(int uplo, int trans, size_t n, size_t k, float alpha, IN float* A, size_t lda,
+            float beta, INOUT float* C, size_t ldc, int mirror);
+//dest (col x col) = arr^T*arr through syrkEx
+void mGram(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
+
+/*
+matrix*matrix with epilogue, dest is also read when ep->beta != 0
+*/
+void mmMulEx(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+             IN GemmEpilogue* ep, INOUT float* dest, size_t height, size_t width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef GEMV_H_
+#define GEMV_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+matrix*vector on a row-major array with a leading dimension, A is m x n:
+ trans == 0: y (len m) = alpha*A*x + beta*y
+ trans == 1: y (len n) = alpha*A^T*x + beta*y
+A is streamed exactly once; large problems are split over the thread pool by row blocks.
+When beta == 0, y is never read, so it may hold garbage. y must not overlap A or x.
+In the reproducible mode (slach_set_reproducible) each entry of y is summed in double in a
+fixed order and threads only split the entries, about 3x slower.
+*/
+void gemvEx(int trans, size_t m, size_t n, float alpha, IN float* A, size_t lda,
+            IN float* x, float beta, INOUT float* y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
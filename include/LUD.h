@@ -57,6 +57,25 @@ void LUsolvev(INOUT float* arr1, size_t row, size_t col, INOUT float* arr2, size
 inverse of matrix based on LU decomposition
 */
 void inv(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
+/*
+reusable LU factorization: LUfactor does the O(n^3) work once (PA = LU, partial pivoting) and
+every solve against it is two triangular solves, O(n^2) per right-hand side. trans = 1 solves
+A^T x = b with the same factors. A singular matrix is only reported by the solves (or
+LUfactorSingular), so the factors can still be inspected. The functions above run on it.
+*/
+typedef struct _SlachLU_ SlachLU;
+
+SlachLU* LUfactor(IN float* arr, size_t row, size_t col);
+void LUfactorDestroy(SlachLU* lu);
+size_t LUfactorSize(const SlachLU* lu);
+int LUfactorSingular(const SlachLU* lu);
+void LUfactorSolvev(const SlachLU* lu, int trans, IN float* arr, size_t len1, OUT float* dest, size_t len2);
+void LUfactorSolvem(const SlachLU* lu, int trans, IN float* arr, size_t row, size_t col,
+                    OUT float* dest, size_t height, size_t width);
+void LUfactorL(const SlachLU* lu, OUT float* dest, size_t height, size_t width);
+void LUfactorU(const SlachLU* lu, OUT float* dest, size_t height, size_t width);
+//P as an n x n matrix and/or as row indices (row i of PA is row piv[i] of A); either may be NULL
+void LUfactorP(const SlachLU* lu, OUT float* dest, size_t height, size_t width, OUT size_t* piv);
 
 
 #ifdef __cplusplus
@@ -45,7 +45,8 @@ limitations under the License.
 #endif
 #include "base.h"
 /*
-QR decomposition and solve linear equations
+QR decomposition and solve linear equations. The matrix can be tall (row >= col): getQ is then
+row x col, getR col x col, and QRsolvev/QRsolvem return the least squares solution.
 */
 void getQ(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
 void getR(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
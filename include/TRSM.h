@@ -0,0 +1,74 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef TRSM_H_
+#define TRSM_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+triangular solve and multiply on row-major arrays with leading dimensions. A is triangular
+(only its uplo triangle is read, and its diagonal is taken as 1 when diag is SLACH_UNIT),
+op(A) = A^T when transA is 1. B is m x n and is overwritten by the result:
+ trsmEx: op(A)*X = alpha*B (side SLACH_LEFT, A is m x m) or X*op(A) = alpha*B (SLACH_RIGHT, A is n x n)
+ trmmEx: B = alpha*op(A)*B (SLACH_LEFT) or B = alpha*B*op(A) (SLACH_RIGHT)
+Both walk A in diagonal blocks: only the small diagonal blocks are handled by a triangular
+kernel, every off-diagonal block is a gemmEx update. A singular A is not detected.
+*/
+#define SLACH_LEFT 0
+#define SLACH_RIGHT 1
+#define SLACH_UPPER 0
+#define SLACH_LOWER 1
+#define SLACH_NON_UNIT 0
+#define SLACH_UNIT 1
+
+void trsmEx(int side, int uplo, int transA, int diag, size_t m, size_t n, float alpha,
+            IN float* A, size_t lda, INOUT float* B, size_t ldb);
+void trmmEx(int side, int uplo, int transA, int diag, size_t m, size_t n, float alpha,
+            IN float* A, size_t lda, INOUT float* B, size_t ldb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef ASYNC_H_
+#define ASYNC_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+#include "parallel.h"
+#include "FFT.h"
+#include "GEMM.h"
+
+/*
+asynchronous front end: a submission returns at once with a handle and runs on the thread
+pool (or on the executor set by slach_set_executor) as soon as every task in deps has
+completed. Independent submissions from any number of threads overlap on the pool; a kernel
+inside a task still splits its own loops over the pool. Without worker threads (one thread,
+or -DSLACH_NO_THREADS) a submission runs before it returns.
+ *the arrays of a submission must stay valid and must not be written by anyone else until it
+  completes; tasks that write the same array must be ordered by deps.
+ *slach_on_complete callbacks run on the thread that completes the task, after the task and
+  before its dependents start; a callback added to a completed task runs at once.
+ *slach_wait returns after the task and its callbacks; a waiting thread runs pending pool
+  work meanwhile, so waiting inside a task is safe.
+ *every handle is released once with slach_release, done or not; a released task still runs.
+*/
+typedef struct _SlachTask_ SlachTask;
+
+SlachTask* slach_submit(slachTaskFn fn, void* arg, IN SlachTask* const* deps, size_t nDeps);
+SlachTask* slach_submit_LUsolvem(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+                                 OUT float* dest, size_t height, size_t width,
+                                 IN SlachTask* const* deps, size_t nDeps);
+//*output receives the result of FFT_CooleyTukey, freed by the caller
+SlachTask* slach_submit_FFT_CooleyTukey(IN complex* input, int N, int N1, int N2, OUT complex** output,
+                                        IN SlachTask* const* deps, size_t nDeps);
+//ep is copied, its bias arrays are read when the task runs
+SlachTask* slach_submit_gemmEx(int transA, int transB, size_t m, size_t n, size_t k,
+                               IN float* A, size_t lda, IN float* B, size_t ldb,
+                               INOUT float* C, size_t ldc, IN GemmEpilogue* ep,
+                               IN SlachTask* const* deps, size_t nDeps);
+void slach_on_complete(SlachTask* t, slachTaskFn fn, void* arg);
+int slach_test(SlachTask* t); //1 when the task and its callbacks are done
+void slach_wait(SlachTask* t);
+void slach_release(SlachTask* t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
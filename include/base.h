@@ -62,7 +62,7 @@ some useful memory control functions: slach_malloc(type, size), slach_free(ptr)
 #define slach_malloc_(type, size) _slach_malloc_(size, sizeof(type))
 #define slach_malloc(type, size) (type*)slach_malloc_(type, size)
 #define slach_free(ptr) _slach_free(ptr)
-void* _slach_malloc(size_t size);
+void* _slach_malloc_(size_t n, size_t size);
 void _slach_free(void* ptr);
 
 /*
@@ -108,7 +108,7 @@ void swap(float* x, float* y);
 /*
 Base types
 */
-//The Matrix base
+//The Matrix base. Rows are stored contiguously: mData[0] is the whole row-major array
 typedef struct _Matrix_
 {
     size_t mHeight;
@@ -122,6 +122,8 @@ void copyMatrix(IN Matrix* src, OUT Matrix* dest);
 void arrayToMatrix(IN float* src, OUT Matrix* dest, size_t height, size_t weight);
 void matrixToArray(IN Matrix* src, OUT float* dest, size_t height, size_t weight);
 void matrixToArrayWithoutFree(IN Matrix* src, OUT float* dest, size_t height, size_t width);
+Matrix* _assignm(size_t row, size_t col, float num); //private: matrix filled with num
+Matrix* _eyem(size_t n); //private: identity matrix
 
 //The Vector base
 typedef struct _Vector_
@@ -0,0 +1,86 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+batched small-matrix kernels for many independent problems of the same shape (3x3 ... 16x16).
+No Matrix is created per problem: matrices are interleaved across SIMD lanes (lane l holds
+problem l of a group) and groups are spread over the thread pool.
+Two ways to pass a batch:
+ *Strided: problem b starts at base + b*stride
+ *Ptr:     problem b starts at ptrs[b]
+All matrices are row-major with a leading dimension.
+*/
+
+//C_b = alpha*op(A_b)*op(B_b) + beta*C_b, C_b is m x n
+void gemmBatchStrided(int transA, int transB, size_t m, size_t n, size_t k, float alpha,
+                      IN float* A, size_t lda, size_t strideA, IN float* B, size_t ldb, size_t strideB,
+                      float beta, INOUT float* C, size_t ldc, size_t strideC, size_t batch);
+void gemmBatchPtr(int transA, int transB, size_t m, size_t n, size_t k, float alpha,
+                  IN float** A, size_t lda, IN float** B, size_t ldb,
+                  float beta, INOUT float** C, size_t ldc, size_t batch);
+
+//y_b = alpha*op(A_b)*x_b + beta*y_b, A_b is m x n
+void gemvBatchStrided(int trans, size_t m, size_t n, float alpha, IN float* A, size_t lda, size_t strideA,
+                      IN float* x, size_t strideX, float beta, INOUT float* y, size_t strideY, size_t batch);
+void gemvBatchPtr(int trans, size_t m, size_t n, float alpha, IN float** A, size_t lda,
+                  IN float** x, float beta, INOUT float** y, size_t batch);
+
+/*
+A_b X_b = B_b with partial pivoting, A_b is n x n (lda = n), B_b is n x nrhs (ldb = nrhs).
+A_b is overwritten by its LU factors and B_b by X_b.
+info (may be NULL): info[b] = 0 on success, j+1 when the j-th pivot of problem b is zero
+*/
+void LUsolveBatchStrided(size_t n, size_t nrhs, INOUT float* A, size_t strideA,
+                         INOUT float* B, size_t strideB, OUT int* info, size_t batch);
+void LUsolveBatchPtr(size_t n, size_t nrhs, INOUT float** A, INOUT float** B, OUT int* info, size_t batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef BLAS_H_
+#define BLAS_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+#include "TRSM.h"
+
+/*
+BLAS-shaped interface on the slach kernels. Matrices are row-major with a leading
+dimension (the CBLAS row-major convention); vectors take a BLAS increment, a negative
+increment walks the vector backwards. Flags (side, uplo and diag come from TRSM.h):
+*/
+#define SLACH_NO_TRANS 0
+#define SLACH_TRANS 1
+
+//Level 1
+void slach_saxpy(size_t n, float alpha, IN float* x, int incx, INOUT float* y, int incy); //y += alpha*x
+void slach_sscal(size_t n, float alpha, INOUT float* x, int incx);                        //x = alpha*x
+float slach_sdot(size_t n, IN float* x, int incx, IN float* y, int incy);
+float slach_snrm2(size_t n, IN float* x, int incx);
+
+//Level 2, A is m x n
+//y = alpha*op(A)*x + beta*y
+void slach_sgemv(int trans, size_t m, size_t n, float alpha, IN float* A, size_t lda,
+                 IN float* x, int incx, float beta, INOUT float* y, int incy);
+//A += alpha*x*y^T
+void slach_sger(size_t m, size_t n, float alpha, IN float* x, int incx, IN float* y, int incy,
+                INOUT float* A, size_t lda);
+//A += alpha*x*x^T, only the uplo triangle of the n x n matrix A is referenced
+void slach_ssyr(int uplo, size_t n, float alpha, IN float* x, int incx, INOUT float* A, size_t lda);
+
+//Level 3, C (m x n) = alpha*op(A)*op(B) + beta*C
+void slach_sgemm(int transA, int transB, size_t m, size_t n, size_t k, float alpha,
+                 IN float* A, size_t lda, IN float* B, size_t ldb, float beta, INOUT float* C, size_t ldc);
+//C (n x n) = alpha*op(A)*op(A)^T + beta*C, only the uplo triangle of C is referenced
+void slach_ssyrk(int uplo, int trans, size_t n, size_t k, float alpha, IN float* A, size_t lda,
+                 float beta, INOUT float* C, size_t ldc);
+//op(A)*X = alpha*B or X*op(A) = alpha*B, X overwrites B (m x n)
+void slach_strsm(int side, int uplo, int transA, int diag, size_t m, size_t n, float alpha,
+                 IN float* A, size_t lda, INOUT float* B, size_t ldb);
+//B = alpha*op(A)*B or B = alpha*B*op(A)
+void slach_strmm(int side, int uplo, int transA, int diag, size_t m, size_t n, float alpha,
+                 IN float* A, size_t lda, INOUT float* B, size_t ldb);
+
+/*
+Build with -DSLACH_BLAS_COMPAT to also export the Fortran reference BLAS symbols
+(saxpy_, sscal_, sdot_, snrm2_, sgemv_, sger_, ssyr_, sgemm_, ssyrk_, strsm_, strmm_), so slach can be linked
+in place of a reference BLAS. They take column-major matrices and map onto the row-major
+routines above by swapping operands; no data is transposed.
+*/
+#ifdef SLACH_BLAS_COMPAT
+void saxpy_(int* n, float* alpha, float* x, int* incx, float* y, int* incy);
+void sscal_(int* n, float* alpha, float* x, int* incx);
+float sdot_(int* n, float* x, int* incx, float* y, int* incy);
+float snrm2_(int* n, float* x, int* incx);
+void sgemv_(char* trans, int* m, int* n, float* alpha, float* A, int* lda,
+            float* x, int* incx, float* beta, float* y, int* incy);
+void sger_(int* m, int* n, float* alpha, float* x, int* incx, float* y, int* incy, float* A, int* lda);
+void ssyr_(char* uplo, int* n, float* alpha, float* x, int* incx, float* A, int* lda);
+void sgemm_(char* transA, char* transB, int* m, int* n, int* k, float* alpha, float* A, int* lda,
+            float* B, int* ldb, float* beta, float* C, int* ldc);
+void ssyrk_(char* uplo, char* trans, int* n, int* k, float* alpha, float* A, int* lda,
+            float* beta, float* C, int* ldc);
+void strsm_(char* side, char* uplo, char* transA, char* diag, int* m, int* n, float* alpha,
+            float* A, int* lda, float* B, int* ldb);
+void strmm_(char* side, char* uplo, char* transA, char* diag, int* m, int* n, float* alpha,
+            float* A, int* lda, float* B, int* ldb);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef CONV_H_
+#define CONV_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+2-D convolution of a C x H x W input with K kernels of C x kh x kw, all row-major and packed,
+into a K x OH x OW output where OH = conv2dOutSize(H, kh, stride, pad) and likewise for OW.
+Padding is zero on every side. flip = 0 correlates (the deep learning convention), flip = 1
+flips the kernels for a true convolution. bias is one value per output channel or NULL.
+Three algorithms:
+ CONV_GEMM: implicit im2col, the unrolled input is built one block of output pixels at a time
+            in a cache-sized panel and multiplied by gemmEx, bias in the epilogue
+ CONV_DIRECT: SIMD multiply-adds along output rows, for few kernels or a shallow C*kh*kw
+ CONV_FFT: products of 2-D radix-2 spectra, for large kernels at stride 1
+CONV_AUTO picks one from the shapes.
+*/
+typedef enum _ConvAlgo_{
+    CONV_AUTO = 0,
+    CONV_GEMM,
+    CONV_DIRECT,
+    CONV_FFT
+}ConvAlgo;
+
+size_t conv2dOutSize(size_t n, size_t k, size_t stride, size_t pad);
+void conv2dEx(ConvAlgo algo, int flip, size_t C, size_t H, size_t W, IN float* in,
+              size_t K, size_t kh, size_t kw, IN float* kernel, IN float* bias,
+              size_t stride, size_t pad, OUT float* out);
+//single channel forms on arrays
+void conv2d(INOUT float* arr, size_t row, size_t col, INOUT float* kernel, size_t kh, size_t kw,
+            size_t stride, size_t pad, OUT float* dest, size_t height, size_t width);
+void corr2d(INOUT float* arr, size_t row, size_t col, INOUT float* kernel, size_t kh, size_t kw,
+            size_t stride, size_t pad, OUT float* dest, size_t height, size_t width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef DISTANCE_H_
+#define DISTANCE_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+pairwise distances between the rows of X (m x d) and of Y (n x d), row-major with leading
+dimensions. Squared Euclidean distances are |x|^2 + |y|^2 - 2 x.y: the products come from
+gemmEx on tiles of the distance matrix, the norms enter through the epilogue biases, and the
+clamping at 0 (rounding can make a distance slightly negative), the square root or the
+cosine scaling run on each tile while it is still in cache. Cosine distance is 1 - x.y/(|x||y|),
+1 when either row is zero.
+knnEx streams over tiles of Y and keeps a heap of the k nearest rows of Y for every row of X,
+so the m x n matrix is never stored. Neighbours are sorted by distance, ties by index.
+*/
+typedef enum _DistMetric_{
+    DIST_SQEUCLIDEAN = 0,
+    DIST_EUCLIDEAN,
+    DIST_COSINE
+}DistMetric;
+
+void pdistEx(DistMetric metric, size_t m, size_t n, size_t d, IN float* X, size_t ldx,
+             IN float* Y, size_t ldy, OUT float* D, size_t ldd);
+void pdist(DistMetric metric, INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+           OUT float* dest, size_t height, size_t width);
+//dist and idx are m x k: row i holds the k nearest rows of Y to row i of X
+void knnEx(DistMetric metric, size_t m, size_t n, size_t d, IN float* X, size_t ldx,
+           IN float* Y, size_t ldy, size_t k, OUT float* dist, OUT size_t* idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
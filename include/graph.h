@@ -0,0 +1,83 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef GRAPH_H_
+#define GRAPH_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+#include "operation.h"
+
+/*
+deferred computation graph. The slach_lazy_* calls record operations on row-major matrices
+and return a node id instead of computing anything; slach_eval runs the whole graph:
+ *fusion: element-wise nodes that only feed each other run as one pass over cache-sized
+  tiles; a scale, an added matrix, row or column vector and one EwOp after a product go
+  into the GEMM epilogue; a transpose that feeds a product becomes a trans flag.
+ *buffers: intermediates live in a pool of buffers planned from their last use, an
+  element-wise node or the added matrix of a product overwrites its dying input in place,
+  and results marked by slach_lazy_output are computed directly into their destination.
+ *scheduling: nodes whose inputs are ready run together on the thread pool.
+Shapes are checked when a node is recorded. The input arrays are read at every slach_eval,
+so a graph can be evaluated again after they changed, but no node can be added to an
+evaluated graph. slach_eval returns the floats held by the buffer pool.
+*/
+typedef struct _SlachGraph_ SlachGraph;
+
+SlachGraph* slach_graph_create(void);
+void slach_graph_destroy(SlachGraph* g);
+int slach_lazy_input(SlachGraph* g, IN float* arr, size_t row, size_t col);
+int slach_lazy_mmMul(SlachGraph* g, int a, int b);
+int slach_lazy_mmAdd(SlachGraph* g, int a, int b);
+int slach_lazy_ewBinary(SlachGraph* g, EwBinOp op, int a, int b); //broadcasting as in ewBinary
+int slach_lazy_ewBinaryScalar(SlachGraph* g, EwBinOp op, int a, float s);
+int slach_lazy_ew(SlachGraph* g, EwOp op, double order, int a); //element-wise math, like expm
+int slach_lazy_mT(SlachGraph* g, int a);
+int slach_lazy_inv(SlachGraph* g, int a);
+void slach_lazy_output(SlachGraph* g, int node, OUT float* dest, size_t height, size_t width);
+size_t slach_eval(SlachGraph* g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
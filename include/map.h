@@ -0,0 +1,72 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef MAP_H_
+#define MAP_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+element-wise map engine: dest[i] = f(x[i]) or dest[i] = f(x[i], y[i]) with a user function.
+The array is cut into cache-sized blocks that are spread over the thread pool, so the callback
+must be thread-safe (ctx is shared by all threads). dest may be the same array as x or y.
+Two callback flavours:
+ *scalar:     called once per element
+ *vectorized: called once per block with contiguous arrays; every block but the last has a
+              length that is a multiple of 16, so the body can use SIMD without a remainder loop
+*/
+typedef float (*mapFn)(float x, void* ctx);
+typedef float (*map2Fn)(float x, float y, void* ctx);
+typedef void (*mapVecFn)(IN float* x, OUT float* dest, size_t len, void* ctx);
+typedef void (*map2VecFn)(IN float* x, IN float* y, OUT float* dest, size_t len, void* ctx);
+
+void slach_map(IN float* x, OUT float* dest, size_t len, mapFn fn, void* ctx);
+void slach_map2(IN float* x, IN float* y, OUT float* dest, size_t len, map2Fn fn, void* ctx);
+void slach_map_vec(IN float* x, OUT float* dest, size_t len, mapVecFn fn, void* ctx);
+void slach_map2_vec(IN float* x, IN float* y, OUT float* dest, size_t len, map2VecFn fn, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
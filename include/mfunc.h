@@ -0,0 +1,73 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef MFUNC_H_
+#define MFUNC_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+matrix functions of a square matrix, not to be confused with the element-wise expm, powm
+and sqrtm of operation.h:
+ mExp: exp(A), Pade approximant of degree 3, 5, 7, 9 or 13 picked from |A|_1, with scaling
+       and squaring (Higham 2005)
+ mPow: A^p by repeated squaring, p < 0 inverts A first, p = 0 gives I
+ mSqrt: principal square root by the product form of the Denman-Beavers iteration; A must
+        have no eigenvalue on the closed negative real axis
+Every product is a gemmEx call and every solve or inverse goes through the LU engine. The Ex
+forms work on n x n arrays and take a workspace of mfuncWorkSize(n) floats that can be reused
+across calls (NULL allocates one per call). dest may be the input array.
+*/
+size_t mfuncWorkSize(size_t n);
+void mExpEx(size_t n, IN float* A, OUT float* dest, float* work);
+void mPowEx(size_t n, IN float* A, int p, OUT float* dest, float* work);
+void mSqrtEx(size_t n, IN float* A, OUT float* dest, float* work);
+void mExp(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
+void mPow(INOUT float* arr, size_t row, size_t col, int p, OUT float* dest, size_t height, size_t width);
+void mSqrt(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,68 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef OOC_H_
+#define OOC_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+#include "GEMM.h"
+
+/*
+out-of-core GEMM on file-backed matrices: raw row-major float files with no header, A m x k,
+B k x n, C m x n. The files are memory-mapped and multiplied in tiles sized from a memory
+budget, which covers one C tile plus two A and two B tiles: while gemmEx works on the current
+A and B tiles, the next ones are copied in by a task on the thread pool (see async.h) after a
+madvise(MADV_WILLNEED) hint, so the reads overlap the products. C is created or extended to
+m x n; with beta == 0 its old contents are never read. The epilogue is applied once, after
+the last tile of k. With k == 0, as in gemmEx, A and B are not read and C = epilogue(beta*C).
+*/
+void oocGemmEx(const char* fileA, const char* fileB, const char* fileC, size_t m, size_t n, size_t k,
+               size_t budget, IN const GemmEpilogue* ep);
+//tile edge used by oocGemmEx for a budget in bytes
+size_t oocTileSize(size_t budget);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -62,6 +62,8 @@ void sinv(INOUT float* arr, size_t len, OUT float* dest, size_t lend);
 void sinm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
 void cosv(INOUT float* arr, size_t len, OUT float* dest, size_t lend);
 void cosm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
+void tanv(INOUT float* arr, size_t len, OUT float* dest, size_t lend);
+void tanm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
 void asinv(INOUT float* arr, size_t len, OUT float* dest, size_t lend);
 void asinm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
 void acosv(INOUT float* arr, size_t len, OUT float* dest, size_t lend);
@@ -77,6 +79,18 @@ void powm(INOUT float* arr, size_t row, size_t col, double order, OUT float* des
 void sqrtv(INOUT float* arr, size_t len, OUT float* dest, size_t lend);
 void sqrtm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
 
+/*
+element-wise op codes: the functions above as values, so other kernels (GEMM epilogue, ...)
+can apply them in place on their own output
+*/
+typedef enum _EwOp_{
+    EW_NONE = 0,
+    EW_ABS, EW_SIN, EW_COS, EW_TAN, EW_ASIN, EW_ACOS, EW_ATAN,
+    EW_EXP, EW_LOG, EW_POW, EW_SQRT
+}EwOp;
+float ewScalar(EwOp op, float x, double order);
+void ewApply(EwOp op, double order, INOUT float* arr, size_t len);
+
 /*
 matrix multiplication, matrix addition, inner product of vectors, matrix transpose
 */
@@ -88,6 +102,27 @@ void mmAdd(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_
                                                         OUT float* dest, size_t height, size_t width);
 void vvAdd(INOUT float* arr1, size_t len1, INOUT float* arr2, size_t len2,
                               OUT float* dest, size_t len);
+/*
+binary element-wise operations with NumPy-style broadcasting: every dimension of an operand
+either matches dest or is 1, so an operand can be a matrix, a row vector (1 x width), a column
+vector (height x 1) or a scalar (1 x 1). dest may be an operand of the same shape.
+*/
+typedef enum _EwBinOp_{
+    EW_ADD = 0, EW_SUB, EW_MUL, EW_DIV, EW_MIN, EW_MAX
+}EwBinOp;
+void ewBinary(EwBinOp op, INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+              OUT float* dest, size_t height, size_t width);
+void ewBinaryScalar(EwBinOp op, INOUT float* arr, size_t row, size_t col, float s,
+                    OUT float* dest, size_t height, size_t width);
+//dest = arr1*arr2 + arr3 in one pass
+void ewFma(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+           INOUT float* arr3, size_t row3, size_t col3, OUT float* dest, size_t height, size_t width);
+void _ewBinKernel(int op, float* x, float* y, float* d, size_t n); //private: d = op(x, y), contiguous
+void mT(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width);
+//in-place transpose, arr (row x col) becomes col x row
+void mTInplace(INOUT float* arr, size_t row, size_t col);
+//blocked transpose of a strided row x col block into dest (col x row)
+void transposeEx(size_t row, size_t col, IN float* src, size_t lds, OUT float* dest, size_t ldd);
 float dot(INOUT float* arr1, size_t len1, INOUT float* arr2, size_t len2);
 
 /*
@@ -0,0 +1,101 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+work-stealing thread pool shared by all slach kernels. The number of threads defaults to the
+number of online CPUs and can be overridden by the environment variable SLACH_NUM_THREADS or
+by slach_set_num_threads(). Loops may nest: a thread waiting for its loop runs other chunks
+meanwhile. Build with -DSLACH_NO_THREADS to make every loop serial. A child created by fork()
+starts without workers and runs serially until it calls slach_set_num_threads().
+*/
+typedef void (*parallelFn)(void* ctx, size_t begin, size_t end);
+
+//run fn(ctx, begin, end) over [0, n): once on the whole range, or on chunks [i*grain, (i+1)*grain)
+void slach_parallel_for(size_t n, size_t grain, parallelFn fn, void* ctx);
+void slach_set_num_threads(int n);
+int slach_get_num_threads(void);
+//pin worker i to CPU i+1 (SLACH_AFFINITY=1 turns it on at startup), 0 lets the OS place them
+void slach_set_affinity(int on);
+
+/*
+caller-supplied executor: with one set, slach submits helper tasks to it instead of waking
+its own workers, so slach shares the service's threads rather than competing with them.
+submit(pool, fn, arg) must run fn(arg) once, on any thread, at any later time; the caller of a
+loop also works on it, so a busy pool only costs parallelism, never progress.
+concurrency is the number of threads worth using. Set it before calling any kernel;
+NULL goes back to the internal pool. Ignored with -DSLACH_NO_THREADS.
+*/
+typedef void (*slachTaskFn)(void* arg);
+typedef struct _SlachExecutor_{
+    void (*submit)(void* pool, slachTaskFn fn, void* arg);
+    void* pool;
+    int concurrency;
+}SlachExecutor;
+
+void slach_set_executor(IN const SlachExecutor* ex);
+void _parallelSubmit(slachTaskFn fn, void* arg); //private: run fn(arg) asynchronously, see async.h
+int _parallelHelp(void); //private: run one pending chunk on the calling thread, 0 if none
+
+/*
+reproducible mode (off by default, SLACH_REPRODUCIBLE=1 turns it on at startup): the sums,
+dot products and norms of reduce.h, gemmEx, gemvEx, ewFma and everything built on them
+(mmMul, mvMul, dot, vNorm, mNorm, syrkEx, the BLAS interface) return bit-identical results
+whatever the thread count and whether AVX, SSE or scalar code is compiled in. Products of
+floats are exact in double, so every sum is accumulated in double in a fixed order and
+threads only split independent outputs or fixed blocks. Not covered: TRSM/LU/QR/SVD
+(their panels depend on the block sizes only, but use the fast kernels), axis reductions
+and the transcendental functions. Costs are listed in reduce.h, GEMM.h and GEMV.h.
+*/
+void slach_set_reproducible(int on);
+int slach_get_reproducible(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
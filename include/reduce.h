@@ -0,0 +1,103 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef REDUCE_H_
+#define REDUCE_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+allocation-free SIMD reductions over a contiguous array.
+Summation modes:
+ *SUM_FAST:     several vector accumulators, error grows like O(n) in the worst case
+ *SUM_PAIRWISE: blocks of SUM_FAST combined in a binary tree, error grows like O(log n), nearly free
+ *SUM_KAHAN:    compensated summation per lane, error independent of n, about 2x slower
+In the reproducible mode (slach_set_reproducible) the mode argument is ignored: each term is
+formed exactly in double and summed over 8 fixed lanes and fixed blocks, which is at least as
+accurate as SUM_KAHAN for float data and costs about 1.5-2x SUM_PAIRWISE.
+*/
+typedef enum _SumMode_{
+    SUM_FAST = 0,
+    SUM_PAIRWISE,
+    SUM_KAHAN
+}SumMode;
+
+float sumEx(IN float* x, size_t len, SumMode mode);             //sum x_i
+float dotEx(IN float* x, IN float* y, size_t len, SumMode mode); //sum x_i*y_i
+float asumEx(IN float* x, size_t len, SumMode mode);            //sum |x_i|
+float nrm2Ex(IN float* x, size_t len, SumMode mode);            //sqrt(sum x_i^2), never overflows or underflows
+float amaxEx(IN float* x, size_t len);                          //max |x_i|
+float pnormEx(IN float* x, size_t len, double p);               //(sum |x_i|^p)^(1/p), scaled like nrm2Ex
+
+/*
+reductions along one axis of a row x col matrix:
+ axis 0: over the rows, one result per column (len = col)
+ axis 1: over the columns, one result per row (len = row)
+Both axes walk the matrix row by row, so column reductions never stride through memory.
+AXIS_VAR is the population variance (divided by the count), computed in two passes.
+argmin/argmax return the first index of the extremum.
+*/
+typedef enum _AxisOp_{
+    AXIS_SUM = 0,
+    AXIS_MEAN,
+    AXIS_MIN,
+    AXIS_MAX,
+    AXIS_VAR
+}AxisOp;
+
+void reduceAxis(AxisOp op, int axis, IN float* arr, size_t row, size_t col, OUT float* dest, size_t len);
+void argminAxis(int axis, IN float* arr, size_t row, size_t col, OUT size_t* dest, size_t len);
+void argmaxAxis(int axis, IN float* arr, size_t row, size_t col, OUT size_t* dest, size_t len);
+/*
+prefix sums along one axis (axis 0: down each column, axis 1: along each row).
+inclusive: dest[i] = x[0] + ... + x[i]; exclusive: dest[i] = x[0] + ... + x[i-1], dest[0] = 0.
+dest (row x col) may be arr.
+*/
+void cumsumAxis(int axis, int exclusive, IN float* arr, size_t row, size_t col,
+                OUT float* dest, size_t height, size_t width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
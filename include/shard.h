@@ -0,0 +1,83 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef SHARD_H_
+#define SHARD_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+#include "GEMM.h"
+#include "FFT.h"
+
+/*
+multi-process sharding over POSIX shared memory. nprocs cooperating local processes (for
+example one per NUMA socket) open the same named segment with their rank in [0, nprocs);
+rank 0 creates it, the others attach, and slach_shard_open returns once every rank is in.
+The name is unlinked at that point, so nothing is left behind if a process dies later; a
+segment a job left under the name by dying during setup is replaced, never joined.
+Operands live in the segment (slach_shard_data; the same offsets in every process) and the
+collective calls below must be made by every rank with the same arguments: each rank computes
+its own slice, writing only there, and the call returns after a barrier when the whole result
+is visible to all ranks. Inside a rank the slice still runs on the local thread pool.
+The barrier is a counter in the segment, so it needs no process-shared pthread objects.
+*/
+typedef struct _SlachShard_ SlachShard;
+
+SlachShard* slach_shard_open(const char* name, int nprocs, int rank, size_t bytes);
+void slach_shard_close(SlachShard* sh);
+void* slach_shard_data(SlachShard* sh);
+void slach_shard_barrier(SlachShard* sh);
+//the slice [begin, end) of n items this rank owns
+void slach_shard_range(SlachShard* sh, size_t n, size_t* begin, size_t* end);
+//gemmEx sharded by rows of C (by columns when C is wider than tall), C must be in the segment
+void slach_shard_gemmEx(SlachShard* sh, int transA, int transB, size_t m, size_t n, size_t k,
+                        IN float* A, size_t lda, IN float* B, size_t ldb, INOUT float* C, size_t ldc,
+                        IN const GemmEpilogue* ep);
+//FFT_CooleyTukey sharded over its N1 column and N2 row transforms; work and output hold N
+//points each, in the segment
+void slach_shard_fft(SlachShard* sh, IN complex* input, int N, int N1, int N2, complex* work, OUT complex* output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
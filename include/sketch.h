@@ -0,0 +1,86 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef SKETCH_H_
+#define SKETCH_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+fast Walsh-Hadamard transform and random sketches. fwht transforms a vector of n = 2^q points in
+place, fwhtEx every column of an n x d row-major matrix; both are unnormalized, so applying one
+twice multiplies by n.
+A sketch S is an s x n random matrix with E[S^T S] = I, applied as SA to n x d matrices so that
+norms in the column space of A are kept up to a small distortion:
+ SKETCH_SRHT: sqrt(1/s) P H D, random signs D, Hadamard H (rows zero padded to a power of two),
+              s rows sampled without replacement P; O(n d log n)
+ SKETCH_COUNT: CountSketch, every row of A added with a random sign to one random row of SA; O(nd)
+ SKETCH_SPARSE_JL: like CountSketch with nnz rows per row of A, weighted 1/sqrt(nnz)
+ SKETCH_GAUSSIAN: dense N(0, 1/s) entries, applied by gemmEx; stores s x n floats
+The randomness is drawn once by sketchCreate from the slach RNG (slach_rand_seed makes it
+repeatable), so one sketch can be applied to several matrices, as sketch-and-solve needs.
+*/
+typedef enum _SketchType_{
+    SKETCH_SRHT = 0,
+    SKETCH_COUNT,
+    SKETCH_SPARSE_JL,
+    SKETCH_GAUSSIAN
+}SketchType;
+
+typedef struct _SlachSketch_ SlachSketch;
+
+void fwht(INOUT float* x, size_t n);
+void fwhtEx(size_t n, size_t d, INOUT float* X, size_t ld);
+//nnz: rows of SA each row of A goes to, SKETCH_SPARSE_JL only, 0 takes a default
+SlachSketch* sketchCreate(SketchType type, size_t s, size_t n, size_t nnz);
+void sketchApply(const SlachSketch* S, size_t d, IN float* A, size_t lda, OUT float* SA, size_t ldsa);
+void sketchDestroy(SlachSketch* S);
+//least squares min |AX - B| solved as min |SAX - SB| by QR, with s >= col1 sketch rows
+void sketchSolve(SketchType type, size_t s, INOUT float* arr1, size_t row1, size_t col1,
+                 INOUT float* arr2, size_t row2, size_t col2, OUT float* dest, size_t height, size_t width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
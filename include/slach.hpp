@@ -0,0 +1,453 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+/*
+Optional C++ front end over the C kernels (C++11, header only).
+
+ *slach::Matrix<T, R, C>: compile-time sized, stack allocated; every operation is fully
+  unrolled at compile time, so small fixed shapes cost no loops and no heap.
+ *slach::MatrixView: non-owning view of a row-major float array (pointer, rows, cols,
+  leading dimension). It wraps a float* or a C Matrix* without copying, and t() gives a
+  transposed view for free.
+ *slach::DynMatrix: owning runtime-sized matrix, usable wherever a MatrixView is.
+
+Arithmetic on views builds expression templates instead of temporaries. The assignment
+runs a single kernel call:
+    d = a*b;            -> gemmEx, beta = 0
+    d = a*b + c;        -> copy c into d (skipped when d is c), then gemmEx with beta = 1
+    d += 2*a.t()*b;     -> gemmEx with alpha = 2, beta = 1, transA
+    d = 3*x + y;        -> one axpy pass
+Shape errors go through perr() like the rest of slach.
+*/
+
+#ifndef SLACH_HPP_
+#define SLACH_HPP_
+
+#include <cstddef>
+#include <vector>
+#include "base.h"
+#include "GEMM.h"
+
+//base.h defines E and PI as macros, so template parameters below avoid single-letter E
+
+namespace slach {
+
+namespace detail {
+
+//perr() takes char*, C++ string literals are const
+inline void fail(const char* msg){ perr(const_cast<char*>(msg)); }
+
+//calls f(0), f(1), ..., f(N-1), unrolled at compile time
+template <std::size_t N>
+struct Unroll{
+    template <class F> static void run(const F& f){ Unroll<N-1>::run(f); f(N-1); }
+};
+template <>
+struct Unroll<0>{
+    template <class F> static void run(const F&){}
+};
+
+}
+
+/*
+compile-time sized matrix
+*/
+template <typename T, std::size_t R, std::size_t C>
+class Matrix{
+public:
+    Matrix(){
+        T* d = data_;
+        detail::Unroll<R*C>::run([d](std::size_t i){ d[i] = T(0); });
+    }
+    //copy from a row-major array of R*C elements
+    explicit Matrix(const T* src){
+        T* d = data_;
+        detail::Unroll<R*C>::run([d, src](std::size_t i){ d[i] = src[i]; });
+    }
+    static Matrix identity(){
+        Matrix m;
+        T* d = m.data_;
+        detail::Unroll<(R < C ? R : C)>::run([d](std::size_t i){ d[i*C+i] = T(1); });
+        return m;
+    }
+    std::size_t rows() const { return R; }
+    std::size_t cols() const { return C; }
+    T& operator()(std::size_t i, std::size_t j){ return data_[i*C+j]; }
+    const T& operator()(std::size_t i, std::size_t j) const { return data_[i*C+j]; }
+    //row-major storage, can be passed straight to the C interface
+    T* data(){ return data_; }
+    const T* data() const { return data_; }
+
+    Matrix& operator+=(const Matrix& o){
+        T* d = data_; const T* s = o.data_;
+        detail::Unroll<R*C>::run([d, s](std::size_t i){ d[i] += s[i]; });
+        return *this;
+    }
+    Matrix& operator-=(const Matrix& o){
+        T* d = data_; const T* s = o.data_;
+        detail::Unroll<R*C>::run([d, s](std::size_t i){ d[i] -= s[i]; });
+        return *this;
+    }
+    Matrix& operator*=(T a){
+        T* d = data_;
+        detail::Unroll<R*C>::run([d, a](std::size_t i){ d[i] *= a; });
+        return *this;
+    }
+private:
+    T data_[R*C];
+};
+
+template <typename T, std::size_t R, std::size_t C>
+inline Matrix<T, R, C> operator+(Matrix<T, R, C> a, const Matrix<T, R, C>& b){ return a += b; }
+
+template <typename T, std::size_t R, std::size_t C>
+inline Matrix<T, R, C> operator-(Matrix<T, R, C> a, const Matrix<T, R, C>& b){ return a -= b; }
+
+template <typename T, std::size_t R, std::size_t C>
+inline Matrix<T, R, C> operator*(Matrix<T, R, C> a, T s){ return a *= s; }
+
+template <typename T, std::size_t R, std::size_t C>
+inline Matrix<T, R, C> operator*(T s, Matrix<T, R, C> a){ return a *= s; }
+
+template <typename T, std::size_t R, std::size_t K, std::size_t C>
+inline Matrix<T, R, C> operator*(const Matrix<T, R, K>& a, const Matrix<T, K, C>& b){
+    Matrix<T, R, C> r;
+    T* d = r.data();
+    const T* pa = a.data();
+    const T* pb = b.data();
+    detail::Unroll<R*C>::run([d, pa, pb](std::size_t ij){
+        const std::size_t i = ij/C, j = ij%C;
+        T sum = T(0);
+        detail::Unroll<K>::run([&sum, pa, pb, i, j](std::size_t k){ sum += pa[i*K+k]*pb[k*C+j]; });
+        d[ij] = sum;
+    });
+    return r;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+inline Matrix<T, C, R> transpose(const Matrix<T, R, C>& a){
+    Matrix<T, C, R> r;
+    T* d = r.data();
+    const T* s = a.data();
+    detail::Unroll<R*C>::run([d, s](std::size_t ij){ d[(ij%C)*R+ij/C] = s[ij]; });
+    return r;
+}
+
+template <class Ex> struct Expr{};
+struct Product;
+struct ProductSum;
+struct Scaled;
+struct AxpySum;
+
+/*
+non-owning view of a row-major float matrix
+*/
+class MatrixView{
+public:
+    MatrixView(float* p, std::size_t rows, std::size_t cols)
+        : p_(p), r_(rows), c_(cols), ld_(cols), trans_(false){}
+    MatrixView(float* p, std::size_t rows, std::size_t cols, std::size_t ld)
+        : p_(p), r_(rows), c_(cols), ld_(ld), trans_(false){
+        if (ld < cols) detail::fail("In MatrixView, ld < cols!\n");
+    }
+    MatrixView(const MatrixView& o) = default;
+    //zero-copy view of a C Matrix, whose rows are one contiguous block
+    explicit MatrixView(::Matrix* m)
+        : p_(m->mData[0]), r_(m->mHeight), c_(m->mWidth), ld_(m->mWidth), trans_(false){}
+    template <std::size_t R, std::size_t C>
+    MatrixView(Matrix<float, R, C>& m)
+        : p_(m.data()), r_(R), c_(C), ld_(C), trans_(false){}
+
+    //logical shape, i.e. after the transpose flag
+    std::size_t rows() const { return trans_ ? c_ : r_; }
+    std::size_t cols() const { return trans_ ? r_ : c_; }
+    std::size_t ld() const { return ld_; }
+    bool transposed() const { return trans_; }
+    float* data() const { return p_; }
+    //number of floats spanned in memory
+    std::size_t extent() const { return (r_-1)*ld_+c_; }
+    float& operator()(std::size_t i, std::size_t j) const { return trans_ ? p_[j*ld_+i] : p_[i*ld_+j]; }
+    MatrixView t() const { MatrixView v(*this); v.trans_ = !trans_; return v; }
+
+    //element copy, not rebinding
+    inline MatrixView& operator=(const MatrixView& o);
+    template <class Ex>
+    MatrixView& operator=(const Expr<Ex>& e){
+        static_cast<const Ex&>(e).assignTo(*this);
+        return *this;
+    }
+    inline MatrixView& operator+=(const Product& p);
+    inline MatrixView& operator+=(const Scaled& s);
+    MatrixView& operator+=(const MatrixView& o);
+
+    bool sameAs(const MatrixView& o) const {
+        return p_ == o.p_ && ld_ == o.ld_ && trans_ == o.trans_ && rows() == o.rows() && cols() == o.cols();
+    }
+    bool overlaps(const MatrixView& o) const {
+        return p_ < o.p_+o.extent() && o.p_ < p_+extent();
+    }
+private:
+    float* p_;
+    std::size_t r_, c_, ld_;
+    bool trans_;
+};
+
+/*
+owning runtime-sized matrix
+*/
+class DynMatrix{
+public:
+    DynMatrix() : r_(0), c_(0){}
+    DynMatrix(std::size_t rows, std::size_t cols) : buf_(rows*cols), r_(rows), c_(cols){}
+    //copy from a row-major array
+    DynMatrix(const float* src, std::size_t rows, std::size_t cols)
+        : buf_(src, src+rows*cols), r_(rows), c_(cols){}
+    template <class Ex>
+    DynMatrix(const Expr<Ex>& e) : buf_(static_cast<const Ex&>(e).rows()*static_cast<const Ex&>(e).cols()),
+        r_(static_cast<const Ex&>(e).rows()), c_(static_cast<const Ex&>(e).cols()){
+        static_cast<const Ex&>(e).assignTo(view());
+    }
+    template <class Ex>
+    DynMatrix& operator=(const Expr<Ex>& e){
+        const Ex& x = static_cast<const Ex&>(e);
+        if (x.rows() != r_ || x.cols() != c_){
+            //the expression may read this matrix, so evaluate into a fresh buffer
+            DynMatrix tmp(x);
+            swapWith(tmp);
+        }
+        else{
+            x.assignTo(view());
+        }
+        return *this;
+    }
+    template <class Ex>
+    DynMatrix& operator+=(const Ex& e){ view() += e; return *this; }
+    DynMatrix& operator+=(DynMatrix& o){ view() += o.view(); return *this; }
+
+    std::size_t rows() const { return r_; }
+    std::size_t cols() const { return c_; }
+    float* data(){ return buf_.empty() ? 0 : &buf_[0]; }
+    float& operator()(std::size_t i, std::size_t j){ return buf_[i*c_+j]; }
+    MatrixView view(){ return MatrixView(data(), r_, c_); }
+    operator MatrixView(){ return view(); }
+    MatrixView t(){ return view().t(); }
+    void swapWith(DynMatrix& o){
+        std::size_t t;
+        buf_.swap(o.buf_);
+        t = r_; r_ = o.r_; o.r_ = t;
+        t = c_; c_ = o.c_; o.c_ = t;
+    }
+private:
+    std::vector<float> buf_;
+    std::size_t r_, c_;
+};
+
+//through a temporary when o overlaps this view with another layout, like X = X.t()
+inline MatrixView& MatrixView::operator=(const MatrixView& o){
+    std::size_t i, j;
+    if (o.rows() != rows() || o.cols() != cols()) detail::fail("In MatrixView, shape mismatch!\n");
+    if (o.p_ == p_ && o.ld_ == ld_ && o.trans_ == trans_) return *this;
+    if (overlaps(o)){
+        DynMatrix tmp(rows(), cols());
+        tmp.view() = o;
+        return *this = tmp.view();
+    }
+    for (i=0; i<rows(); i++)
+        for (j=0; j<cols(); j++)
+            (*this)(i, j) = o(i, j);
+    return *this;
+}
+
+namespace detail {
+
+//d = alpha*a*b + beta*d through the GEMM engine, via a temporary only when d aliases a or b
+inline void gemm(const MatrixView& a, const MatrixView& b, MatrixView d, float alpha, float beta){
+    GemmEpilogue ep;
+    if (a.cols() != b.rows() || d.rows() != a.rows() || d.cols() != b.cols()){
+        detail::fail("In slach::gemm, shape mismatch!\n");
+    }
+    if (d.transposed()){
+        detail::fail("In slach::gemm, destination is a transposed view!\n");
+    }
+    if (d.overlaps(a) || d.overlaps(b)){
+        DynMatrix tmp(d.rows(), d.cols());
+        MatrixView tv = tmp.view();
+        if (beta != 0) tv = d;
+        gemm(a, b, tv, alpha, beta);
+        d = tv;
+        return;
+    }
+    gemmEpilogueInit(&ep);
+    ep.alpha = alpha;
+    ep.beta = beta;
+    gemmEx(a.transposed(), b.transposed(), a.rows(), b.cols(), a.cols(),
+           a.data(), a.ld(), b.data(), b.ld(), d.data(), d.ld(), &ep);
+}
+
+//an element-wise pass writing d reads x safely only when x is d itself or elsewhere in memory
+inline bool clobbers(const MatrixView& d, const MatrixView& x){
+    return d.overlaps(x) && !d.sameAs(x);
+}
+
+//d = alpha*x + beta*y in one pass (x or y may be d), via a temporary when d overlaps an
+//operand laid out differently, like X = X.t() + X
+inline void axpby(float alpha, const MatrixView& x, float beta, const MatrixView& y, MatrixView d){
+    std::size_t i, j;
+    if (x.rows() != d.rows() || x.cols() != d.cols() || y.rows() != d.rows() || y.cols() != d.cols()){
+        detail::fail("In slach::axpby, shape mismatch!\n");
+    }
+    if (clobbers(d, x) || clobbers(d, y)){
+        DynMatrix tmp(d.rows(), d.cols());
+        axpby(alpha, x, beta, y, tmp.view());
+        d = tmp.view();
+        return;
+    }
+    for (i=0; i<d.rows(); i++)
+        for (j=0; j<d.cols(); j++)
+            d(i, j) = alpha*x(i, j)+beta*y(i, j);
+}
+
+}
+
+//alpha*x
+struct Scaled : Expr<Scaled>{
+    Scaled(float a, const MatrixView& v) : alpha(a), x(v){}
+    std::size_t rows() const { return x.rows(); }
+    std::size_t cols() const { return x.cols(); }
+    void assignTo(MatrixView d) const {
+        std::size_t i, j;
+        if (d.rows() != rows() || d.cols() != cols()) detail::fail("In slach::Scaled, shape mismatch!\n");
+        if (detail::clobbers(d, x)){
+            DynMatrix tmp(d.rows(), d.cols());
+            assignTo(tmp.view());
+            d = tmp.view();
+            return;
+        }
+        for (i=0; i<rows(); i++)
+            for (j=0; j<cols(); j++)
+                d(i, j) = alpha*x(i, j);
+    }
+    float alpha;
+    MatrixView x;
+};
+
+//alpha*x + beta*y
+struct AxpySum : Expr<AxpySum>{
+    AxpySum(const Scaled& s, float b, const MatrixView& v) : x(s), beta(b), y(v){}
+    std::size_t rows() const { return y.rows(); }
+    std::size_t cols() const { return y.cols(); }
+    void assignTo(const MatrixView& d) const { detail::axpby(x.alpha, x.x, beta, y, d); }
+    Scaled x;
+    float beta;
+    MatrixView y;
+};
+
+//alpha*a*b
+struct Product : Expr<Product>{
+    Product(float s, const MatrixView& l, const MatrixView& r) : alpha(s), a(l), b(r){}
+    std::size_t rows() const { return a.rows(); }
+    std::size_t cols() const { return b.cols(); }
+    void assignTo(const MatrixView& d) const { detail::gemm(a, b, d, alpha, 0); }
+    float alpha;
+    MatrixView a, b;
+};
+
+//alpha*a*b + beta*c
+struct ProductSum : Expr<ProductSum>{
+    ProductSum(const Product& p_, float s, const MatrixView& v) : p(p_), beta(s), c(v){}
+    std::size_t rows() const { return p.rows(); }
+    std::size_t cols() const { return p.cols(); }
+    void assignTo(MatrixView d) const {
+        if (c.rows() != d.rows() || c.cols() != d.cols()) detail::fail("In slach::ProductSum, shape mismatch!\n");
+        if (d.sameAs(c)){
+            detail::gemm(p.a, p.b, d, p.alpha, beta);
+        }
+        else if (d.overlaps(p.a) || d.overlaps(p.b) || d.overlaps(c)){
+            DynMatrix tmp(d.rows(), d.cols());
+            MatrixView tv = tmp.view();
+            tv = c;
+            detail::gemm(p.a, p.b, tv, p.alpha, beta);
+            d = tv;
+        }
+        else{
+            d = c;
+            detail::gemm(p.a, p.b, d, p.alpha, beta);
+        }
+    }
+    Product p;
+    float beta;
+    MatrixView c;
+};
+
+inline MatrixView& MatrixView::operator+=(const Product& p){
+    detail::gemm(p.a, p.b, *this, p.alpha, 1);
+    return *this;
+}
+inline MatrixView& MatrixView::operator+=(const Scaled& s){
+    detail::axpby(s.alpha, s.x, 1, *this, *this);
+    return *this;
+}
+inline MatrixView& MatrixView::operator+=(const MatrixView& o){
+    detail::axpby(1, o, 1, *this, *this);
+    return *this;
+}
+
+inline Product operator*(const MatrixView& a, const MatrixView& b){ return Product(1, a, b); }
+inline Product operator*(float s, const Product& p){ return Product(s*p.alpha, p.a, p.b); }
+inline Product operator*(const Product& p, float s){ return Product(s*p.alpha, p.a, p.b); }
+inline Product operator*(const Scaled& x, const MatrixView& b){ return Product(x.alpha, x.x, b); }
+inline Scaled operator*(float s, const MatrixView& x){ return Scaled(s, x); }
+inline Scaled operator*(const MatrixView& x, float s){ return Scaled(s, x); }
+
+inline ProductSum operator+(const Product& p, const MatrixView& c){ return ProductSum(p, 1, c); }
+inline ProductSum operator+(const MatrixView& c, const Product& p){ return ProductSum(p, 1, c); }
+inline ProductSum operator+(const Product& p, const Scaled& c){ return ProductSum(p, c.alpha, c.x); }
+inline ProductSum operator+(const Scaled& c, const Product& p){ return ProductSum(p, c.alpha, c.x); }
+inline ProductSum operator-(const Product& p, const MatrixView& c){ return ProductSum(p, -1, c); }
+
+inline AxpySum operator+(const Scaled& x, const MatrixView& y){ return AxpySum(x, 1, y); }
+inline AxpySum operator+(const MatrixView& y, const Scaled& x){ return AxpySum(x, 1, y); }
+inline AxpySum operator+(const Scaled& x, const Scaled& y){ return AxpySum(x, y.alpha, y.x); }
+inline AxpySum operator+(const MatrixView& x, const MatrixView& y){ return AxpySum(Scaled(1, x), 1, y); }
+inline AxpySum operator-(const MatrixView& x, const MatrixView& y){ return AxpySum(Scaled(1, x), -1, y); }
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef TUNE_H_
+#define TUNE_H_
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+#include "base.h"
+
+/*
+machine-dependent tuning parameters. The kernels read them through slach_tune() on every call,
+so a loaded or autotuned set takes effect at once. On first use the parameters are loaded from
+the tuning file (SLACH_TUNE_FILE, else $HOME/.slach_tune) from the section named after the CPU
+model; without a matching section the built-in defaults are used.
+The GEMM micro-kernel shape (6 x 2 vectors) and the 8x8 transpose tile are fixed by the
+register kernels and are not tunable.
+*/
+typedef struct _SlachTune_{
+    size_t gemmMC;          //rows of the packed A block (multiple of 6)
+    size_t gemmKC;          //depth of the packed panels
+    size_t gemmNC;          //columns of the packed B panel
+    size_t transposeBlock;  //blocks up to this size are transposed without recursion
+    size_t strassenCutoff;  //Strassen recursion stops at this dimension
+    size_t strassenAutoMin; //GEMM_ALGO_AUTO uses Strassen from this dimension on
+    size_t syrkBlock;       //SYRK row panel
+    size_t trsmBlock;       //TRSM/TRMM diagonal block
+    size_t luBlock;         //LU panel width
+    size_t parMin;          //GEMV, BLAS, TRSM, element-wise and axis kernels stay serial below this many elements
+    size_t mapParMin;       //slach_map* stay serial below this many elements
+}SlachTune;
+
+void slach_tune_default(OUT SlachTune* t);
+const SlachTune* slach_tune(void);
+void slach_tune_set(IN const SlachTune* t); //not while kernels are running
+/*
+tuning file: one section per CPU model, "[model name]" followed by "key = value" lines.
+slach_tune_load returns 0 when a section for this CPU was found and applied, -1 otherwise;
+slach_tune_save replaces the section of this CPU and keeps the others, returns 0 or -1.
+path NULL means the default file.
+*/
+int slach_tune_load(const char* path);
+int slach_tune_save(const char* path, IN const SlachTune* t);
+void slach_cpu_model(OUT char* buf, size_t len);
+/*
+benchmark candidate GEMM blocks, transpose block, Strassen cutoff, SYRK/TRSM/LU blocks and
+parallel cutoffs on this machine, apply the winners and save them to path (NULL: default file).
+quick != 0 uses smaller problems (about 1 s instead of about 15 s on one core).
+Returns the result of slach_tune_save.
+*/
+int slach_autotune(const char* path, int quick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
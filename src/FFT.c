@@ -36,6 +36,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "../include/FFT.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+
+/*
+the DFT passes are split over the thread pool in blocks of at least FFT_PAR_MIN complex
+multiply-adds; smaller transforms stay on the calling thread
+*/
+#define FFT_PAR_MIN (slach_tune()->parMin) //tunable, see tune.h
 
 /*
 FFT
@@ -100,9 +108,42 @@ complex* DFT_naive(complex* x, int N) {
     }
     return X;
 }
+/** \brief arguments of the parallel DFT passes of FFT_CooleyTukey
+ *
+ * \param vec: vectors transformed in place
+ * \param len: points of each vector
+ * \return
+ *
+ */
+
+typedef struct _FftCtx_{
+    complex** vec;
+    int len;
+}FftCtx;
+
+/** \brief naive DFTs of vectors [i0, i1), thread pool body, private function
+ *
+ * \param arg: FftCtx*
+ * \param i0, i1: vector range
+ * \return
+ *
+ */
+
+void _fftDftRange(void* arg, size_t i0, size_t i1){
+    FftCtx* c = (FftCtx*)arg;
+    complex* X;
+    size_t i;
+    for (i=i0; i<i1; i++){
+        X = DFT_naive(c->vec[i], c->len);
+        slach_free(c->vec[i]);
+        c->vec[i] = X;
+    }
+}
+
 /** \brief Implements the Cooley-Tukey FFT algorithm.
  *   Cooley-Tukey FFT algorithm re-express DFT of an arbitrary composite size N = N1*N2
  *   in terms of N1 smaller DFTs of sizes N2, recursively.
+ *   The N1 column DFTs and the N2 row DFTs are independent and run on the thread pool.
  * \param complex*, points-N
  * \param N=N1*N2, ref: https://en.wikipedia.org/wiki/Cooley%E2%80%93Tukey_FFT_algorithm
  * \return complex*
@@ -111,6 +152,7 @@ complex* DFT_naive(complex* x, int N) {
 
 complex* FFT_CooleyTukey(complex* input, int N, int N1, int N2) {
     int k1, k2;
+    FftCtx c;
     /* Allocate columnwise matrix */
     complex** columns = slach_malloc(complex*, N1);
     complex** rows;
@@ -129,10 +171,9 @@ complex* FFT_CooleyTukey(complex* input, int N, int N1, int N2) {
             columns[k1][k2] = input[N1*k2 + k1];
         }
     }
-    /* Compute N1 DFTs of length N2 using naive method */
-    for (k1 = 0; k1 < N1; k1++) {
-        columns[k1] = DFT_naive(columns[k1], N2);
-    }
+    /* Compute N1 DFTs of length N2 using naive method, each costs N2*N2 */
+    c.vec = columns; c.len = N2;
+    slach_parallel_for(N1, MAX(1, FFT_PAR_MIN/((size_t)N2*N2)), _fftDftRange, &c);
     /* Multiply by the twiddle factors  ( e^(-2*pi*j/N * k1*k2)) and transpose */
     for(k1 = 0; k1 < N1; k1++) {
         for (k2 = 0; k2 < N2; k2++) {
@@ -140,9 +181,8 @@ complex* FFT_CooleyTukey(complex* input, int N, int N1, int N2) {
         }
     }
     /* Compute N2 DFTs of length N1 using naive method */
-    for (k2 = 0; k2 < N2; k2++) {
-        rows[k2] = DFT_naive(rows[k2], N1);
-    }
+    c.vec = rows; c.len = N1;
+    slach_parallel_for(N2, MAX(1, FFT_PAR_MIN/((size_t)N1*N1)), _fftDftRange, &c);
     /* Flatten into single output */
     output = slach_malloc(complex, N);
     for(k1 = 0; k1 < N1; k1++) {
@@ -162,6 +202,48 @@ complex* FFT_CooleyTukey(complex* input, int N, int N1, int N2) {
     return output;
 }
 
+/** \brief in-place iterative radix-2 FFT, for the transforms that are applied many times
+ *   over (convolution); the twiddle factors are stepped in double precision.
+ * \param x: N points, overwritten by the transform
+ * \param N: power of two
+ * \param inverse: 0 for e^(-2*pi*j*k*n/N), 1 for the unscaled inverse e^(+2*pi*j*k*n/N)
+ * \return
+ *
+ */
+
+void fftRadix2(complex* x, int N, int inverse){
+    int i, j, bit, len, k;
+    double ang, wr, wi, wlr, wli, t, ur, ui, vr, vi;
+    complex tmp;
+    if (N <= 0 || (N & (N-1)) != 0)
+        perr("In fftRadix2(), N must be a power of two!\n");
+    /* bit-reversal permutation */
+    for (i=1, j=0; i<N; i++){
+        for (bit=N>>1; j & bit; bit>>=1) j ^= bit;
+        j ^= bit;
+        if (i < j){
+            tmp = x[i]; x[i] = x[j]; x[j] = tmp;
+        }
+    }
+    for (len=2; len<=N; len<<=1){
+        ang = (inverse ? 2 : -2)*PI/len;
+        wlr = cos(ang); wli = sin(ang);
+        for (i=0; i<N; i+=len){
+            wr = 1; wi = 0;
+            for (k=0; k<len/2; k++){
+                ur = x[i+k].re; ui = x[i+k].im;
+                vr = x[i+k+len/2].re*wr - x[i+k+len/2].im*wi;
+                vi = x[i+k+len/2].re*wi + x[i+k+len/2].im*wr;
+                x[i+k].re = (float)(ur + vr); x[i+k].im = (float)(ui + vi);
+                x[i+k+len/2].re = (float)(ur - vr); x[i+k+len/2].im = (float)(ui - vi);
+                t = wr*wlr - wi*wli;
+                wi = wr*wli + wi*wlr;
+                wr = t;
+            }
+        }
+    }
+}
+
 /** \brief interface of FFT to calculate abs
  *
  * \param 1-dim array, len
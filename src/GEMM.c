@@ -0,0 +1,574 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/GEMM.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+#include "simd.h"
+
+/*
+Blocking parameters (Goto/BLIS scheme): a KC x NC panel of B and a MC x KC block of A
+are packed into contiguous slivers, and the MR x NR micro-kernel keeps its tile of C in
+GEMM_MR*GEMM_NRV vector registers for the whole k loop. MC, KC and NC are read from
+slach_tune() (tune.h) at each call, MR and NR are fixed by the kernel.
+*/
+#define GEMM_MR 6
+#define GEMM_NRV 2
+#define GEMM_NR (GEMM_NRV*SLACH_VLEN)
+
+/*
+threading: for each packed B panel the MC row blocks of C, each cut into column chunks when
+there are fewer row blocks than threads, become tasks of slach_parallel_for. Each task packs
+its own A block; B is packed once per panel and shared. Products below GEMM_PAR_MIN
+multiply-adds stay on the calling thread.
+*/
+#define GEMM_PAR_MIN (16*slach_tune()->parMin) //tunable, see tune.h
+
+/** \brief arguments of the GEMM block tasks of one packed B panel
+ *
+ * \param A, rsA, csA, C, ldc, ep, m, k: as in gemmEx, A with row/column strides of op(A)
+ * \param pb: packed kc x nc panel of op(B) at (pc, jc)
+ * \param mcb: rows per block, ncw: columns per chunk (multiple of GEMM_NR), nch: chunks per block
+ * \return
+ *
+ */
+
+typedef struct _GemmCtx_{
+    float* A;
+    size_t rsA, csA;
+    float* pb;  //packed kc x nc panel of op(B)
+    float* C;
+    size_t ldc;
+    GemmEpilogue* ep;
+    size_t m, k, jc, pc, kc, nc;
+    size_t mcb; //rows per block
+    size_t ncw; //columns per chunk, a multiple of GEMM_NR
+    size_t nch; //chunks per row block
+}GemmCtx;
+
+/*
+reproducible path (slach_set_reproducible): each element of C is accumulated in double in
+k order, products of two floats are exact in double so a fused or split multiply-add gives
+the same bits, and the epilogue rounds once through fma(). Threads only split the rows of
+C, so the thread count never changes the order of any sum.
+*/
+#define GEMM_REPRO_MR 4
+#define GEMM_REPRO_NR 8
+#define GEMM_REPRO_PAR_MIN (1<<15)
+
+typedef struct _GemmReproCtx_{
+    size_t m, n, k;
+    float* A;
+    size_t rsA, csA;
+    float* pb; //op(B) packed in k x GEMM_REPRO_NR slivers
+    float* C;
+    size_t ldc;
+    GemmEpilogue* ep;
+}GemmReproCtx;
+
+/** \brief default epilogue: C = A*B
+ *
+ * \param GemmEpilogue* ep
+ * \return
+ *
+ */
+
+void gemmEpilogueInit(OUT GemmEpilogue* ep){
+    if (ep == NULL){
+        perr("In gemmEpilogueInit(), ep is NULL!\n");
+    }
+    ep->alpha = 1;
+    ep->beta = 0;
+    ep->colBias = NULL;
+    ep->rowBias = NULL;
+    ep->op = EW_NONE;
+    ep->order = 1;
+}
+
+/** \brief pack a mc x kc block of op(A) into MR-row slivers, zero padded, private function
+ *
+ * \param mc, kc
+ * \param A, row stride, col stride
+ * \param packed buffer
+ * \return
+ *
+ */
+
+void _gemmPackA(size_t mc, size_t kc, float* A, size_t rs, size_t cs, float* pa){
+    size_t ir, i, p, mr;
+    for (ir=0; ir<mc; ir+=GEMM_MR){
+        mr = MIN(GEMM_MR, mc-ir);
+        for (p=0; p<kc; p++){
+            for (i=0; i<mr; i++){
+                pa[i] = A[(ir+i)*rs+p*cs];
+            }
+            for (; i<GEMM_MR; i++){
+                pa[i] = 0;
+            }
+            pa += GEMM_MR;
+        }
+    }
+}
+
+/** \brief pack a kc x nc panel of op(B) into NR-column slivers, zero padded, private function
+ *
+ * \param kc, nc
+ * \param B, row stride, col stride
+ * \param packed buffer
+ * \return
+ *
+ */
+
+void _gemmPackB(size_t kc, size_t nc, float* B, size_t rs, size_t cs, float* pb){
+    size_t jr, j, p, nr;
+    for (jr=0; jr<nc; jr+=GEMM_NR){
+        nr = MIN(GEMM_NR, nc-jr);
+        for (p=0; p<kc; p++){
+            for (j=0; j<nr; j++){
+                pb[j] = B[p*rs+(jr+j)*cs];
+            }
+            for (; j<GEMM_NR; j++){
+                pb[j] = 0;
+            }
+            pb += GEMM_NR;
+        }
+    }
+}
+
+/** \brief write one full row of a register tile through the epilogue, private function
+ *
+ * \param c: destination row in C
+ * \param v0, v1: accumulators of the row
+ * \param first/last: whether this is the first/last k block
+ * \param ep, i: row index in C, j: col index in C
+ * \return
+ *
+ */
+
+static SLACH_INLINE void _gemmStoreRow(float* c, vfloat v0, vfloat v1, int first, int last,
+                                       GemmEpilogue* ep, size_t i, size_t j){
+    vfloat t;
+    t = vfSet1(ep->alpha);
+    v0 = vfMul(v0, t);
+    v1 = vfMul(v1, t);
+    if (!first){
+        v0 = vfAdd(v0, vfLoad(c));
+        v1 = vfAdd(v1, vfLoad(c+SLACH_VLEN));
+    }
+    else if (ep->beta != 0){
+        t = vfSet1(ep->beta);
+        v0 = vfFmadd(t, vfLoad(c), v0);
+        v1 = vfFmadd(t, vfLoad(c+SLACH_VLEN), v1);
+    }
+    if (last){
+        if (ep->colBias != NULL){
+            t = vfSet1(ep->colBias[i]);
+            v0 = vfAdd(v0, t);
+            v1 = vfAdd(v1, t);
+        }
+        if (ep->rowBias != NULL){
+            v0 = vfAdd(v0, vfLoad(ep->rowBias+j));
+            v1 = vfAdd(v1, vfLoad(ep->rowBias+j+SLACH_VLEN));
+        }
+        if (ep->op == EW_ABS){
+            v0 = vfAbs(v0);
+            v1 = vfAbs(v1);
+        }
+        else if (ep->op == EW_SQRT){
+            v0 = vfSqrt(v0);
+            v1 = vfSqrt(v1);
+        }
+    }
+    vfStore(c, v0);
+    vfStore(c+SLACH_VLEN, v1);
+    //transcendental ops have no vector form here, run them while the row is hot in L1
+    if (last && ep->op != EW_NONE && ep->op != EW_ABS && ep->op != EW_SQRT){
+        ewApply(ep->op, ep->order, c, GEMM_NR);
+    }
+}
+
+/** \brief write a partial tile (matrix edge) through the epilogue, private function
+ *
+ * \param tile: MR x NR accumulators
+ * \param C, ldc, mr, nr: valid part of the tile
+ * \param first/last, ep, i0, j0
+ * \return
+ *
+ */
+
+void _gemmStoreEdge(float* tile, float* C, size_t ldc, size_t mr, size_t nr, int first, int last,
+                    GemmEpilogue* ep, size_t i0, size_t j0){
+    size_t i,j;
+    float x;
+    float* c;
+    for (i=0; i<mr; i++){
+        for (j=0; j<nr; j++){
+            c = &C[i*ldc+j];
+            x = ep->alpha*tile[i*GEMM_NR+j];
+            if (!first){
+                x += *c;
+            }
+            else if (ep->beta != 0){
+                x += ep->beta*(*c);
+            }
+            if (last){
+                if (ep->colBias != NULL) x += ep->colBias[i0+i];
+                if (ep->rowBias != NULL) x += ep->rowBias[j0+j];
+                x = ewScalar(ep->op, x, ep->order);
+            }
+            *c = x;
+        }
+    }
+}
+
+/** \brief MR x NR micro-kernel: tile += pa * pb over kc, then epilogue, private function
+ *
+ * \param kc, packed A sliver, packed B sliver
+ * \param C, ldc, mr, nr: destination tile and its valid size
+ * \param first/last, ep, i0, j0
+ * \return
+ *
+ */
+
+void _gemmKernel(size_t kc, float* pa, float* pb, float* C, size_t ldc, size_t mr, size_t nr,
+                 int first, int last, GemmEpilogue* ep, size_t i0, size_t j0){
+    vfloat c00 = vfZero(), c01 = vfZero(), c10 = vfZero(), c11 = vfZero();
+    vfloat c20 = vfZero(), c21 = vfZero(), c30 = vfZero(), c31 = vfZero();
+    vfloat c40 = vfZero(), c41 = vfZero(), c50 = vfZero(), c51 = vfZero();
+    vfloat a, b0, b1;
+    float tile[GEMM_MR*GEMM_NR];
+    size_t p;
+    for (p=0; p<kc; p++){
+        b0 = vfLoad(pb);
+        b1 = vfLoad(pb+SLACH_VLEN);
+        a = vfSet1(pa[0]); c00 = vfFmadd(a, b0, c00); c01 = vfFmadd(a, b1, c01);
+        a = vfSet1(pa[1]); c10 = vfFmadd(a, b0, c10); c11 = vfFmadd(a, b1, c11);
+        a = vfSet1(pa[2]); c20 = vfFmadd(a, b0, c20); c21 = vfFmadd(a, b1, c21);
+        a = vfSet1(pa[3]); c30 = vfFmadd(a, b0, c30); c31 = vfFmadd(a, b1, c31);
+        a = vfSet1(pa[4]); c40 = vfFmadd(a, b0, c40); c41 = vfFmadd(a, b1, c41);
+        a = vfSet1(pa[5]); c50 = vfFmadd(a, b0, c50); c51 = vfFmadd(a, b1, c51);
+        pa += GEMM_MR;
+        pb += GEMM_NR;
+    }
+    if (mr == GEMM_MR && nr == GEMM_NR){
+        _gemmStoreRow(C,       c00, c01, first, last, ep, i0,   j0);
+        _gemmStoreRow(C+ldc,   c10, c11, first, last, ep, i0+1, j0);
+        _gemmStoreRow(C+2*ldc, c20, c21, first, last, ep, i0+2, j0);
+        _gemmStoreRow(C+3*ldc, c30, c31, first, last, ep, i0+3, j0);
+        _gemmStoreRow(C+4*ldc, c40, c41, first, last, ep, i0+4, j0);
+        _gemmStoreRow(C+5*ldc, c50, c51, first, last, ep, i0+5, j0);
+    }
+    else{
+        vfStore(tile,             c00); vfStore(tile+SLACH_VLEN,             c01);
+        vfStore(tile+GEMM_NR,     c10); vfStore(tile+GEMM_NR+SLACH_VLEN,     c11);
+        vfStore(tile+2*GEMM_NR,   c20); vfStore(tile+2*GEMM_NR+SLACH_VLEN,   c21);
+        vfStore(tile+3*GEMM_NR,   c30); vfStore(tile+3*GEMM_NR+SLACH_VLEN,   c31);
+        vfStore(tile+4*GEMM_NR,   c40); vfStore(tile+4*GEMM_NR+SLACH_VLEN,   c41);
+        vfStore(tile+5*GEMM_NR,   c50); vfStore(tile+5*GEMM_NR+SLACH_VLEN,   c51);
+        _gemmStoreEdge(tile, C, ldc, mr, nr, first, last, ep, i0, j0);
+    }
+}
+
+/** \brief C = epilogue(beta*C) for k == 0, private function
+ *
+ * \param m, n, C, ldc, ep
+ * \return
+ *
+ */
+
+void _gemmScaleC(size_t m, size_t n, float* C, size_t ldc, GemmEpilogue* ep){
+    float zero[GEMM_MR*GEMM_NR];
+    size_t i,j;
+    memset(zero, 0, sizeof(zero));
+    for (i=0; i<m; i+=GEMM_MR){
+        for (j=0; j<n; j+=GEMM_NR){
+            _gemmStoreEdge(zero, C+i*ldc+j, ldc, MIN(GEMM_MR, m-i), MIN(GEMM_NR, n-j), 1, 1, ep, i, j);
+        }
+    }
+}
+
+/** \brief pack w vectors of length k as a k x wp sliver, zero padded to wp, private function
+ *
+ * \param k, w, wp
+ * \param X: element (i, p) is X[i*is+p*ps]
+ * \param packed buffer
+ * \return
+ *
+ */
+
+void _gemmPackSliver(size_t k, size_t w, size_t wp, float* X, size_t is, size_t ps, float* out){
+    size_t i, p;
+    for (p=0; p<k; p++){
+        for (i=0; i<w; i++){
+            out[i] = X[i*is+p*ps];
+        }
+        for (; i<wp; i++){
+            out[i] = 0;
+        }
+        out += wp;
+    }
+}
+
+/** \brief reproducible GEMM on row groups [g0, g1) of GEMM_REPRO_MR rows, private function
+ *
+ * \param arg: GemmReproCtx*
+ * \param g0, g1: row group range
+ * \return
+ *
+ */
+
+void _gemmReproRange(void* arg, size_t g0, size_t g1){
+    GemmReproCtx* c = (GemmReproCtx*)arg;
+    GemmEpilogue* ep = c->ep;
+    double acc[GEMM_REPRO_MR][GEMM_REPRO_NR];
+    double v;
+    float* pa = slach_malloc(float, GEMM_REPRO_MR*c->k);
+    float* b;
+    float* cp;
+    size_t i0, mr, jr, nr, p, r, j;
+    for (i0=g0*GEMM_REPRO_MR; i0<MIN(g1*GEMM_REPRO_MR, c->m); i0+=GEMM_REPRO_MR){
+        mr = MIN(GEMM_REPRO_MR, c->m-i0);
+        _gemmPackSliver(c->k, mr, GEMM_REPRO_MR, c->A+i0*c->rsA, c->rsA, c->csA, pa);
+        for (jr=0; jr<c->n; jr+=GEMM_REPRO_NR){
+            nr = MIN(GEMM_REPRO_NR, c->n-jr);
+            b = c->pb+jr*c->k;
+            memset(acc, 0, sizeof(acc));
+            for (p=0; p<c->k; p++){
+                for (r=0; r<GEMM_REPRO_MR; r++){
+                    for (j=0; j<GEMM_REPRO_NR; j++){
+                        acc[r][j] += (double)pa[p*GEMM_REPRO_MR+r]*(double)b[p*GEMM_REPRO_NR+j];
+                    }
+                }
+            }
+            for (r=0; r<mr; r++){
+                cp = c->C+(i0+r)*c->ldc+jr;
+                for (j=0; j<nr; j++){
+                    v = ep->beta == 0 ? 0.0 : (double)ep->beta*(double)cp[j];
+                    v = fma((double)ep->alpha, acc[r][j], v);
+                    if (ep->colBias != NULL) v += (double)ep->colBias[i0+r];
+                    if (ep->rowBias != NULL) v += (double)ep->rowBias[jr+j];
+                    cp[j] = ewScalar(ep->op, (float)v, ep->order);
+                }
+            }
+        }
+    }
+    slach_free(pa);
+}
+
+/** \brief reproducible GEMM, same contract as gemmEx, private function
+ *
+ * \param transA, transB, m, n, k (> 0), A, lda, B, ldb, C, ldc, ep
+ * \return
+ *
+ */
+
+void _gemmRepro(int transA, int transB, size_t m, size_t n, size_t k,
+                float* A, size_t lda, float* B, size_t ldb, float* C, size_t ldc, GemmEpilogue* ep){
+    GemmReproCtx c;
+    size_t groups, jr;
+    c.m = m; c.n = n; c.k = k;
+    c.A = A;
+    c.rsA = transA ? 1 : lda;
+    c.csA = transA ? lda : 1;
+    c.C = C; c.ldc = ldc;
+    c.ep = ep;
+    //op(B) is packed once and shared: sliver jr holds columns [jr, jr+GEMM_REPRO_NR) of op(B)
+    c.pb = slach_malloc(float, (n+GEMM_REPRO_NR)*k);
+    for (jr=0; jr<n; jr+=GEMM_REPRO_NR){
+        _gemmPackSliver(k, MIN(GEMM_REPRO_NR, n-jr), GEMM_REPRO_NR, B+jr*(transB ? ldb : 1),
+                        transB ? ldb : 1, transB ? 1 : ldb, c.pb+jr*k);
+    }
+    groups = (m+GEMM_REPRO_MR-1)/GEMM_REPRO_MR;
+    if (m*n*k >= GEMM_REPRO_PAR_MIN){
+        slach_parallel_for(groups, 1, _gemmReproRange, &c);
+    }
+    else{
+        _gemmReproRange(&c, 0, groups);
+    }
+    slach_free(c.pb);
+}
+
+/** \brief tasks [t0, t1) of one packed B panel: task t is column chunk t%nch of row block t/nch,
+ *   thread pool body, private function
+ *
+ * \param arg: GemmCtx*
+ * \param t0, t1: task range
+ * \return
+ *
+ */
+
+void _gemmBlockRange(void* arg, size_t t0, size_t t1){
+    GemmCtx* c = (GemmCtx*)arg;
+    float* pa = slach_malloc(float, c->mcb*c->kc);
+    size_t t, ic, mc, j0, j1, jr, ir, packed = (size_t)-1;
+    for (t=t0; t<t1; t++){
+        ic = t/c->nch*c->mcb;
+        mc = MIN(c->mcb, c->m-ic);
+        if (ic != packed){
+            _gemmPackA(mc, c->kc, c->A+ic*c->rsA+c->pc*c->csA, c->rsA, c->csA, pa);
+            packed = ic;
+        }
+        j0 = t%c->nch*c->ncw;
+        j1 = MIN(c->nc, j0+c->ncw);
+        for (jr=j0; jr<j1; jr+=GEMM_NR){
+            for (ir=0; ir<mc; ir+=GEMM_MR){
+                _gemmKernel(c->kc, pa+ir*c->kc, c->pb+jr*c->kc, c->C+(ic+ir)*c->ldc+c->jc+jr, c->ldc,
+                            MIN(GEMM_MR, mc-ir), MIN(GEMM_NR, c->nc-jr),
+                            c->pc == 0, c->pc+c->kc >= c->k, c->ep, ic+ir, c->jc+jr);
+            }
+        }
+    }
+    slach_free(pa);
+}
+
+/** \brief blocked GEMM engine
+ *
+ * \param transA, transB: 0/1
+ * \param m, n, k: C is m x n, op(A) is m x k, op(B) is k x n
+ * \param A, lda, B, ldb, C, ldc: row-major arrays and their leading dimensions
+ * \param ep: epilogue, NULL means C = op(A)*op(B)
+ * \return
+ *
+ */
+
+void gemmEx(int transA, int transB, size_t m, size_t n, size_t k,
+            IN float* A, size_t lda, IN float* B, size_t ldb,
+            INOUT float* C, size_t ldc, IN GemmEpilogue* ep){
+    GemmEpilogue def;
+    GemmCtx c;
+    size_t rsA, csA, rsB, csB;
+    size_t jc, pc, bmc, bkc, bnc, par, nb, slivers;
+    float* pb;
+    if (ep == NULL){
+        gemmEpilogueInit(&def);
+        ep = &def;
+    }
+    if (m == 0 || n == 0) return;
+    if (ldc < n || lda < (transA ? m : k) || ldb < (transB ? k : n)){
+        perr("In gemmEx(), leading dimension is too small!\n");
+    }
+    if (k == 0){
+        _gemmScaleC(m, n, C, ldc, ep);
+        return;
+    }
+    if (slach_get_reproducible()){
+        _gemmRepro(transA, transB, m, n, k, A, lda, B, ldb, C, ldc, ep);
+        return;
+    }
+    rsA = transA ? 1 : lda; csA = transA ? lda : 1;
+    rsB = transB ? 1 : ldb; csB = transB ? ldb : 1;
+    bmc = slach_tune()->gemmMC; bkc = slach_tune()->gemmKC; bnc = slach_tune()->gemmNC;
+    par = m*n*k >= GEMM_PAR_MIN ? (size_t)slach_get_num_threads() : 1;
+    //_gemmPackB fills whole slivers, so the last one of a block may run past nc
+    pb = slach_malloc(float, MIN(bkc, k)*((MIN(bnc, n)+GEMM_NR-1)/GEMM_NR*GEMM_NR));
+    c.A = A; c.rsA = rsA; c.csA = csA;
+    c.pb = pb; c.C = C; c.ldc = ldc; c.ep = ep;
+    c.m = m; c.k = k;
+    c.mcb = MIN(bmc, (m+GEMM_MR-1)/GEMM_MR*GEMM_MR);
+    nb = (m+c.mcb-1)/c.mcb;
+
+    for (jc=0; jc<n; jc+=bnc){
+        c.jc = jc;
+        c.nc = MIN(bnc, n-jc);
+        //enough tasks for every thread: split the columns when the row blocks are too few
+        slivers = (c.nc+GEMM_NR-1)/GEMM_NR;
+        c.nch = MIN(slivers, (2*par+nb-1)/nb);
+        c.ncw = (slivers+c.nch-1)/c.nch*GEMM_NR;
+        c.nch = (c.nc+c.ncw-1)/c.ncw;
+        for (pc=0; pc<k; pc+=bkc){
+            c.pc = pc;
+            c.kc = MIN(bkc, k-pc);
+            _gemmPackB(c.kc, c.nc, B+pc*rsB+jc*csB, rsB, csB, pb);
+            if (par > 1) slach_parallel_for(nb*c.nch, 1, _gemmBlockRange, &c);
+            else _gemmBlockRange(&c, 0, nb*c.nch);
+        }
+    }
+    slach_free(pb);
+}
+
+/** \brief whether two arrays share memory, private function
+ *
+ * \param p, lenp
+ * \param q, lenq
+ * \return 0/1
+ *
+ */
+
+int _gemmOverlap(float* p, size_t lenp, float* q, size_t lenq){
+    return (p < q+lenq) && (q < p+lenp);
+}
+
+/** \brief interface of matrix*matrix with epilogue
+ *
+ * \param 2-dim array, row, col
+ * \param 2-dim array, row, col
+ * \param ep: alpha/beta, biases and element-wise op, NULL for a plain product
+ * \param 2-dim array to save result, row, col (read as C when ep->beta != 0)
+ * \return
+ *
+ */
+
+void mmMulEx(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+             IN GemmEpilogue* ep, INOUT float* dest, size_t height, size_t width){
+    float* out = dest;
+    if (col1 != row2){
+        perr("In mmMulEx(), col1 != row2!\n");
+    }
+    if (height != row1 || width != col2){
+        perr("The size of src and dest is mismatched! \n");
+    }
+    //the engine writes C while still reading A and B, so aliased dest goes through a temporary
+    if (_gemmOverlap(dest, height*width, arr1, row1*col1) || _gemmOverlap(dest, height*width, arr2, row2*col2)){
+        out = slach_malloc(float, height*width);
+        if (ep != NULL && ep->beta != 0){
+            memcpy(out, dest, height*width*sizeof(float));
+        }
+    }
+    if (gemmUseStrassen(row1, col2, col1)){
+        gemmStrassen(0, 0, row1, col2, col1, arr1, col1, arr2, col2, out, width, ep);
+    }
+    else{
+        gemmEx(0, 0, row1, col2, col1, arr1, col1, arr2, col2, out, width, ep);
+    }
+    if (out != dest){
+        memcpy(dest, out, height*width*sizeof(float));
+        slach_free(out);
+    }
+}
@@ -0,0 +1,357 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/GEMV.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+#include "simd.h"
+
+/*
+GEMV is bound by memory bandwidth: every element of A is used once. The kernels walk
+GEMV_ROWS rows of A together so that each load of x (or of the partial result for A^T)
+is shared by several rows, and keep enough independent accumulators to hide FMA latency.
+Only problems with at least GEMV_PAR_MIN elements are split over the thread pool; each
+block gets at least GEMV_GRAIN elements of A.
+*/
+#define GEMV_ROWS 4
+#define GEMV_PAR_MIN (slach_tune()->parMin) //tunable, see tune.h
+#define GEMV_GRAIN (1<<14)
+#define GEMV_REPRO_NC 256
+
+/** \brief arguments of a GEMV row-block job
+ *
+ * \param m, n, alpha, A, lda, x, beta, y: as in gemvEx
+ * \param part: partial results of A^T*x, one row of n per block except block 0 (NULL when serial)
+ * \param grain: rows per block
+ * \return
+ *
+ */
+
+typedef struct _GemvCtx_{
+    size_t m;
+    size_t n;
+    float alpha;
+    float* A;
+    size_t lda;
+    float* x;
+    float beta;
+    float* y;
+    float* part;
+    size_t grain;
+}GemvCtx;
+
+/** \brief finish one element of y = alpha*s + beta*y, private function
+ *
+ * \param s: dot product, alpha, beta, y
+ * \return
+ *
+ */
+
+static SLACH_INLINE void _gemvStore(float s, float alpha, float beta, float* y){
+    if (beta == 0){
+        *y = alpha*s;
+    }
+    else{
+        *y = alpha*s + beta*(*y);
+    }
+}
+
+/** \brief y[r0, r1) = alpha*A[r0, r1)*x + beta*y, thread pool body, private function
+ *
+ * \param ctx: GemvCtx*
+ * \param r0, r1: row range
+ * \return
+ *
+ */
+
+void _gemvNRange(void* arg, size_t r0, size_t r1){
+    GemvCtx* c = (GemvCtx*)arg;
+    size_t n = c->n, lda = c->lda;
+    float* x = c->x;
+    float* a0; float* a1; float* a2; float* a3;
+    vfloat s0, s1, s2, s3, t0, t1, t2, t3, xv;
+    float d0, d1, d2, d3;
+    size_t i, j;
+    for (i=r0; i+GEMV_ROWS<=r1; i+=GEMV_ROWS){
+        a0 = c->A+i*lda; a1 = a0+lda; a2 = a1+lda; a3 = a2+lda;
+        s0 = s1 = s2 = s3 = vfZero();
+        t0 = t1 = t2 = t3 = vfZero();
+        for (j=0; j+2*SLACH_VLEN<=n; j+=2*SLACH_VLEN){
+            xv = vfLoad(x+j);
+            s0 = vfFmadd(vfLoad(a0+j), xv, s0);
+            s1 = vfFmadd(vfLoad(a1+j), xv, s1);
+            s2 = vfFmadd(vfLoad(a2+j), xv, s2);
+            s3 = vfFmadd(vfLoad(a3+j), xv, s3);
+            xv = vfLoad(x+j+SLACH_VLEN);
+            t0 = vfFmadd(vfLoad(a0+j+SLACH_VLEN), xv, t0);
+            t1 = vfFmadd(vfLoad(a1+j+SLACH_VLEN), xv, t1);
+            t2 = vfFmadd(vfLoad(a2+j+SLACH_VLEN), xv, t2);
+            t3 = vfFmadd(vfLoad(a3+j+SLACH_VLEN), xv, t3);
+        }
+        d0 = vfHsum(vfAdd(s0, t0)); d1 = vfHsum(vfAdd(s1, t1));
+        d2 = vfHsum(vfAdd(s2, t2)); d3 = vfHsum(vfAdd(s3, t3));
+        for (; j<n; j++){
+            d0 += a0[j]*x[j]; d1 += a1[j]*x[j];
+            d2 += a2[j]*x[j]; d3 += a3[j]*x[j];
+        }
+        _gemvStore(d0, c->alpha, c->beta, c->y+i);
+        _gemvStore(d1, c->alpha, c->beta, c->y+i+1);
+        _gemvStore(d2, c->alpha, c->beta, c->y+i+2);
+        _gemvStore(d3, c->alpha, c->beta, c->y+i+3);
+    }
+    for (; i<r1; i++){
+        a0 = c->A+i*lda;
+        s0 = s1 = s2 = s3 = vfZero();
+        for (j=0; j+4*SLACH_VLEN<=n; j+=4*SLACH_VLEN){
+            s0 = vfFmadd(vfLoad(a0+j), vfLoad(x+j), s0);
+            s1 = vfFmadd(vfLoad(a0+j+SLACH_VLEN), vfLoad(x+j+SLACH_VLEN), s1);
+            s2 = vfFmadd(vfLoad(a0+j+2*SLACH_VLEN), vfLoad(x+j+2*SLACH_VLEN), s2);
+            s3 = vfFmadd(vfLoad(a0+j+3*SLACH_VLEN), vfLoad(x+j+3*SLACH_VLEN), s3);
+        }
+        d0 = vfHsum(vfAdd(vfAdd(s0, s1), vfAdd(s2, s3)));
+        for (; j<n; j++){
+            d0 += a0[j]*x[j];
+        }
+        _gemvStore(d0, c->alpha, c->beta, c->y+i);
+    }
+}
+
+/** \brief t += sum over rows [r0, r1) of (alpha*x[i])*A[i], private function
+ *
+ * \param c: GemvCtx*
+ * \param r0, r1: row range
+ * \param t: accumulator of length n
+ * \return
+ *
+ */
+
+void _gemvTAccumulate(GemvCtx* c, size_t r0, size_t r1, float* t){
+    size_t n = c->n, lda = c->lda;
+    float* a0; float* a1; float* a2; float* a3;
+    float x0, x1, x2, x3;
+    vfloat v0, v1, v2, v3, acc;
+    size_t i, j;
+    for (i=r0; i+GEMV_ROWS<=r1; i+=GEMV_ROWS){
+        a0 = c->A+i*lda; a1 = a0+lda; a2 = a1+lda; a3 = a2+lda;
+        x0 = c->alpha*c->x[i]; x1 = c->alpha*c->x[i+1];
+        x2 = c->alpha*c->x[i+2]; x3 = c->alpha*c->x[i+3];
+        v0 = vfSet1(x0); v1 = vfSet1(x1); v2 = vfSet1(x2); v3 = vfSet1(x3);
+        for (j=0; j+SLACH_VLEN<=n; j+=SLACH_VLEN){
+            acc = vfLoad(t+j);
+            acc = vfFmadd(vfLoad(a0+j), v0, acc);
+            acc = vfFmadd(vfLoad(a1+j), v1, acc);
+            acc = vfFmadd(vfLoad(a2+j), v2, acc);
+            acc = vfFmadd(vfLoad(a3+j), v3, acc);
+            vfStore(t+j, acc);
+        }
+        for (; j<n; j++){
+            t[j] += a0[j]*x0 + a1[j]*x1 + a2[j]*x2 + a3[j]*x3;
+        }
+    }
+    for (; i<r1; i++){
+        a0 = c->A+i*lda;
+        x0 = c->alpha*c->x[i];
+        v0 = vfSet1(x0);
+        for (j=0; j+SLACH_VLEN<=n; j+=SLACH_VLEN){
+            vfStore(t+j, vfFmadd(vfLoad(a0+j), v0, vfLoad(t+j)));
+        }
+        for (; j<n; j++){
+            t[j] += a0[j]*x0;
+        }
+    }
+}
+
+/** \brief A^T*x over one row block, thread pool body, private function.
+ *   Block 0 accumulates straight into y (already scaled by beta), block b > 0 into part[b-1].
+ *
+ * \param ctx: GemvCtx*
+ * \param r0, r1: row range
+ * \return
+ *
+ */
+
+void _gemvTRange(void* arg, size_t r0, size_t r1){
+    GemvCtx* c = (GemvCtx*)arg;
+    size_t b = r0/c->grain;
+    float* t;
+    t = b == 0 ? c->y : c->part+(b-1)*c->n;
+    _gemvTAccumulate(c, r0, r1, t);
+}
+
+/** \brief reproducible finish of one element: y = alpha*s + beta*y rounded once, private function
+ *
+ * \param s: exact-order double sum, alpha, beta, y
+ * \return
+ *
+ */
+
+static SLACH_INLINE void _gemvReproStore(double s, float alpha, float beta, float* y){
+    *y = (float)fma((double)alpha, s, beta == 0 ? 0.0 : (double)beta*(double)(*y));
+}
+
+/** \brief reproducible y[r0, r1) = alpha*A*x + beta*y: each row is summed in double over
+ *   4 fixed lanes, thread pool body, private function
+ *
+ * \param ctx: GemvCtx*
+ * \param r0, r1: row range
+ * \return
+ *
+ */
+
+void _gemvReproNRange(void* arg, size_t r0, size_t r1){
+    GemvCtx* c = (GemvCtx*)arg;
+    double s[4];
+    float* a;
+    size_t i, j;
+    for (i=r0; i<r1; i++){
+        a = c->A+i*c->lda;
+        s[0] = s[1] = s[2] = s[3] = 0;
+        for (j=0; j+4<=c->n; j+=4){
+            s[0] += (double)a[j]*(double)c->x[j];
+            s[1] += (double)a[j+1]*(double)c->x[j+1];
+            s[2] += (double)a[j+2]*(double)c->x[j+2];
+            s[3] += (double)a[j+3]*(double)c->x[j+3];
+        }
+        for (; j<c->n; j++){
+            s[j&3] += (double)a[j]*(double)c->x[j];
+        }
+        _gemvReproStore((s[0]+s[1])+(s[2]+s[3]), c->alpha, c->beta, c->y+i);
+    }
+}
+
+/** \brief reproducible y[j0, j1) = alpha*A^T*x + beta*y: each column is summed in double
+ *   in row order, thread pool body, private function
+ *
+ * \param ctx: GemvCtx*
+ * \param j0, j1: column range of A (entries of y)
+ * \return
+ *
+ */
+
+void _gemvReproTRange(void* arg, size_t j0, size_t j1){
+    GemvCtx* c = (GemvCtx*)arg;
+    double acc[GEMV_REPRO_NC];
+    double xi;
+    float* a;
+    size_t i, j, jc, nc;
+    for (jc=j0; jc<j1; jc+=GEMV_REPRO_NC){
+        nc = MIN(GEMV_REPRO_NC, j1-jc);
+        memset(acc, 0, sizeof(acc));
+        for (i=0; i<c->m; i++){
+            a = c->A+i*c->lda+jc;
+            xi = (double)c->x[i];
+            for (j=0; j<nc; j++){
+                acc[j] += xi*(double)a[j];
+            }
+        }
+        for (j=0; j<nc; j++){
+            _gemvReproStore(acc[j], c->alpha, c->beta, c->y+jc+j);
+        }
+    }
+}
+
+/** \brief y = alpha*op(A)*x + beta*y, A is m x n row-major with leading dimension lda
+ *
+ * \param trans: 0 for A*x (y has m elements), 1 for A^T*x (y has n elements)
+ * \param m, n, alpha, A, lda
+ * \param x, beta, y
+ * \return
+ *
+ */
+
+void gemvEx(int trans, size_t m, size_t n, float alpha, IN float* A, size_t lda,
+            IN float* x, float beta, INOUT float* y){
+    GemvCtx c;
+    size_t nt, nb, b, j, leny, cols;
+    if (lda < n){
+        perr("In gemvEx(), leading dimension is too small!\n");
+    }
+    leny = trans ? n : m;
+    if (leny == 0) return;
+    if (m == 0 || n == 0 || alpha == 0){
+        for (j=0; j<leny; j++){
+            y[j] = beta == 0 ? 0 : beta*y[j];
+        }
+        return;
+    }
+    c.m = m; c.n = n; c.alpha = alpha; c.A = A; c.lda = lda;
+    c.x = x; c.beta = beta; c.y = y; c.part = NULL;
+    nt = m*n < GEMV_PAR_MIN ? 1 : (size_t)slach_get_num_threads();
+    //at least GEMV_GRAIN elements of A per block, and a multiple of GEMV_ROWS rows
+    c.grain = MAX((m+nt-1)/nt, (GEMV_GRAIN+n-1)/n);
+    c.grain = (c.grain+GEMV_ROWS-1)/GEMV_ROWS*GEMV_ROWS;
+    nb = (m+c.grain-1)/c.grain;
+
+    if (slach_get_reproducible()){
+        //every output owns its whole ordered sum, threads only split the outputs
+        if (trans){
+            //blocks of columns with at least GEMV_GRAIN elements of A each
+            cols = m*n < GEMV_PAR_MIN ? n : MAX(1, GEMV_GRAIN/m);
+            slach_parallel_for(n, cols, _gemvReproTRange, &c);
+        }
+        else{
+            slach_parallel_for(m, c.grain, _gemvReproNRange, &c);
+        }
+        return;
+    }
+
+    if (!trans){
+        slach_parallel_for(m, c.grain, _gemvNRange, &c);
+        return;
+    }
+    for (j=0; j<n; j++){
+        y[j] = beta == 0 ? 0 : beta*y[j];
+    }
+    if (nb > 1){
+        //zeroed up front: a nested call runs the whole range as block 0
+        c.part = slach_malloc(float, (nb-1)*n);
+        memset(c.part, 0, (nb-1)*n*sizeof(float));
+    }
+    slach_parallel_for(m, c.grain, _gemvTRange, &c);
+    //fixed reduction order keeps the result independent of the schedule
+    for (b=0; b+1<nb; b++){
+        for (j=0; j<n; j++){
+            y[j] += c.part[b*n+j];
+        }
+    }
+    if (c.part != NULL){
+        slach_free(c.part);
+    }
+}
@@ -38,6 +38,11 @@ limitations under the License.
 
 */
 #include "../include/LUD.h"
+#include "../include/GEMM.h"
+#include "../include/TRSM.h"
+#include "../include/tune.h"
+
+#define LU_BLOCK (slach_tune()->luBlock) //tunable, see tune.h
 
 /** \brief LUD result data structure
  *
@@ -52,7 +57,14 @@ typedef struct _LUDecRes_{
     Vector* piv;
 }LUDecRes;
 
-/** \brief LUD implementation, private function
+struct _SlachLU_{
+    LUDecRes res;
+    int singular;
+};
+
+/** \brief LUD implementation, private function. Right-looking blocked LU with partial
+ *   pivoting: each panel of LU_BLOCK columns is factored column by column, then the rows to
+ *   its right are solved with trsmEx and the trailing matrix is updated with one gemmEx.
  *
  * \param 2-dim array, row, col
  * \return LUDecRes
@@ -61,112 +73,275 @@ typedef struct _LUDecRes_{
 
 LUDecRes _LUdec(INOUT float* arr, size_t row, size_t col){
     LUDecRes result;
-    Matrix* LU = createMatrix(row, col);
-    size_t i,j,k;
-    Vector* piv = createVector(row);
-    Vector* LUrowi = createVector(row);
-    Vector* LUcolj = createVector(col);
-    size_t kmax,p;
-    float s;
+    Matrix* LU;
+    Vector* piv;
+    GemmEpilogue ep;
+    float* a;
+    size_t n = col;
+    size_t i,j,k,p,j0,j1,bs = LU_BLOCK;
+    float big, r;
     if (row != col){
         perr("row != col in LUD!\n");
     }
+    LU = createMatrix(row, col);
+    piv = createVector(row);
     arrayToMatrix(arr, LU, row, col);
+    a = LU->mData[0];
     for (i=0; i<row; i++){
         piv->vData[i] = i;
     }
-    for (j=0; j<col; j++){
-        for (i=0; i<row; i++){
-            LUcolj->vData[i] = LU->mData[i][j];
-        }
-        for (i=0; i<row; i++){
-            for (k=0; k<col; k++){
-                LUrowi->vData[k] = LU->mData[i][k];
+    gemmEpilogueInit(&ep);
+    ep.alpha = -1; ep.beta = 1;
+    for (j0=0; j0<n; j0+=bs){
+        j1 = MIN(n, j0+bs);
+        for (j=j0; j<j1; j++){
+            p = j;
+            big = (float)fabs((double)a[j*n+j]);
+            for (i=j+1; i<n; i++){
+                if ((float)fabs((double)a[i*n+j]) > big){
+                    big = (float)fabs((double)a[i*n+j]);
+                    p = i;
+                }
             }
-            kmax = MAX(i,j);
-            s = 0;
-            for (k=0; k<kmax; k++){
-                s += LUcolj->vData[k]*LUrowi->vData[k];
+            //whole rows are swapped, so L to the left of the panel follows the pivots too
+            if (p != j){
+                for (k=0; k<n; k++){
+                    swap(&a[p*n+k], &a[j*n+k]);
+                }
+                swap(&piv->vData[p], &piv->vData[j]);
             }
-            LUrowi->vData[j] -= s;
-            LUcolj->vData[i] -= s;
-        }
-        p =j;
-        for (i=j+1; i<row; i++){
-            if (fabs((double)LUcolj->vData[i] > fabs((double)LUcolj->vData[p])))
-                p = i;
-        }
-        if (p != j){
-            for (k=0; k<col; k++){
-                swap(&LU->mData[p][k], &LU->mData[j][k]);
+            //a zero pivot means the column below is zero as well; _isLUNonsingular reports it
+            if (a[j*n+j] != 0){
+                r = 1/a[j*n+j];
+                for (i=j+1; i<n; i++){
+                    a[i*n+j] *= r;
+                    for (k=j+1; k<j1; k++){
+                        a[i*n+k] -= a[i*n+j]*a[j*n+k];
+                    }
+                }
             }
-            swap(&piv->vData[p], &piv->vData[j]);
         }
-        if ((j < row) && LU->mData[j][j] <= FLOAT_EPSILON && LU->mData[j][j] >= -FLOAT_EPSILON){
-            for (i=j+1; i<row; i++){
-                LU->mData[i][j] /= LU->mData[j][j];
-            }
+        if (j1 < n){
+            trsmEx(SLACH_LEFT, SLACH_LOWER, 0, SLACH_UNIT, j1-j0, n-j1, 1, a+j0*n+j0, n, a+j0*n+j1, n);
+            gemmEx(0, 0, n-j1, n-j1, j1-j0, a+j1*n+j0, n, a+j0*n+j1, n, a+j1*n+j1, n, &ep);
         }
     }
-    destroyVector(LUrowi); destroyVector(LUcolj);
     result.LU = LU;
     result.piv = piv;
     return result;
 }
 
-/** \brief permute copy for LUsolvev, private function
+/** \brief determine whether matrix is non-singular, private function
  *
- * \param Vector* b
  * \param LUD result
- * \return Vector*
+ * \return 0/1
+ *
+ */
+
+int _isLUNonsingular(LUDecRes temp){
+    size_t j;
+    for (j=0; j<temp.LU->mHeight; j++){
+        if ((float)fabs((double)temp.LU->mData[j][j]) <= FLOAT_EPSILON)
+            return 0;
+    }
+    return 1;
+}
+
+/** \brief factors a square matrix once, PA = LU, for any number of later solves
+ *
+ * \param 2-dim array, row, col
+ * \return SlachLU*: free with LUfactorDestroy
  *
  */
 
-Vector* _permuteCopy1(Vector* v, LUDecRes res){
-    size_t pivLen = res.piv->vLength;
-    Vector* x = createVector(pivLen);
+SlachLU* LUfactor(IN float* arr, size_t row, size_t col){
+    SlachLU* lu;
+    if (arr == NULL) perr("In LUfactor, arr is NULL!\n");
+    lu = slach_malloc(struct _SlachLU_, 1);
+    lu->res = _LUdec(arr, row, col);
+    lu->singular = !_isLUNonsingular(lu->res);
+    return lu;
+}
+
+/** \brief frees a factorization
+ *
+ * \param lu
+ * \return
+ *
+ */
+
+void LUfactorDestroy(SlachLU* lu){
+    if (lu == NULL) return;
+    destroyMatrix(lu->res.LU);
+    destroyVector(lu->res.piv);
+    slach_free(lu);
+}
+
+/** \brief size of the factored matrix
+ *
+ * \param lu
+ * \return size_t
+ *
+ */
+
+size_t LUfactorSize(const SlachLU* lu){
+    return lu->res.LU->mHeight;
+}
+
+/** \brief whether a pivot of the factorization is zero (up to FLOAT_EPSILON)
+ *
+ * \param lu
+ * \return 0/1
+ *
+ */
+
+int LUfactorSingular(const SlachLU* lu){
+    return lu->singular;
+}
+
+/** \brief solves op(A)X = B with the factors, private function
+ *
+ *   A = P^T L U, so AX = B is LY = PB, UX = Y, and A^T X = B is U^T Y = B, L^T Z = Y,
+ *   X = P^T Z. B is read in full before X is written, so they may be the same array.
+ *
+ * \param lu
+ * \param trans: 1 solves A^T X = B
+ * \param B: n x nrhs
+ * \param nrhs
+ * \param X: n x nrhs
+ * \param name: caller, for the error message
+ * \return
+ *
+ */
+
+void _LUfactorSolve(const SlachLU* lu, int trans, IN float* B, size_t nrhs, OUT float* X, const char* name){
+    char msg[128];
+    size_t n = lu->res.LU->mHeight;
+    float* a = lu->res.LU->mData[0];
+    float* piv = lu->res.piv->vData;
+    float* w;
     size_t i;
-    if (pivLen != v->vLength){
-        perr("problem in _permuteCopy1\n");
+    if (B == NULL || X == NULL){
+        snprintf(msg, sizeof(msg), "In %s, arrays can't be NULL!\n", name);
+        perr(msg);
     }
-    for (i=0; i<pivLen; i++){
-        x->vData[i] = v->vData[(int)res.piv->vData[i]];
+    if (lu->singular){
+        snprintf(msg, sizeof(msg), "In %s, arr1 is singular.\n", name);
+        perr(msg);
     }
-    return x;
+    w = slach_malloc(float, n*nrhs);
+    if (!trans){
+        for (i=0; i<n; i++) memcpy(w + i*nrhs, B + (size_t)piv[i]*nrhs, nrhs*sizeof(float));
+        trsmEx(SLACH_LEFT, SLACH_LOWER, 0, SLACH_UNIT, n, nrhs, 1, a, n, w, nrhs);
+        trsmEx(SLACH_LEFT, SLACH_UPPER, 0, SLACH_NON_UNIT, n, nrhs, 1, a, n, w, nrhs);
+        memcpy(X, w, n*nrhs*sizeof(float));
+    }
+    else{
+        memcpy(w, B, n*nrhs*sizeof(float));
+        trsmEx(SLACH_LEFT, SLACH_UPPER, 1, SLACH_NON_UNIT, n, nrhs, 1, a, n, w, nrhs);
+        trsmEx(SLACH_LEFT, SLACH_LOWER, 1, SLACH_UNIT, n, nrhs, 1, a, n, w, nrhs);
+        for (i=0; i<n; i++) memcpy(X + (size_t)piv[i]*nrhs, w + i*nrhs, nrhs*sizeof(float));
+    }
+    slach_free(w);
 }
-/** \brief permute copy for LUsolvem, private function
+
+/** \brief solves Ax = b or A^T x = b with a factorization, O(n^2)
  *
- * \param Matrix* B
- * \param LUD result
- * \return Matrix*
+ * \param lu
+ * \param trans: 0 for A, 1 for A^T
+ * \param 1-dim array b, len1
+ * \param 1-dim array to save result, len2
+ * \return
  *
  */
 
-Matrix* _permuteCopy2(Matrix* m, LUDecRes res, size_t j0, size_t j1){
-    int pivLen = res.piv->vLength;
-    Matrix* X = createMatrix(pivLen, j1-j0+1);
+void LUfactorSolvev(const SlachLU* lu, int trans, IN float* arr, size_t len1, OUT float* dest, size_t len2){
+    size_t n = lu->res.LU->mHeight;
+    if (len1 != n || len2 != n) perr("In LUfactorSolvev, len1 or len2 != the size of the factorization\n");
+    _LUfactorSolve(lu, trans, arr, 1, dest, "LUfactorSolvev");
+}
+
+/** \brief solves AX = B or A^T X = B with a factorization
+ *
+ * \param lu
+ * \param trans: 0 for A, 1 for A^T
+ * \param 2-dim array B, row, col
+ * \param 2-dim array to save result, height, width
+ * \return
+ *
+ */
+
+void LUfactorSolvem(const SlachLU* lu, int trans, IN float* arr, size_t row, size_t col,
+                    OUT float* dest, size_t height, size_t width){
+    size_t n = lu->res.LU->mHeight;
+    if (row != n) perr("In LUfactorSolvem, row != the size of the factorization\n");
+    if (height != row || width != col) perr("The size of src and dest is mismatched! \n");
+    _LUfactorSolve(lu, trans, arr, col, dest, "LUfactorSolvem");
+}
+
+/** \brief the unit lower triangular factor L
+ *
+ * \param lu
+ * \param 2-dim array to save result, height, width
+ * \return
+ *
+ */
+
+void LUfactorL(const SlachLU* lu, OUT float* dest, size_t height, size_t width){
+    size_t n = lu->res.LU->mHeight;
+    Matrix* temp = createMatrix(n, n);
     size_t i,j;
-    for (i=0; i<pivLen; i++){
-        for (j=j0; j<=j1; j++){
-            X->mData[i][j-j0] = m->mData[(int)res.piv->vData[i]][j];
+    for (i=0; i<n; i++){
+        for (j=0; j<i; j++){
+            temp->mData[i][j] = lu->res.LU->mData[i][j];
         }
+        temp->mData[i][i] = 1;
     }
-    return X;
+    matrixToArray(temp, dest, height, width);
 }
-/** \brief determine whether matrix is non-singular, private function
+
+/** \brief the upper triangular factor U
  *
- * \param LUD result
- * \return 0/1
+ * \param lu
+ * \param 2-dim array to save result, height, width
+ * \return
  *
  */
 
-int _isLUNonsingular(LUDecRes temp){
-    size_t j;
-    for (j=0; j<temp.LU->mHeight; j++){
-        if ((float)fabs((double)temp.LU->mData[j][j]) <= FLOAT_EPSILON)
-            return 0;
+void LUfactorU(const SlachLU* lu, OUT float* dest, size_t height, size_t width){
+    size_t n = lu->res.LU->mHeight;
+    Matrix* temp = createMatrix(n, n);
+    size_t i,j;
+    for (i=0; i<n; i++){
+        for (j=i; j<n; j++){
+            temp->mData[i][j] = lu->res.LU->mData[i][j];
+        }
     }
-    return 1;
+    matrixToArray(temp, dest, height, width);
+}
+
+/** \brief the row permutation P, with PA = LU
+ *
+ * \param lu
+ * \param 2-dim array to save P, height, width, or NULL
+ * \param piv: n entries, row i of PA is row piv[i] of A, or NULL
+ * \return
+ *
+ */
+
+void LUfactorP(const SlachLU* lu, OUT float* dest, size_t height, size_t width, OUT size_t* piv){
+    size_t n = lu->res.LU->mHeight;
+    Matrix* temp;
+    size_t i;
+    if (piv != NULL){
+        for (i=0; i<n; i++) piv[i] = (size_t)lu->res.piv->vData[i];
+    }
+    if (dest == NULL) return;
+    temp = createMatrix(n, n);
+    for (i=0; i<n; i++){
+        temp->mData[i][(size_t)lu->res.piv->vData[i]] = 1;
+    }
+    matrixToArray(temp, dest, height, width);
 }
 
 /** \brief interface to get L
@@ -178,20 +353,9 @@ int _isLUNonsingular(LUDecRes temp){
  */
 
 void getL(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    size_t p = MIN(row, col);
-    Matrix* temp = createMatrix(row, p);
-    LUDecRes LU = _LUdec(arr, row, col);
-    size_t i,j;
-    for (i=0; i<row; i++){
-        for (j=0; j<i && j<col; j++){
-            temp->mData[i][j] = LU.LU->mData[i][j];
-        }
-    }
-    for (i=0; i<p; i++)
-        temp->mData[i][i] = 1;
-
-    destroyMatrix(LU.LU); destroyVector(LU.piv);
-    matrixToArray(temp, dest, height, width);
+    SlachLU* lu = LUfactor(arr, row, col);
+    LUfactorL(lu, dest, height, width);
+    LUfactorDestroy(lu);
 }
 
 /** \brief interface to get U
@@ -202,55 +366,29 @@ void getL(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t heig
  *
  */
 void getU(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    size_t p = MIN(row, col);
-    Matrix* temp = createMatrix(p, col);
-    LUDecRes LU = _LUdec(arr, row, col);
-    size_t i,j;
-
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            temp->mData[i][j] = LU.LU->mData[i][j];
-        }
-    }
-    destroyMatrix(LU.LU); destroyVector(LU.piv);
-    matrixToArray(temp, dest, height, width);
+    SlachLU* lu = LUfactor(arr, row, col);
+    LUfactorU(lu, dest, height, width);
+    LUfactorDestroy(lu);
 }
 
 /** \brief interface to solve equations. AX = b
  *
  * \param 2-dim array, row, col
  * \param 1-dim array, len
- * \param 2-dim array to save result, row, col
+ * \param 1-dim array to save result, len
  * \return
  *
  */
 void LUsolvev(INOUT float* arr1, size_t row, size_t col, INOUT float* arr2, size_t len1,
               OUT float* dest, size_t len2){
-    Vector* b = createVector(len1);
-    arrayToVector(arr2, b, len1);
-    LUDecRes temp = _LUdec(arr1, row, col);
-    Vector* x = _permuteCopy1(b, temp);
-    int i,k;
-
+    SlachLU* lu;
     if (len1 != row){
         perr("In LUsolvev, len1 != row\n");
     }
-    if (!_isLUNonsingular(temp)){
-        perr("In LUsolvev, arr1 is singular.\n");
-    }
-    for (k=0; k<col; k++){
-        for (i=k+1; i<row; i++){
-            x->vData[i] -= x->vData[k]*temp.LU->mData[i][k];
-        }
-    }
-    for (k=col-1; k>=0; k--){
-        x->vData[k] /= temp.LU->mData[k][k];
-        for (i=0; i<k; i++){
-            x->vData[i] -= x->vData[k]*temp.LU->mData[i][k];
-        }
-    }
-    destroyMatrix(temp.LU); destroyVector(temp.piv); destroyVector(b);
-    vectorToArray(x, dest, len2);
+    lu = LUfactor(arr1, row, col);
+    if (len2 != row) perr("The size of src and dest is mismatched! \n");
+    _LUfactorSolve(lu, 0, arr2, 1, dest, "LUsolvev");
+    LUfactorDestroy(lu);
 }
 /** \brief interface to solve equations. AX = B.
  *
@@ -262,38 +400,15 @@ void LUsolvev(INOUT float* arr1, size_t row, size_t col, INOUT float* arr2, size
  */
 void LUsolvem(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
               OUT float* dest, size_t height, size_t width){
-    // dimensions: A is mxn, X is nxk, B is mxk
-    Matrix* B = createMatrix(row2, col2);
-    arrayToMatrix(arr2, B, row2, col2);
-    LUDecRes temp = _LUdec(arr1, row1, col1);
-    size_t nx;
-    Matrix* X;
-    int i,j,k;
-    if (col2 != row1) perr("In LUsolvem, len1 != row\n");
-    if (!_isLUNonsingular(temp)){
-        perr("In LUsolvem, arr1 is singular.\n");
+    // dimensions: A is nxn, X is nxk, B is nxk
+    SlachLU* lu;
+    if (row2 != row1){
+        perr("In LUsolvem, row2 != row1\n");
     }
-    nx = B->mWidth;
-    X = _permuteCopy2(B, temp, 0, nx-1);
-
-    for (k=0; k<row1; k++){
-        for (i=k+1; i<col1; i++)
-            for (j=0; j<nx; j++){
-                X->mData[i][j] -= X->mData[k][j]*temp.LU->mData[i][k];
-        }
-    }
-
-    for (k=col1-1; k>=0; k--){
-        for (j=0; j<nx; j++){
-            X->mData[k][j] /= temp.LU->mData[k][k];
-        }
-        for (i=0; i<k; i++)
-            for (j=0; j<nx; j++)
-                X->mData[i][j] -= X->mData[k][j]*temp.LU->mData[i][k];
-    }
-
-    destroyMatrix(temp.LU); destroyVector(temp.piv);destroyMatrix(B);
-    matrixToArray(X, dest, height, width);
+    lu = LUfactor(arr1, row1, col1);
+    if (height != row2 || width != col2) perr("The size of src and dest is mismatched! \n");
+    _LUfactorSolve(lu, 0, arr2, col2, dest, "LUsolvem");
+    LUfactorDestroy(lu);
 }
 
 
@@ -306,9 +421,13 @@ void LUsolvem(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, si
  */
 
 void inv(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    Matrix* B = _eyem(col);
-    float b[col][col];
+    Matrix* B;
+    SlachLU* lu;
     if (row != col)  perr("inv needs squared matrix!\n");
-    matrixToArray(B, b, col, col);
-    LUsolvem(arr, row, col, b, col, col,  dest, height, width);
+    if (height != row || width != col) perr("The size of src and dest is mismatched! \n");
+    lu = LUfactor(arr, row, col);
+    B = _eyem(col);
+    _LUfactorSolve(lu, 0, B->mData[0], col, dest, "inv");
+    LUfactorDestroy(lu);
+    destroyMatrix(B);
 }
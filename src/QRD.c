@@ -39,6 +39,8 @@ limitations under the License.
 
 
 #include "../include/QRD.h"
+#include "../include/GEMV.h"
+#include "../include/TRSM.h"
 
 /** \brief QRD result data structure
  *
@@ -67,8 +69,9 @@ QRDecRes _QRdec(INOUT float* arr, size_t row, size_t col){
     int i,j,k;
     float nrm;
     float s;
-    if (row != col){
-        perr("row != col in QRD!\n");
+    //Householder QR of a tall matrix, the solvers then give least squares solutions
+    if (row < col){
+        perr("row < col in QRD!\n");
     }
     QR = createMatrix(row, col);
     arrayToMatrix(arr, QR, row, col);
@@ -177,47 +180,85 @@ void getR(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t heig
 }
 
 
+/** \brief X = Q^T X, X is m x nx, private function
+ *
+ * \param QRD result
+ * \param X, nx
+ * \return
+ *
+ */
+void _QRapplyQt(QRDecRes temp, float* X, size_t nx){
+    size_t m = temp.QR->mHeight;
+    size_t n = temp.QR->mWidth;
+    float* v = slach_malloc(float, m);
+    float* w = slach_malloc(float, nx);
+    size_t i,j,k;
+    float s;
+    for (k=0; k<n; k++){
+        //reflector k is stored below the diagonal of column k, w = v^T X
+        for (i=k; i<m; i++){
+            v[i-k] = temp.QR->mData[i][k];
+        }
+        gemvEx(1, m-k, nx, 1, X+k*nx, nx, v, 0, w);
+        s = -1/temp.QR->mData[k][k];
+        for (i=k; i<m; i++){
+            for (j=0; j<nx; j++){
+                X[i*nx+j] += s*v[i-k]*w[j];
+            }
+        }
+    }
+    slach_free(v); slach_free(w);
+}
+
+/** \brief X = R^{-1} X on the first n rows of X, private function
+ *
+ * \param QRD result
+ * \param X, nx
+ * \return
+ *
+ */
+void _QRsolveR(QRDecRes temp, float* X, size_t nx){
+    size_t n = temp.QR->mWidth;
+    float* R = slach_malloc(float, n*n);
+    size_t i,j;
+    //the diagonal of QR holds the reflectors, R's own diagonal is RDiag
+    for (i=0; i<n; i++){
+        R[i*n+i] = temp.RDiag->vData[i];
+        for (j=i+1; j<n; j++){
+            R[i*n+j] = temp.QR->mData[i][j];
+        }
+    }
+    trsmEx(SLACH_LEFT, SLACH_UPPER, 0, SLACH_NON_UNIT, n, nx, 1, R, n, X, nx);
+    slach_free(R);
+}
+
 /** \brief interface to solve equations. AX = b
  *
  * \param 2-dim array, row, col
  * \param 1-dim array, len
- * \param 2-dim array to save result, row, col
+ * \param 1-dim array to save result, len
  * \return
  *
  */
 void QRsolvev(INOUT float* arr1, size_t row, size_t col, INOUT float* arr2, size_t len1,
               OUT float* dest, size_t len2){
-    QRDecRes temp = _QRdec(arr1, row, col);
-    size_t m = temp.QR->mHeight;
-    size_t n = temp.QR->mWidth;
-    int i,k,s;
-    Vector* x_;
+    QRDecRes temp;
+    Vector* x;
+    if (len1 != row){
+        perr("In QRsolvev, len1 != row\n");
+    }
+    temp = _QRdec(arr1, row, col);
     if (!_isFullRank(temp))
-        perr("in QRD, arr1 is full rank!\n");
-    Vector* x = createVector(len1);
+        perr("in QRD, arr1 is not full rank!\n");
+    x = createVector(len1);
     arrayToVector(arr2, x, len1);
-
-    for (k=0; k<n; k++){
-        s = 0;
-        for (i=k; i<m; i++)
-            s += temp.QR->mData[i][k]*x->vData[i];
-        s = -s/temp.QR->mData[k][k];
-        for (i=k; i<m; i++)
-            x->vData[i] += s*temp.QR->mData[i][k];
-        }
-
-    for (k=n-1; k>=0; k--){
-        x->vData[k] /= temp.RDiag->vData[k];
-        for (i=0; i<k; i++)
-            x->vData[i] -= x->vData[k]*temp.QR->mData[i][k];
+    _QRapplyQt(temp, x->vData, 1);
+    _QRsolveR(temp, x->vData, 1);
+    if (len2 != col){
+        perr("The size of src and dest is mismatched! \n");
     }
-
-    x_ = createVector(n);
-    for (i=0; i<n; i++)
-        x_->vData[i] = x->vData[i];
-    vectorToArray(x_, dest, len2);
-    destroyMatrix(temp.QR);destroyVector(temp.RDiag);destroyVector(x_);
-
+    memcpy(dest, x->vData, col*sizeof(float));
+    destroyMatrix(temp.QR);destroyVector(temp.RDiag);destroyVector(x);
 }
 
 /** \brief interface to solve equations. AX = B
@@ -230,44 +271,21 @@ void QRsolvev(INOUT float* arr1, size_t row, size_t col, INOUT float* arr2, size
  */
 void QRsolvem(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
               OUT float* dest, size_t height, size_t width){
-    QRDecRes temp = _QRdec(arr1, row1, col1);
-    size_t m = temp.QR->mHeight;
-    size_t n = temp.QR->mWidth;
-    size_t nx = col2;
-    int i,j,k;
-    Matrix* X = createMatrix(row2, col2);
-    arrayToMatrix(arr2, X, row2, col2);
-    Matrix* X_;
-    float s;
-    if (!_isFullRank(temp))
-        perr("in QRD, arr1 is full rank!\n");
-    for (k=0; k<n; k++){
-        for (j=0; j<nx; j++){
-            s = 0;
-            for (i=k; i<m; i++){
-                s += temp.QR->mData[i][k]*X->mData[i][j];
-            }
-            s = -s/temp.QR->mData[k][k];
-            for (i=k; i<m; i++)
-                X->mData[i][j] += s*temp.QR->mData[i][k];
-        }
+    QRDecRes temp;
+    Matrix* X;
+    if (row2 != row1){
+        perr("In QRsolvem, row2 != row1\n");
     }
-
-    for (k=n-1; k>=0; k--){
-        for (j=0; j<nx; j++)
-            X->mData[k][j] /= temp.RDiag->vData[k];
-        for (i=0; i<k; i++)
-            for (j=0; j<nx; j++)
-                X->mData[i][j] -= X->mData[k][j]*temp.QR->mData[i][k];
+    if (height != col1 || width != col2){
+        perr("The size of src and dest is mismatched! \n");
     }
-
-    X_ = createMatrix(n, nx);
-    for (i=0; i<n; i++)
-        for (j=0; j<nx; j++)
-            X_->mData[i][j] = X->mData[i][j];
-
-    matrixToArray(X_, arr2, height, width);
+    temp = _QRdec(arr1, row1, col1);
+    if (!_isFullRank(temp))
+        perr("in QRD, arr1 is not full rank!\n");
+    X = createMatrix(row2, col2);
+    arrayToMatrix(arr2, X, row2, col2);
+    _QRapplyQt(temp, X->mData[0], col2);
+    _QRsolveR(temp, X->mData[0], col2);
+    memcpy(dest, X->mData[0], col1*col2*sizeof(float));
     destroyMatrix(temp.QR);destroyVector(temp.RDiag);destroyMatrix(X);
-
 }
-
@@ -38,6 +38,10 @@ limitations under the License.
 
 */
 #include "../include/SVD.h"
+#include "../include/GEMM.h"
+
+#define SVD_MAX_ITER 10000
+#define SVD_MIN_ITER 32 //a start nearly orthogonal to the top vector looks converged at first
 
 /** \brief SVD result data structure
  *
@@ -62,12 +66,13 @@ typedef struct _SVD_{
 void _svd_1d(Matrix* A, Vector* v_){
 	int n = A->mHeight;
 	int m = A->mWidth;
-	int i,j,k;
+	int i,j;
 	Matrix* B ;
 	float sum, norm;
 	Vector* currentV = createVector(m);
     int iter = 0;
-	float epsilon = pow(10,-10);
+	//1-1e-10 is not representable in float, the cosine of two unit vectors resolves to a few ulps
+	float epsilon = 2*FLOAT_EPSILON;
 	Vector* lastV;
 	float norm2;
 	slach_rand_seed(0);
@@ -83,29 +88,14 @@ void _svd_1d(Matrix* A, Vector* v_){
 	for (i=0; i<m; i++){
         currentV->vData[i] = currentV->vData[i]/sum;
 	}
+	//the Gram matrix is symmetric: one triangle through syrkEx, then mirrored
 	if (n>m){
 		B = createMatrix(m,m);
-		for (i=0; i<m; i++){
-			for (j=0; j<m; j++){
-                sum = 0;
-                for (k=0; k<n; k++){
-                    sum += A->mData[k][i]*A->mData[k][j];
-                }
-				B->mData[i][j] = sum;
-			}
-		}
+		syrkEx(SLACH_LOWER, 1, m, n, 1, A->mData[0], m, 0, B->mData[0], m, 1);
 	}
 	else{
 		B = createMatrix(n,n);
-		for (i=0; i<n; i++){
-			for (j=0; j<n; j++){
-                    sum = 0;
-                    for (k=0; k<m; k++){
-                        sum += A->mData[i][k]*A->mData[j][k];
-                    }
-				B->mData[i][j] = sum;
-			}
-		}
+		syrkEx(SLACH_LOWER, 0, n, m, 1, A->mData[0], m, 0, B->mData[0], n, 1);
 	}
 
     lastV = createVector(currentV->vLength);
@@ -130,9 +120,9 @@ void _svd_1d(Matrix* A, Vector* v_){
 		}
 		iter++;
 
-		if (fabs(sum) > 1-epsilon){
+		if ((fabs(sum) >= 1-epsilon && iter >= SVD_MIN_ITER) || iter >= SVD_MAX_ITER){
             copyVector(currentV, v_);
-			destroyVector(currentV); destroyVector(lastV);
+			destroyVector(currentV); destroyVector(lastV); destroyMatrix(B);
 			break;
 		}
 
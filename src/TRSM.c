@@ -0,0 +1,335 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/TRSM.h"
+#include "../include/GEMM.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+#include "simd.h"
+
+/*
+Blocked TRSM/TRMM. The triangle of op(A) is cut into TRSM_BLOCK x TRSM_BLOCK diagonal
+blocks; each is copied into a small buffer laid out for the kernel (rows of op(A) for the
+left side, columns for the right side) so the kernels never care about transA, and all the
+rectangular blocks between them become gemmEx updates. For n right-hand sides that leaves
+O(TRSM_BLOCK/n) of the flops outside GEMM. Diagonal kernels with at least TRSM_PAR_MIN
+flops are split over the thread pool by columns (left) or rows (right) of B.
+*/
+#define TRSM_BLOCK (slach_tune()->trsmBlock) //tunable, see tune.h
+#define TRSM_CHUNK 256
+#define TRSM_PAR_MIN (slach_tune()->parMin)
+#define TRSM_ROW_GRAIN 16
+
+/** \brief arguments of a diagonal block job
+ *
+ * \param solve: 1 for TRSM, 0 for TRMM
+ * \param lower: op(A) is lower triangular
+ * \param unit: unit diagonal
+ * \param blk, nb: diagonal block of op(A), nb x nb (row-wise for the left side, column-wise for the right side)
+ * \param B, ldb, k0: B and the first row (left) or column (right) covered by the block
+ * \return
+ *
+ */
+
+typedef struct _TriCtx_{
+    int solve;
+    int lower;
+    int unit;
+    float* blk;
+    size_t nb;
+    float* B;
+    size_t ldb;
+    size_t k0;
+}TriCtx;
+
+/** \brief y += a*x, private function
+ *
+ * \param n, a, x, y
+ * \return
+ *
+ */
+
+void _triAxpy(size_t n, float a, float* x, float* y){
+    vfloat va = vfSet1(a);
+    size_t i;
+    for (i=0; i+SLACH_VLEN<=n; i+=SLACH_VLEN){
+        vfStore(y+i, vfFmadd(va, vfLoad(x+i), vfLoad(y+i)));
+    }
+    for (; i<n; i++){
+        y[i] += a*x[i];
+    }
+}
+
+/** \brief x *= a, private function
+ *
+ * \param n, a, x
+ * \return
+ *
+ */
+
+void _triScal(size_t n, float a, float* x){
+    vfloat va = vfSet1(a);
+    size_t i;
+    for (i=0; i+SLACH_VLEN<=n; i+=SLACH_VLEN){
+        vfStore(x+i, vfMul(va, vfLoad(x+i)));
+    }
+    for (; i<n; i++){
+        x[i] *= a;
+    }
+}
+
+/** \brief address of the block of op(A) starting at (r0, c0), private function
+ *
+ * \param A, lda, trans
+ * \param r0, c0
+ * \return float*: to be passed to gemmEx with the same trans and lda
+ *
+ */
+
+float* _triSub(float* A, size_t lda, int trans, size_t r0, size_t c0){
+    return trans ? A + c0*lda + r0 : A + r0*lda + c0;
+}
+
+/** \brief columns [c0, c1) of rows k0..k0+nb-1 of B against a diagonal block (left side), private function
+ *
+ * \param arg: TriCtx*, c0, c1
+ * \return
+ *
+ */
+
+void _triLeftRange(void* arg, size_t c0, size_t c1){
+    TriCtx* c = (TriCtx*)arg;
+    size_t nb = c->nb, n, i, j, t;
+    float* a;
+    float* b;
+    for (; c0<c1; c0+=n){
+        n = MIN(TRSM_CHUNK, c1-c0);
+        b = c->B + c->k0*c->ldb + c0;
+        for (t=0; t<nb; t++){
+            //solves eliminate top-down for lower, multiplies go bottom-up so their inputs are still untouched
+            i = (c->solve == c->lower) ? t : nb-1-t;
+            a = c->blk + i*nb;
+            if (!c->solve && !c->unit) _triScal(n, a[i], b+i*c->ldb);
+            if (c->lower){
+                for (j=0; j<i; j++) _triAxpy(n, c->solve ? -a[j] : a[j], b+j*c->ldb, b+i*c->ldb);
+            }
+            else{
+                for (j=i+1; j<nb; j++) _triAxpy(n, c->solve ? -a[j] : a[j], b+j*c->ldb, b+i*c->ldb);
+            }
+            if (c->solve && !c->unit) _triScal(n, 1/a[i], b+i*c->ldb);
+        }
+    }
+}
+
+/** \brief rows [r0, r1) of B, columns k0..k0+nb-1, against a diagonal block (right side), private function
+ *
+ * \param arg: TriCtx*, r0, r1
+ * \return
+ *
+ */
+
+void _triRightRange(void* arg, size_t r0, size_t r1){
+    TriCtx* c = (TriCtx*)arg;
+    size_t nb = c->nb, r, j, k, t;
+    float* a;
+    float* x;
+    float s;
+    for (r=r0; r<r1; r++){
+        x = c->B + r*c->ldb + c->k0;
+        for (t=0; t<nb; t++){
+            //column j of X*op(A) depends on x[k] below the diagonal for lower, above it for upper
+            j = (c->solve != c->lower) ? t : nb-1-t;
+            a = c->blk + j*nb;
+            s = c->solve || c->unit ? x[j] : x[j]*a[j];
+            if (c->lower){
+                for (k=j+1; k<nb; k++) s += c->solve ? -x[k]*a[k] : x[k]*a[k];
+            }
+            else{
+                for (k=0; k<j; k++) s += c->solve ? -x[k]*a[k] : x[k]*a[k];
+            }
+            x[j] = c->solve && !c->unit ? s/a[j] : s;
+        }
+    }
+}
+
+/** \brief blocked TRSM/TRMM driver, private function
+ *
+ * \param solve: 1 for trsmEx, 0 for trmmEx
+ * \param side, uplo, transA, diag, m, n, alpha, A, lda, B, ldb: as in trsmEx
+ * \return
+ *
+ */
+
+void _triBlocked(int solve, int side, int uplo, int transA, int diag, size_t m, size_t n, float alpha,
+                 float* A, size_t lda, float* B, size_t ldb){
+    TriCtx c;
+    GemmEpilogue ep;
+    size_t na = side == SLACH_LEFT ? m : n;
+    size_t nb, b, k0, k1, i, j, other, bs = TRSM_BLOCK;
+    int forward;
+    if (m == 0 || n == 0) return;
+    if (A == NULL || B == NULL){
+        perr(solve ? "In trsmEx(), A or B is NULL!\n" : "In trmmEx(), A or B is NULL!\n");
+    }
+    if (ldb < n || lda < na){
+        perr(solve ? "In trsmEx(), leading dimension is too small!\n" : "In trmmEx(), leading dimension is too small!\n");
+    }
+    //a single right-hand side is a row vector times op(A)^T, whose kernel runs on contiguous dot products
+    if (side == SLACH_LEFT && n == 1 && ldb == 1){
+        _triBlocked(solve, SLACH_RIGHT, uplo, !transA, diag, 1, m, alpha, A, lda, B, m);
+        return;
+    }
+    if (alpha != 1){
+        for (i=0; i<m; i++){
+            if (alpha == 0) memset(B+i*ldb, 0, n*sizeof(float));
+            else _triScal(n, alpha, B+i*ldb);
+        }
+        if (alpha == 0) return;
+    }
+    c.solve = solve;
+    c.lower = (uplo == SLACH_LOWER) != (transA != 0);
+    c.unit = diag == SLACH_UNIT;
+    c.B = B; c.ldb = ldb;
+    c.blk = slach_malloc(float, bs*bs);
+    gemmEpilogueInit(&ep);
+    ep.alpha = solve ? -1 : 1;
+    ep.beta = 1;
+    //walk the diagonal blocks in the order in which their inputs are final (solve) or still untouched (multiply)
+    forward = (solve == (side == SLACH_LEFT)) ? c.lower : !c.lower;
+    other = side == SLACH_LEFT ? n : m;
+    for (b=0; b<na; b+=bs){
+        k0 = forward ? b : (na-1-b)/bs*bs;
+        k1 = MIN(na, k0+bs);
+        nb = k1-k0;
+        c.k0 = k0; c.nb = nb;
+        //the left kernel reads rows of op(A), the right kernel reads columns; only the triangle is copied
+        for (i=0; i<nb; i++){
+            for (j=(c.lower ? 0 : i); j<=(c.lower ? i : nb-1); j++){
+                float aij = transA ? A[(k0+j)*lda+k0+i] : A[(k0+i)*lda+k0+j];
+                if (side == SLACH_LEFT) c.blk[i*nb+j] = aij;
+                else c.blk[j*nb+i] = aij;
+            }
+        }
+        if (side == SLACH_LEFT){
+            if (nb*nb*other < TRSM_PAR_MIN) _triLeftRange(&c, 0, n);
+            else slach_parallel_for(n, TRSM_CHUNK/4, _triLeftRange, &c);
+        }
+        else{
+            if (nb*nb*other < TRSM_PAR_MIN) _triRightRange(&c, 0, m);
+            else slach_parallel_for(m, TRSM_ROW_GRAIN, _triRightRange, &c);
+        }
+        //off-diagonal part as one GEMM: solves push the block forward, multiplies pull the rest in
+        if (side == SLACH_LEFT){
+            if (solve && c.lower && k1 < m){
+                gemmEx(transA, 0, m-k1, n, nb, _triSub(A, lda, transA, k1, k0), lda,
+                       B+k0*ldb, ldb, B+k1*ldb, ldb, &ep);
+            }
+            else if (solve && !c.lower && k0 > 0){
+                gemmEx(transA, 0, k0, n, nb, _triSub(A, lda, transA, 0, k0), lda,
+                       B+k0*ldb, ldb, B, ldb, &ep);
+            }
+            else if (!solve && c.lower && k0 > 0){
+                gemmEx(transA, 0, nb, n, k0, _triSub(A, lda, transA, k0, 0), lda,
+                       B, ldb, B+k0*ldb, ldb, &ep);
+            }
+            else if (!solve && !c.lower && k1 < m){
+                gemmEx(transA, 0, nb, n, m-k1, _triSub(A, lda, transA, k0, k1), lda,
+                       B+k1*ldb, ldb, B+k0*ldb, ldb, &ep);
+            }
+        }
+        else{
+            if (solve && c.lower && k0 > 0){
+                gemmEx(0, transA, m, k0, nb, B+k0, ldb, _triSub(A, lda, transA, k0, 0), lda,
+                       B, ldb, &ep);
+            }
+            else if (solve && !c.lower && k1 < n){
+                gemmEx(0, transA, m, n-k1, nb, B+k0, ldb, _triSub(A, lda, transA, k0, k1), lda,
+                       B+k1, ldb, &ep);
+            }
+            else if (!solve && c.lower && k1 < n){
+                gemmEx(0, transA, m, nb, n-k1, B+k1, ldb, _triSub(A, lda, transA, k1, k0), lda,
+                       B+k0, ldb, &ep);
+            }
+            else if (!solve && !c.lower && k0 > 0){
+                gemmEx(0, transA, m, nb, k0, B, ldb, _triSub(A, lda, transA, 0, k0), lda,
+                       B+k0, ldb, &ep);
+            }
+        }
+    }
+    slach_free(c.blk);
+}
+
+/** \brief triangular solve: op(A)*X = alpha*B or X*op(A) = alpha*B, X overwrites B
+ *
+ * \param side: SLACH_LEFT or SLACH_RIGHT
+ * \param uplo: SLACH_UPPER or SLACH_LOWER, the triangle of A that is read
+ * \param transA: 1 means op(A) = A^T
+ * \param diag: SLACH_NON_UNIT or SLACH_UNIT
+ * \param m, n: B is m x n
+ * \param alpha
+ * \param A, lda: m x m for the left side, n x n for the right side
+ * \param B, ldb
+ * \return
+ *
+ */
+
+void trsmEx(int side, int uplo, int transA, int diag, size_t m, size_t n, float alpha,
+            IN float* A, size_t lda, INOUT float* B, size_t ldb){
+    _triBlocked(1, side, uplo, transA, diag, m, n, alpha, A, lda, B, ldb);
+}
+
+/** \brief triangular multiply: B = alpha*op(A)*B or B = alpha*B*op(A)
+ *
+ * \param side: SLACH_LEFT or SLACH_RIGHT
+ * \param uplo: SLACH_UPPER or SLACH_LOWER, the triangle of A that is read
+ * \param transA: 1 means op(A) = A^T
+ * \param diag: SLACH_NON_UNIT or SLACH_UNIT
+ * \param m, n: B is m x n
+ * \param alpha
+ * \param A, lda: m x m for the left side, n x n for the right side
+ * \param B, ldb
+ * \return
+ *
+ */
+
+void trmmEx(int side, int uplo, int transA, int diag, size_t m, size_t n, float alpha,
+            IN float* A, size_t lda, INOUT float* B, size_t ldb){
+    _triBlocked(0, side, uplo, transA, diag, m, n, alpha, A, lda, B, ldb);
+}
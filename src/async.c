@@ -0,0 +1,456 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/async.h"
+#include "../include/LUD.h"
+#include <stdatomic.h>
+#ifndef SLACH_NO_THREADS
+#include <pthread.h>
+#include <time.h>
+#define ASYNC_LOCK(t) pthread_mutex_lock(&(t)->lock)
+#define ASYNC_UNLOCK(t) pthread_mutex_unlock(&(t)->lock)
+#else
+#define ASYNC_LOCK(t)
+#define ASYNC_UNLOCK(t)
+#endif
+
+/*
+A task counts its unfinished dependencies plus one for its own submission; whoever drops the
+count to 0 hands it to _parallelSubmit. Completion closes the list of successors and
+callbacks under the task lock, runs the callbacks, releases the successors and only then
+marks the task done, so slach_wait also covers the callbacks. A task is referenced by its
+handle and by the runtime until it completes, and is freed by the last of the two.
+*/
+#define ASYNC_WAIT_NS 1000000 //a waiter with nothing to help with re-checks the pool this often
+
+/** \brief entry of the completion list of a task: a callback, or a dependent task
+ *
+ * \param fn, arg: callback (fn NULL for a dependent)
+ * \param succ: dependent task
+ * \return
+ *
+ */
+
+typedef struct _AsyncLink_{
+    slachTaskFn fn;
+    void* arg;
+    SlachTask* succ;
+    struct _AsyncLink_* next;
+}AsyncLink;
+
+/** \brief a submission
+ *
+ * \param fn, arg: work, arg is freed after fn when owned
+ * \param pending: unfinished dependencies, plus 1 until slach_submit has registered them all
+ * \param refs: the handle and the runtime
+ * \param closed: completion list taken, later links run at once
+ * \param done: task and callbacks finished
+ * \param links: callbacks and dependents
+ * \return
+ *
+ */
+
+struct _SlachTask_{
+    slachTaskFn fn;
+    void* arg;
+    int ownArg;
+#ifndef SLACH_NO_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+#endif
+    atomic_int pending;
+    atomic_int refs;
+    int closed;
+    atomic_int done;
+    AsyncLink* links;
+};
+
+/** \brief drop one reference, private function
+ *
+ * \param t
+ * \return
+ *
+ */
+
+void _asyncRelease(SlachTask* t){
+    if (atomic_fetch_sub(&t->refs, 1) == 1){
+#ifndef SLACH_NO_THREADS
+        pthread_mutex_destroy(&t->lock);
+        pthread_cond_destroy(&t->finished);
+#endif
+        slach_free(t);
+    }
+}
+
+/** \brief run a task and complete it, body of the pool task, private function
+ *
+ * \param arg: SlachTask*
+ * \return
+ *
+ */
+
+void _asyncRun(void* arg){
+    SlachTask* t = (SlachTask*)arg;
+    AsyncLink* l;
+    AsyncLink* next;
+    AsyncLink* rev;
+    t->fn(t->arg);
+    if (t->ownArg) slach_free(t->arg);
+    ASYNC_LOCK(t);
+    l = t->links;
+    t->links = NULL;
+    t->closed = 1;
+    ASYNC_UNLOCK(t);
+    //registration order, callbacks first: dependents may rely on them
+    for (rev=NULL; l != NULL; l = next){
+        next = l->next;
+        l->next = rev;
+        rev = l;
+    }
+    l = rev;
+    for (next=l; next != NULL; next = next->next){
+        if (next->succ == NULL) next->fn(next->arg);
+    }
+    for (; l != NULL; l = next){
+        next = l->next;
+        if (l->succ != NULL && atomic_fetch_sub(&l->succ->pending, 1) == 1) _parallelSubmit(_asyncRun, l->succ);
+        slach_free(l);
+    }
+    ASYNC_LOCK(t);
+    atomic_store(&t->done, 1);
+#ifndef SLACH_NO_THREADS
+    pthread_cond_broadcast(&t->finished);
+#endif
+    ASYNC_UNLOCK(t);
+    _asyncRelease(t);
+}
+
+/** \brief append a callback or a dependent to the completion list, private function
+ *
+ * \param t
+ * \param fn, arg, succ: the link
+ * \return int, 0 when t is already closed and the link was not added
+ *
+ */
+
+int _asyncLink(SlachTask* t, slachTaskFn fn, void* arg, SlachTask* succ){
+    AsyncLink* l;
+    int ok = 0;
+    ASYNC_LOCK(t);
+    if (!t->closed){
+        l = slach_malloc(AsyncLink, 1);
+        l->fn = fn; l->arg = arg; l->succ = succ;
+        l->next = t->links;
+        t->links = l;
+        ok = 1;
+    }
+    ASYNC_UNLOCK(t);
+    return ok;
+}
+
+/** \brief submit fn(arg) after deps, private function
+ *
+ * \param fn, arg
+ * \param ownArg: free arg once fn has run
+ * \param deps, nDeps
+ * \return SlachTask*
+ *
+ */
+
+SlachTask* _asyncSubmit(slachTaskFn fn, void* arg, int ownArg, SlachTask* const* deps, size_t nDeps){
+    SlachTask* t;
+    size_t i;
+    if (fn == NULL){
+        perr("In slach_submit(), fn is NULL!\n");
+    }
+    if (nDeps > 0 && deps == NULL){
+        perr("In slach_submit(), deps is NULL!\n");
+    }
+    t = slach_malloc(SlachTask, 1);
+    t->fn = fn; t->arg = arg; t->ownArg = ownArg;
+#ifndef SLACH_NO_THREADS
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->finished, NULL);
+#endif
+    atomic_init(&t->pending, (int)nDeps+1);
+    atomic_init(&t->refs, 2);
+    atomic_init(&t->done, 0);
+    for (i=0; i<nDeps; i++){
+        if (deps[i] == NULL){
+            perr("In slach_submit(), a dependency is NULL!\n");
+        }
+        if (!_asyncLink(deps[i], NULL, NULL, t)) atomic_fetch_sub(&t->pending, 1);
+    }
+    if (atomic_fetch_sub(&t->pending, 1) == 1) _parallelSubmit(_asyncRun, t);
+    return t;
+}
+
+/** \brief submit a task: fn(arg) runs once every task in deps has completed
+ *
+ * \param fn, arg
+ * \param deps: nDeps handles, may be NULL when nDeps is 0
+ * \param nDeps
+ * \return SlachTask*, release with slach_release
+ *
+ */
+
+SlachTask* slach_submit(slachTaskFn fn, void* arg, IN SlachTask* const* deps, size_t nDeps){
+    return _asyncSubmit(fn, arg, 0, deps, nDeps);
+}
+
+/** \brief arguments of an asynchronous LUsolvem
+ *
+ * \param as in LUsolvem
+ * \return
+ *
+ */
+
+typedef struct _AsyncLUsolvem_{
+    float* arr1;
+    size_t row1, col1;
+    float* arr2;
+    size_t row2, col2;
+    float* dest;
+    size_t height, width;
+}AsyncLUsolvem;
+
+/** \brief body of slach_submit_LUsolvem, private function
+ *
+ * \param arg: AsyncLUsolvem*
+ * \return
+ *
+ */
+
+void _asyncLUsolvem(void* arg){
+    AsyncLUsolvem* a = (AsyncLUsolvem*)arg;
+    LUsolvem(a->arr1, a->row1, a->col1, a->arr2, a->row2, a->col2, a->dest, a->height, a->width);
+}
+
+/** \brief submit LUsolvem: solve arr1*dest = arr2 after deps
+ *
+ * \param arr1, row1, col1, arr2, row2, col2, dest, height, width: as in LUsolvem
+ * \param deps, nDeps: as in slach_submit
+ * \return SlachTask*
+ *
+ */
+
+SlachTask* slach_submit_LUsolvem(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+                                 OUT float* dest, size_t height, size_t width,
+                                 IN SlachTask* const* deps, size_t nDeps){
+    AsyncLUsolvem* a = slach_malloc(AsyncLUsolvem, 1);
+    a->arr1 = arr1; a->row1 = row1; a->col1 = col1;
+    a->arr2 = arr2; a->row2 = row2; a->col2 = col2;
+    a->dest = dest; a->height = height; a->width = width;
+    return _asyncSubmit(_asyncLUsolvem, a, 1, deps, nDeps);
+}
+
+/** \brief arguments of an asynchronous FFT_CooleyTukey
+ *
+ * \param input, N, N1, N2: as in FFT_CooleyTukey
+ * \param output: receives the result
+ * \return
+ *
+ */
+
+typedef struct _AsyncFFT_{
+    complex* input;
+    int N, N1, N2;
+    complex** output;
+}AsyncFFT;
+
+/** \brief body of slach_submit_FFT_CooleyTukey, private function
+ *
+ * \param arg: AsyncFFT*
+ * \return
+ *
+ */
+
+void _asyncFFT(void* arg){
+    AsyncFFT* a = (AsyncFFT*)arg;
+    *a->output = FFT_CooleyTukey(a->input, a->N, a->N1, a->N2);
+}
+
+/** \brief submit FFT_CooleyTukey after deps
+ *
+ * \param input, N, N1, N2: as in FFT_CooleyTukey
+ * \param output: receives the transform when the task completes, free it with slach_free
+ * \param deps, nDeps: as in slach_submit
+ * \return SlachTask*
+ *
+ */
+
+SlachTask* slach_submit_FFT_CooleyTukey(IN complex* input, int N, int N1, int N2, OUT complex** output,
+                                        IN SlachTask* const* deps, size_t nDeps){
+    AsyncFFT* a;
+    if (output == NULL){
+        perr("In slach_submit_FFT_CooleyTukey(), output is NULL!\n");
+    }
+    a = slach_malloc(AsyncFFT, 1);
+    a->input = input; a->N = N; a->N1 = N1; a->N2 = N2; a->output = output;
+    return _asyncSubmit(_asyncFFT, a, 1, deps, nDeps);
+}
+
+/** \brief arguments of an asynchronous gemmEx
+ *
+ * \param as in gemmEx, ep is a copy (hasEp 0 for NULL)
+ * \return
+ *
+ */
+
+typedef struct _AsyncGemm_{
+    int transA, transB;
+    size_t m, n, k;
+    float* A;
+    size_t lda;
+    float* B;
+    size_t ldb;
+    float* C;
+    size_t ldc;
+    GemmEpilogue ep;
+    int hasEp;
+}AsyncGemm;
+
+/** \brief body of slach_submit_gemmEx, private function
+ *
+ * \param arg: AsyncGemm*
+ * \return
+ *
+ */
+
+void _asyncGemm(void* arg){
+    AsyncGemm* a = (AsyncGemm*)arg;
+    gemmEx(a->transA, a->transB, a->m, a->n, a->k, a->A, a->lda, a->B, a->ldb,
+           a->C, a->ldc, a->hasEp ? &a->ep : NULL);
+}
+
+/** \brief submit gemmEx after deps
+ *
+ * \param transA, transB, m, n, k, A, lda, B, ldb, C, ldc: as in gemmEx
+ * \param ep: epilogue, copied (NULL: plain product)
+ * \param deps, nDeps: as in slach_submit
+ * \return SlachTask*
+ *
+ */
+
+SlachTask* slach_submit_gemmEx(int transA, int transB, size_t m, size_t n, size_t k,
+                               IN float* A, size_t lda, IN float* B, size_t ldb,
+                               INOUT float* C, size_t ldc, IN GemmEpilogue* ep,
+                               IN SlachTask* const* deps, size_t nDeps){
+    AsyncGemm* a = slach_malloc(AsyncGemm, 1);
+    a->transA = transA; a->transB = transB;
+    a->m = m; a->n = n; a->k = k;
+    a->A = A; a->lda = lda; a->B = B; a->ldb = ldb; a->C = C; a->ldc = ldc;
+    a->hasEp = ep != NULL;
+    if (ep != NULL) a->ep = *ep;
+    return _asyncSubmit(_asyncGemm, a, 1, deps, nDeps);
+}
+
+/** \brief add a completion callback, run at once when the task is already complete
+ *
+ * \param t
+ * \param fn, arg: callback
+ * \return
+ *
+ */
+
+void slach_on_complete(SlachTask* t, slachTaskFn fn, void* arg){
+    if (t == NULL || fn == NULL){
+        perr("In slach_on_complete(), t or fn is NULL!\n");
+    }
+    if (!_asyncLink(t, fn, arg, NULL)) fn(arg);
+}
+
+/** \brief whether a task has completed
+ *
+ * \param t
+ * \return int, 1 when the task and its callbacks are done
+ *
+ */
+
+int slach_test(SlachTask* t){
+    if (t == NULL){
+        perr("In slach_test(), t is NULL!\n");
+    }
+    return atomic_load(&t->done);
+}
+
+/** \brief wait for a task and its callbacks, running pending pool work meanwhile
+ *
+ * \param t
+ * \return
+ *
+ */
+
+void slach_wait(SlachTask* t){
+#ifndef SLACH_NO_THREADS
+    struct timespec ts;
+#endif
+    if (t == NULL){
+        perr("In slach_wait(), t is NULL!\n");
+    }
+    while (!atomic_load(&t->done)){
+        if (_parallelHelp()) continue;
+#ifndef SLACH_NO_THREADS
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += ASYNC_WAIT_NS;
+        if (ts.tv_nsec >= 1000000000){
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        ASYNC_LOCK(t);
+        if (!atomic_load(&t->done)) pthread_cond_timedwait(&t->finished, &t->lock, &ts);
+        ASYNC_UNLOCK(t);
+#endif
+    }
+}
+
+/** \brief release a handle; the task still runs when it has not completed yet
+ *
+ * \param t
+ * \return
+ *
+ */
+
+void slach_release(SlachTask* t){
+    if (t == NULL){
+        perr("In slach_release(), t is NULL!\n");
+    }
+    _asyncRelease(t);
+}
@@ -449,8 +449,10 @@ Matrix* createMatrix(IN size_t mHeight, IN size_t mWidth){
 	else{
 		mPtr = slach_malloc (Matrix, 1);
 		mPtr->mData = slach_malloc(float*, mHeight);
-		for (i = 0; i<mHeight; i++){
-			mPtr->mData[i] = slach_malloc(float, mWidth);
+		//one contiguous row-major block, mData[i] points at row i, so mData[0] is a plain 2-dim array
+		mPtr->mData[0] = slach_malloc(float, mHeight*mWidth);
+		for (i = 1; i<mHeight; i++){
+			mPtr->mData[i] = mPtr->mData[0]+i*mWidth;
 		}
 		mPtr->mHeight = mHeight;
 		mPtr->mWidth = mWidth;
@@ -466,14 +468,11 @@ Matrix* createMatrix(IN size_t mHeight, IN size_t mWidth){
  */
 
 void destroyMatrix(INOUT Matrix* mPtr){
-	size_t i;
 	if (mPtr == NULL){
 		perr("ptr is NULL is free!\n");
 	}
 	else{
-		for (i = 0; i<mPtr->mHeight; i++){
-			slach_free(mPtr->mData[i]);
-		}
+		slach_free(mPtr->mData[0]);
 		slach_free(mPtr->mData);
 		slach_free(mPtr);
 	}
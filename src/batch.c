@@ -0,0 +1,454 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/batch.h"
+#include "../include/parallel.h"
+#include "simd.h"
+
+/*
+BATCH_L problems form a group and are interleaved across the lanes of one vector:
+element idx of problem (group*BATCH_L + l) lives at buf[idx*BATCH_L + l].
+BATCH_GRAIN groups make one chunk of work for the thread pool.
+*/
+#define BATCH_L SLACH_VLEN
+#define BATCH_GRAIN 64
+
+/** \brief a batch operand: either base + b*stride or ptrs[b]
+ *
+ * \param base, stride
+ * \param ptrs
+ * \return
+ *
+ */
+
+typedef struct _BatchOperand_{
+    float* base;
+    float** ptrs;
+    size_t stride;
+}BatchOperand;
+
+typedef struct _BatchGemmCtx_{
+    int transA, transB;
+    size_t m, n, k;
+    float alpha, beta;
+    BatchOperand A, B, C;
+    size_t lda, ldb, ldc;
+    size_t batch;
+}BatchGemmCtx;
+
+typedef struct _BatchLUCtx_{
+    size_t n, nrhs;
+    BatchOperand A, B;
+    int* info;
+    size_t batch;
+}BatchLUCtx;
+
+/** \brief address of problem b, private function
+ *
+ * \param BatchOperand*
+ * \param b
+ * \return float*
+ *
+ */
+
+float* _batchAt(BatchOperand* op, size_t b){
+    return op->ptrs != NULL ? op->ptrs[b] : op->base+b*op->stride;
+}
+
+/** \brief interleave op(X_b) (rows x cols) of one group into lane layout, private function
+ *
+ * \param X, b0: first problem of the group, nl: live lanes
+ * \param trans, rows, cols, ld
+ * \param buf: rows*cols*BATCH_L, dead lanes are zero
+ * \return
+ *
+ */
+
+void _batchPack(BatchOperand* X, size_t b0, size_t nl, int trans, size_t rows, size_t cols, size_t ld, float* buf){
+    size_t l,i,j;
+    float* x;
+    for (l=0; l<BATCH_L; l++){
+        if (l < nl){
+            x = _batchAt(X, b0+l);
+            for (i=0; i<rows; i++){
+                for (j=0; j<cols; j++){
+                    buf[(i*cols+j)*BATCH_L+l] = trans ? x[j*ld+i] : x[i*ld+j];
+                }
+            }
+        }
+        else{
+            for (i=0; i<rows*cols; i++){
+                buf[i*BATCH_L+l] = 0;
+            }
+        }
+    }
+}
+
+/** \brief scatter a lane-layout result back: Y_b = alpha*buf + beta*Y_b, private function
+ *
+ * \param Y, b0, nl, rows, cols, ld
+ * \param buf, alpha, beta
+ * \return
+ *
+ */
+
+void _batchUnpack(BatchOperand* Y, size_t b0, size_t nl, size_t rows, size_t cols, size_t ld,
+                  float* buf, float alpha, float beta){
+    size_t l,i,j;
+    float* y;
+    float v;
+    for (l=0; l<nl; l++){
+        y = _batchAt(Y, b0+l);
+        for (i=0; i<rows; i++){
+            for (j=0; j<cols; j++){
+                v = alpha*buf[(i*cols+j)*BATCH_L+l];
+                if (beta != 0){
+                    v += beta*y[i*ld+j];
+                }
+                y[i*ld+j] = v;
+            }
+        }
+    }
+}
+
+/** \brief lane-parallel product of one group: pc = pa (m x k) * pb (k x n), private function
+ *
+ * \param m, n, k
+ * \param pa, pb, pc: lane layout
+ * \return
+ *
+ */
+
+void _batchKernel(size_t m, size_t n, size_t k, float* pa, float* pb, float* pc){
+    size_t i,j,p;
+    vfloat acc;
+    for (i=0; i<m; i++){
+        for (j=0; j<n; j++){
+            acc = vfZero();
+            for (p=0; p<k; p++){
+                acc = vfFmadd(vfLoad(pa+(i*k+p)*BATCH_L), vfLoad(pb+(p*n+j)*BATCH_L), acc);
+            }
+            vfStore(pc+(i*n+j)*BATCH_L, acc);
+        }
+    }
+}
+
+/** \brief batched GEMM over groups [g0, g1), thread pool body, private function
+ *
+ * \param ctx: BatchGemmCtx*
+ * \param g0, g1
+ * \return
+ *
+ */
+
+void _batchGemmRange(void* arg, size_t g0, size_t g1){
+    BatchGemmCtx* c = (BatchGemmCtx*)arg;
+    float* pa = slach_malloc(float, (c->m*c->k+c->k*c->n+c->m*c->n)*BATCH_L);
+    float* pb = pa+c->m*c->k*BATCH_L;
+    float* pc = pb+c->k*c->n*BATCH_L;
+    size_t g, b0, nl;
+    for (g=g0; g<g1; g++){
+        b0 = g*BATCH_L;
+        nl = MIN(BATCH_L, c->batch-b0);
+        _batchPack(&c->A, b0, nl, c->transA, c->m, c->k, c->lda, pa);
+        _batchPack(&c->B, b0, nl, c->transB, c->k, c->n, c->ldb, pb);
+        _batchKernel(c->m, c->n, c->k, pa, pb, pc);
+        _batchUnpack(&c->C, b0, nl, c->m, c->n, c->ldc, pc, c->alpha, c->beta);
+    }
+    slach_free(pa);
+}
+
+/** \brief check shapes and run a batched GEMM, private function
+ *
+ * \param BatchGemmCtx*
+ * \return
+ *
+ */
+
+void _batchGemm(BatchGemmCtx* c){
+    if (c->m == 0 || c->n == 0 || c->k == 0){
+        perr("In gemmBatch, m, n or k is 0!\n");
+    }
+    if (c->ldc < c->n || c->lda < (c->transA ? c->m : c->k) || c->ldb < (c->transB ? c->k : c->n)){
+        perr("In gemmBatch, leading dimension is too small!\n");
+    }
+    slach_parallel_for((c->batch+BATCH_L-1)/BATCH_L, BATCH_GRAIN, _batchGemmRange, c);
+}
+
+/** \brief strided batched GEMM: C_b = alpha*op(A_b)*op(B_b) + beta*C_b
+ *
+ * \param transA, transB, m, n, k, alpha
+ * \param A, lda, strideA; B, ldb, strideB
+ * \param beta, C, ldc, strideC
+ * \param batch: number of problems
+ * \return
+ *
+ */
+
+void gemmBatchStrided(int transA, int transB, size_t m, size_t n, size_t k, float alpha,
+                      IN float* A, size_t lda, size_t strideA, IN float* B, size_t ldb, size_t strideB,
+                      float beta, INOUT float* C, size_t ldc, size_t strideC, size_t batch){
+    BatchGemmCtx c;
+    c.transA = transA; c.transB = transB;
+    c.m = m; c.n = n; c.k = k;
+    c.alpha = alpha; c.beta = beta;
+    c.A.base = A; c.A.ptrs = NULL; c.A.stride = strideA;
+    c.B.base = B; c.B.ptrs = NULL; c.B.stride = strideB;
+    c.C.base = C; c.C.ptrs = NULL; c.C.stride = strideC;
+    c.lda = lda; c.ldb = ldb; c.ldc = ldc;
+    c.batch = batch;
+    _batchGemm(&c);
+}
+
+/** \brief pointer-array batched GEMM: C[b] = alpha*op(A[b])*op(B[b]) + beta*C[b]
+ *
+ * \param transA, transB, m, n, k, alpha
+ * \param A, lda; B, ldb
+ * \param beta, C, ldc
+ * \param batch: number of problems
+ * \return
+ *
+ */
+
+void gemmBatchPtr(int transA, int transB, size_t m, size_t n, size_t k, float alpha,
+                  IN float** A, size_t lda, IN float** B, size_t ldb,
+                  float beta, INOUT float** C, size_t ldc, size_t batch){
+    BatchGemmCtx c;
+    c.transA = transA; c.transB = transB;
+    c.m = m; c.n = n; c.k = k;
+    c.alpha = alpha; c.beta = beta;
+    c.A.base = NULL; c.A.ptrs = A; c.A.stride = 0;
+    c.B.base = NULL; c.B.ptrs = B; c.B.stride = 0;
+    c.C.base = NULL; c.C.ptrs = C; c.C.stride = 0;
+    c.lda = lda; c.ldb = ldb; c.ldc = ldc;
+    c.batch = batch;
+    _batchGemm(&c);
+}
+
+/** \brief strided batched GEMV: y_b = alpha*op(A_b)*x_b + beta*y_b
+ *
+ * \param trans, m, n: A_b is m x n
+ * \param alpha, A, lda, strideA
+ * \param x, strideX, beta, y, strideY
+ * \param batch: number of problems
+ * \return
+ *
+ */
+
+void gemvBatchStrided(int trans, size_t m, size_t n, float alpha, IN float* A, size_t lda, size_t strideA,
+                      IN float* x, size_t strideX, float beta, INOUT float* y, size_t strideY, size_t batch){
+    BatchGemmCtx c;
+    //a GEMV is a GEMM with a single column: x_b is (op cols) x 1, y_b is (op rows) x 1
+    c.transA = trans; c.transB = 0;
+    c.m = trans ? n : m; c.n = 1; c.k = trans ? m : n;
+    c.alpha = alpha; c.beta = beta;
+    c.A.base = A; c.A.ptrs = NULL; c.A.stride = strideA;
+    c.B.base = x; c.B.ptrs = NULL; c.B.stride = strideX;
+    c.C.base = y; c.C.ptrs = NULL; c.C.stride = strideY;
+    c.lda = lda; c.ldb = 1; c.ldc = 1;
+    c.batch = batch;
+    _batchGemm(&c);
+}
+
+/** \brief pointer-array batched GEMV: y[b] = alpha*op(A[b])*x[b] + beta*y[b]
+ *
+ * \param trans, m, n: A[b] is m x n
+ * \param alpha, A, lda, x, beta, y
+ * \param batch: number of problems
+ * \return
+ *
+ */
+
+void gemvBatchPtr(int trans, size_t m, size_t n, float alpha, IN float** A, size_t lda,
+                  IN float** x, float beta, INOUT float** y, size_t batch){
+    BatchGemmCtx c;
+    c.transA = trans; c.transB = 0;
+    c.m = trans ? n : m; c.n = 1; c.k = trans ? m : n;
+    c.alpha = alpha; c.beta = beta;
+    c.A.base = NULL; c.A.ptrs = A; c.A.stride = 0;
+    c.B.base = NULL; c.B.ptrs = x; c.B.stride = 0;
+    c.C.base = NULL; c.C.ptrs = y; c.C.stride = 0;
+    c.lda = lda; c.ldb = 1; c.ldc = 1;
+    c.batch = batch;
+    _batchGemm(&c);
+}
+
+/** \brief swap rows r1 and r2 of one lane in a lane-layout matrix, private function
+ *
+ * \param buf, cols, lane, r1, r2
+ * \return
+ *
+ */
+
+void _batchSwapRows(float* buf, size_t cols, size_t lane, size_t r1, size_t r2){
+    size_t j;
+    for (j=0; j<cols; j++){
+        swap(&buf[(r1*cols+j)*BATCH_L+lane], &buf[(r2*cols+j)*BATCH_L+lane]);
+    }
+}
+
+/** \brief batched LU solve over groups [g0, g1), thread pool body, private function
+ *
+ * \param ctx: BatchLUCtx*
+ * \param g0, g1
+ * \return
+ *
+ */
+
+void _batchLURange(void* arg, size_t g0, size_t g1){
+    BatchLUCtx* c = (BatchLUCtx*)arg;
+    size_t n = c->n, nrhs = c->nrhs;
+    float* pa = slach_malloc(float, (n*n+n*nrhs)*BATCH_L);
+    float* pb = pa+n*n*BATCH_L;
+    int info[BATCH_L];
+    size_t g, b0, nl, l, i, j, k, p;
+    float best, v;
+    vfloat rcp, lik, x;
+    for (g=g0; g<g1; g++){
+        b0 = g*BATCH_L;
+        nl = MIN(BATCH_L, c->batch-b0);
+        _batchPack(&c->A, b0, nl, 0, n, n, n, pa);
+        _batchPack(&c->B, b0, nl, 0, n, nrhs, nrhs, pb);
+        //dead lanes solve the identity so they never divide by zero
+        for (l=nl; l<BATCH_L; l++){
+            for (i=0; i<n; i++) pa[(i*n+i)*BATCH_L+l] = 1;
+        }
+        for (l=0; l<BATCH_L; l++) info[l] = 0;
+
+        for (k=0; k<n; k++){
+            //partial pivoting is per problem, so the row swaps are done lane by lane
+            for (l=0; l<BATCH_L; l++){
+                p = k;
+                best = (float)fabs((double)pa[(k*n+k)*BATCH_L+l]);
+                for (i=k+1; i<n; i++){
+                    v = (float)fabs((double)pa[(i*n+k)*BATCH_L+l]);
+                    if (v > best){
+                        best = v;
+                        p = i;
+                    }
+                }
+                if (best == 0 && info[l] == 0){
+                    info[l] = (int)k+1;
+                }
+                if (p != k){
+                    _batchSwapRows(pa, n, l, k, p);
+                    _batchSwapRows(pb, nrhs, l, k, p);
+                }
+            }
+            rcp = vfDiv(vfSet1(1), vfLoad(pa+(k*n+k)*BATCH_L));
+            for (i=k+1; i<n; i++){
+                lik = vfMul(vfLoad(pa+(i*n+k)*BATCH_L), rcp);
+                vfStore(pa+(i*n+k)*BATCH_L, lik);
+                for (j=k+1; j<n; j++){
+                    vfStore(pa+(i*n+j)*BATCH_L,
+                            vfSub(vfLoad(pa+(i*n+j)*BATCH_L), vfMul(lik, vfLoad(pa+(k*n+j)*BATCH_L))));
+                }
+                for (j=0; j<nrhs; j++){
+                    vfStore(pb+(i*nrhs+j)*BATCH_L,
+                            vfSub(vfLoad(pb+(i*nrhs+j)*BATCH_L), vfMul(lik, vfLoad(pb+(k*nrhs+j)*BATCH_L))));
+                }
+            }
+        }
+        for (k=n; k-->0;){
+            rcp = vfDiv(vfSet1(1), vfLoad(pa+(k*n+k)*BATCH_L));
+            for (j=0; j<nrhs; j++){
+                x = vfMul(vfLoad(pb+(k*nrhs+j)*BATCH_L), rcp);
+                vfStore(pb+(k*nrhs+j)*BATCH_L, x);
+                for (i=0; i<k; i++){
+                    vfStore(pb+(i*nrhs+j)*BATCH_L,
+                            vfSub(vfLoad(pb+(i*nrhs+j)*BATCH_L), vfMul(vfLoad(pa+(i*n+k)*BATCH_L), x)));
+                }
+            }
+        }
+        _batchUnpack(&c->A, b0, nl, n, n, n, pa, 1, 0);
+        _batchUnpack(&c->B, b0, nl, n, nrhs, nrhs, pb, 1, 0);
+        if (c->info != NULL){
+            for (l=0; l<nl; l++) c->info[b0+l] = info[l];
+        }
+    }
+    slach_free(pa);
+}
+
+/** \brief strided batched LU solve: A_b X_b = B_b
+ *
+ * \param n, nrhs
+ * \param A, strideA: overwritten by the LU factors
+ * \param B, strideB: overwritten by X
+ * \param info: per problem status, may be NULL
+ * \param batch: number of problems
+ * \return
+ *
+ */
+
+void LUsolveBatchStrided(size_t n, size_t nrhs, INOUT float* A, size_t strideA,
+                         INOUT float* B, size_t strideB, OUT int* info, size_t batch){
+    BatchLUCtx c;
+    if (n == 0 || nrhs == 0){
+        perr("In LUsolveBatch, n or nrhs is 0!\n");
+    }
+    c.n = n; c.nrhs = nrhs;
+    c.A.base = A; c.A.ptrs = NULL; c.A.stride = strideA;
+    c.B.base = B; c.B.ptrs = NULL; c.B.stride = strideB;
+    c.info = info; c.batch = batch;
+    slach_parallel_for((batch+BATCH_L-1)/BATCH_L, BATCH_GRAIN, _batchLURange, &c);
+}
+
+/** \brief pointer-array batched LU solve: A[b] X[b] = B[b]
+ *
+ * \param n, nrhs
+ * \param A: overwritten by the LU factors
+ * \param B: overwritten by X
+ * \param info: per problem status, may be NULL
+ * \param batch: number of problems
+ * \return
+ *
+ */
+
+void LUsolveBatchPtr(size_t n, size_t nrhs, INOUT float** A, INOUT float** B, OUT int* info, size_t batch){
+    BatchLUCtx c;
+    if (n == 0 || nrhs == 0){
+        perr("In LUsolveBatch, n or nrhs is 0!\n");
+    }
+    c.n = n; c.nrhs = nrhs;
+    c.A.base = NULL; c.A.ptrs = A; c.A.stride = 0;
+    c.B.base = NULL; c.B.ptrs = B; c.B.stride = 0;
+    c.info = info; c.batch = batch;
+    slach_parallel_for((batch+BATCH_L-1)/BATCH_L, BATCH_GRAIN, _batchLURange, &c);
+}
@@ -0,0 +1,621 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/blas.h"
+#include "../include/GEMM.h"
+#include "../include/GEMV.h"
+#include "../include/reduce.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+#include "simd.h"
+
+//rank-1 updates touching at least this many elements are split over the thread pool
+#define BLAS_PAR_MIN (slach_tune()->parMin) //tunable, see tune.h
+
+/** \brief address of element 0 of a BLAS vector, private function
+ *
+ * \param x, n, inc: a negative increment starts from the far end
+ * \return float*
+ *
+ */
+
+float* _blasBase(float* x, size_t n, int inc){
+    if (inc < 0 && n > 0){
+        return x + (n-1)*(size_t)(-inc);
+    }
+    return x;
+}
+
+/** \brief copy a strided vector into a contiguous buffer, private function
+ *
+ * \param n, x, inc, dest
+ * \return
+ *
+ */
+
+void _blasGather(size_t n, float* x, int inc, float* dest){
+    float* p = _blasBase(x, n, inc);
+    size_t i;
+    for (i=0; i<n; i++){
+        dest[i] = *p;
+        p += inc;
+    }
+}
+
+/** \brief copy a contiguous buffer into a strided vector, private function
+ *
+ * \param n, src, x, inc
+ * \return
+ *
+ */
+
+void _blasScatter(size_t n, float* src, float* x, int inc){
+    float* p = _blasBase(x, n, inc);
+    size_t i;
+    for (i=0; i<n; i++){
+        *p = src[i];
+        p += inc;
+    }
+}
+
+/** \brief contiguous y += alpha*x, private function
+ *
+ * \param n, alpha, x, y
+ * \return
+ *
+ */
+
+void _blasAxpy(size_t n, float alpha, float* x, float* y){
+    vfloat a = vfSet1(alpha);
+    size_t i;
+    for (i=0; i+2*SLACH_VLEN<=n; i+=2*SLACH_VLEN){
+        vfStore(y+i, vfFmadd(a, vfLoad(x+i), vfLoad(y+i)));
+        vfStore(y+i+SLACH_VLEN, vfFmadd(a, vfLoad(x+i+SLACH_VLEN), vfLoad(y+i+SLACH_VLEN)));
+    }
+    for (; i<n; i++){
+        y[i] += alpha*x[i];
+    }
+}
+
+/** \brief y = alpha*x + y
+ *
+ * \param n, alpha
+ * \param x, incx
+ * \param y, incy
+ * \return
+ *
+ */
+
+void slach_saxpy(size_t n, float alpha, IN float* x, int incx, INOUT float* y, int incy){
+    float* px; float* py;
+    size_t i;
+    if (n == 0 || alpha == 0) return;
+    if (incx == 1 && incy == 1){
+        _blasAxpy(n, alpha, x, y);
+        return;
+    }
+    px = _blasBase(x, n, incx);
+    py = _blasBase(y, n, incy);
+    for (i=0; i<n; i++){
+        *py += alpha*(*px);
+        px += incx; py += incy;
+    }
+}
+
+/** \brief x = alpha*x
+ *
+ * \param n, alpha
+ * \param x, incx
+ * \return
+ *
+ */
+
+void slach_sscal(size_t n, float alpha, INOUT float* x, int incx){
+    vfloat a = vfSet1(alpha);
+    float* p;
+    size_t i;
+    if (incx == 1){
+        for (i=0; i+SLACH_VLEN<=n; i+=SLACH_VLEN){
+            vfStore(x+i, vfMul(a, vfLoad(x+i)));
+        }
+        for (; i<n; i++){
+            x[i] *= alpha;
+        }
+        return;
+    }
+    p = _blasBase(x, n, incx);
+    for (i=0; i<n; i++){
+        *p *= alpha;
+        p += incx;
+    }
+}
+
+/** \brief x^T*y
+ *
+ * \param n
+ * \param x, incx
+ * \param y, incy
+ * \return float
+ *
+ */
+
+float slach_sdot(size_t n, IN float* x, int incx, IN float* y, int incy){
+    float* px; float* py;
+    double sum = 0;
+    size_t i;
+    if (incx == 1 && incy == 1){
+        return dotEx(x, y, n, SUM_PAIRWISE);
+    }
+    px = _blasBase(x, n, incx);
+    py = _blasBase(y, n, incy);
+    for (i=0; i<n; i++){
+        sum += (double)(*px)*(*py);
+        px += incx; py += incy;
+    }
+    return (float)sum;
+}
+
+/** \brief Euclidean norm of x
+ *
+ * \param n
+ * \param x, incx
+ * \return float
+ *
+ */
+
+float slach_snrm2(size_t n, IN float* x, int incx){
+    float* buf;
+    float r;
+    if (incx == 1){
+        return nrm2Ex(x, n, SUM_PAIRWISE);
+    }
+    if (n == 0) return 0;
+    //the norm does not depend on the order, so a negative increment needs no reversal
+    buf = slach_malloc(float, n);
+    _blasGather(n, x, incx, buf);
+    r = nrm2Ex(buf, n, SUM_PAIRWISE);
+    slach_free(buf);
+    return r;
+}
+
+/** \brief y = alpha*op(A)*x + beta*y, A is m x n
+ *
+ * \param trans: SLACH_NO_TRANS or SLACH_TRANS
+ * \param m, n, alpha, A, lda
+ * \param x, incx: n elements (m when trans)
+ * \param beta, y, incy: m elements (n when trans)
+ * \return
+ *
+ */
+
+void slach_sgemv(int trans, size_t m, size_t n, float alpha, IN float* A, size_t lda,
+                 IN float* x, int incx, float beta, INOUT float* y, int incy){
+    size_t lenx = trans ? m : n;
+    size_t leny = trans ? n : m;
+    float* bx = x;
+    float* by = y;
+    if (incx == 0 || incy == 0){
+        perr("In slach_sgemv(), increment is 0!\n");
+    }
+    if (lda < MAX(n, 1)){
+        perr("In slach_sgemv(), leading dimension is too small!\n");
+    }
+    if (leny == 0) return;
+    if (incx != 1){
+        bx = slach_malloc(float, lenx);
+        _blasGather(lenx, x, incx, bx);
+    }
+    if (incy != 1){
+        by = slach_malloc(float, leny);
+        if (beta != 0){
+            _blasGather(leny, y, incy, by);
+        }
+    }
+    gemvEx(trans, m, n, alpha, A, lda, bx, beta, by);
+    if (by != y){
+        _blasScatter(leny, by, y, incy);
+        slach_free(by);
+    }
+    if (bx != x){
+        slach_free(bx);
+    }
+}
+
+/** \brief arguments of a rank-1 update job
+ *
+ * \param n, alpha, x, y, A, lda: A[i] += alpha*x[i]*y over columns [lo(i), hi(i))
+ * \param uplo: -1 for the full row (ger), SLACH_UPPER/SLACH_LOWER for syr
+ * \return
+ *
+ */
+
+typedef struct _BlasR1Ctx_{
+    size_t n;
+    float alpha;
+    float* x;
+    float* y;
+    float* A;
+    size_t lda;
+    int uplo;
+}BlasR1Ctx;
+
+/** \brief rank-1 update of rows [r0, r1), thread pool body, private function
+ *
+ * \param ctx: BlasR1Ctx*
+ * \param r0, r1
+ * \return
+ *
+ */
+
+void _blasR1Range(void* arg, size_t r0, size_t r1){
+    BlasR1Ctx* c = (BlasR1Ctx*)arg;
+    size_t i, lo, hi;
+    for (i=r0; i<r1; i++){
+        lo = 0; hi = c->n;
+        if (c->uplo == SLACH_UPPER) lo = i;
+        if (c->uplo == SLACH_LOWER) hi = i+1;
+        if (c->x[i] != 0){
+            _blasAxpy(hi-lo, c->alpha*c->x[i], c->y+lo, c->A+i*c->lda+lo);
+        }
+    }
+}
+
+/** \brief run a rank-1 update over all rows, private function
+ *
+ * \param c: BlasR1Ctx*, m: rows
+ * \return
+ *
+ */
+
+void _blasR1(BlasR1Ctx* c, size_t m){
+    size_t grain = MAX(1, BLAS_PAR_MIN/MAX(c->n, 1));
+    if (m*c->n < BLAS_PAR_MIN){
+        _blasR1Range(c, 0, m);
+    }
+    else{
+        slach_parallel_for(m, grain, _blasR1Range, c);
+    }
+}
+
+/** \brief A = alpha*x*y^T + A, A is m x n
+ *
+ * \param m, n, alpha
+ * \param x, incx: m elements
+ * \param y, incy: n elements
+ * \param A, lda
+ * \return
+ *
+ */
+
+void slach_sger(size_t m, size_t n, float alpha, IN float* x, int incx, IN float* y, int incy,
+                INOUT float* A, size_t lda){
+    BlasR1Ctx c;
+    if (incx == 0 || incy == 0){
+        perr("In slach_sger(), increment is 0!\n");
+    }
+    if (lda < MAX(n, 1)){
+        perr("In slach_sger(), leading dimension is too small!\n");
+    }
+    if (m == 0 || n == 0 || alpha == 0) return;
+    c.n = n; c.alpha = alpha; c.A = A; c.lda = lda; c.uplo = -1;
+    c.x = x; c.y = y;
+    if (incx != 1){
+        c.x = slach_malloc(float, m);
+        _blasGather(m, x, incx, c.x);
+    }
+    if (incy != 1){
+        c.y = slach_malloc(float, n);
+        _blasGather(n, y, incy, c.y);
+    }
+    _blasR1(&c, m);
+    if (c.x != x) slach_free(c.x);
+    if (c.y != y) slach_free(c.y);
+}
+
+/** \brief A = alpha*x*x^T + A on one triangle of the symmetric n x n matrix A
+ *
+ * \param uplo: SLACH_UPPER or SLACH_LOWER
+ * \param n, alpha
+ * \param x, incx
+ * \param A, lda
+ * \return
+ *
+ */
+
+void slach_ssyr(int uplo, size_t n, float alpha, IN float* x, int incx, INOUT float* A, size_t lda){
+    BlasR1Ctx c;
+    if (uplo != SLACH_UPPER && uplo != SLACH_LOWER){
+        perr("In slach_ssyr(), uplo is illegal!\n");
+    }
+    if (incx == 0){
+        perr("In slach_ssyr(), increment is 0!\n");
+    }
+    if (lda < MAX(n, 1)){
+        perr("In slach_ssyr(), leading dimension is too small!\n");
+    }
+    if (n == 0 || alpha == 0) return;
+    c.n = n; c.alpha = alpha; c.A = A; c.lda = lda; c.uplo = uplo;
+    c.x = x;
+    if (incx != 1){
+        c.x = slach_malloc(float, n);
+        _blasGather(n, x, incx, c.x);
+    }
+    c.y = c.x;
+    _blasR1(&c, n);
+    if (c.x != x) slach_free(c.x);
+}
+
+/** \brief C = alpha*op(A)*op(B) + beta*C on the blocked GEMM engine
+ *
+ * \param transA, transB: SLACH_NO_TRANS or SLACH_TRANS
+ * \param m, n, k, alpha
+ * \param A, lda: op(A) is m x k
+ * \param B, ldb: op(B) is k x n
+ * \param beta, C, ldc
+ * \return
+ *
+ */
+
+void slach_sgemm(int transA, int transB, size_t m, size_t n, size_t k, float alpha,
+                 IN float* A, size_t lda, IN float* B, size_t ldb, float beta, INOUT float* C, size_t ldc){
+    GemmEpilogue ep;
+    gemmEpilogueInit(&ep);
+    ep.alpha = alpha;
+    ep.beta = beta;
+    //alpha == 0 only scales C, the engine does that for an empty k
+    gemmEx(transA, transB, m, n, alpha == 0 ? 0 : k, A, lda, B, ldb, C, ldc, &ep);
+}
+
+/** \brief symmetric rank-k update on the SYRK kernel: C = alpha*op(A)*op(A)^T + beta*C
+ *
+ * \param uplo: SLACH_UPPER or SLACH_LOWER, the triangle of C that is referenced
+ * \param trans: SLACH_NO_TRANS (A is n x k) or SLACH_TRANS (A is k x n)
+ * \param n, k, alpha, A, lda, beta, C, ldc
+ * \return
+ *
+ */
+
+void slach_ssyrk(int uplo, int trans, size_t n, size_t k, float alpha, IN float* A, size_t lda,
+                 float beta, INOUT float* C, size_t ldc){
+    syrkEx(uplo, trans, n, k, alpha, A, lda, beta, C, ldc, 0);
+}
+
+/** \brief triangular solve with many right-hand sides on the blocked TRSM kernel
+ *
+ * \param side, uplo, transA, diag: flags of trsmEx
+ * \param m, n, alpha
+ * \param A, lda: triangular, m x m (left) or n x n (right)
+ * \param B, ldb: m x n, overwritten by X
+ * \return
+ *
+ */
+
+void slach_strsm(int side, int uplo, int transA, int diag, size_t m, size_t n, float alpha,
+                 IN float* A, size_t lda, INOUT float* B, size_t ldb){
+    trsmEx(side, uplo, transA, diag, m, n, alpha, A, lda, B, ldb);
+}
+
+/** \brief triangular multiply on the blocked TRMM kernel
+ *
+ * \param side, uplo, transA, diag: flags of trmmEx
+ * \param m, n, alpha
+ * \param A, lda: triangular, m x m (left) or n x n (right)
+ * \param B, ldb: m x n, overwritten by the product
+ * \return
+ *
+ */
+
+void slach_strmm(int side, int uplo, int transA, int diag, size_t m, size_t n, float alpha,
+                 IN float* A, size_t lda, INOUT float* B, size_t ldb){
+    trmmEx(side, uplo, transA, diag, m, n, alpha, A, lda, B, ldb);
+}
+
+#ifdef SLACH_BLAS_COMPAT
+/*
+Fortran reference BLAS entry points. A column-major m x n matrix with leading dimension
+ld is a row-major n x m matrix with the same ld, i.e. its transpose, so every routine is
+the row-major one applied to swapped operands.
+*/
+
+/** \brief whether a Fortran option character asks for a transpose, private function
+ *
+ * \param c: 'N', 'T' or 'C'
+ * \return 0/1
+ *
+ */
+
+int _blasIsTrans(char* c){
+    switch (*c){
+        case 'N': case 'n': return 0;
+        case 'T': case 't': case 'C': case 'c': return 1;
+        default:
+            perr("In BLAS, trans is illegal!\n");
+            return 0;
+    }
+}
+
+/** \brief Fortran SAXPY: y = alpha*x + y
+ *
+ * \param n, alpha, x, incx, y, incy
+ * \return
+ *
+ */
+
+void saxpy_(int* n, float* alpha, float* x, int* incx, float* y, int* incy){
+    if (*n > 0) slach_saxpy((size_t)*n, *alpha, x, *incx, y, *incy);
+}
+
+/** \brief Fortran SSCAL: x = alpha*x
+ *
+ * \param n, alpha, x, incx
+ * \return
+ *
+ */
+
+void sscal_(int* n, float* alpha, float* x, int* incx){
+    if (*n > 0 && *incx > 0) slach_sscal((size_t)*n, *alpha, x, *incx);
+}
+
+/** \brief Fortran SDOT (gfortran calling convention: REAL result returned as float)
+ *
+ * \param n, x, incx, y, incy
+ * \return float
+ *
+ */
+
+float sdot_(int* n, float* x, int* incx, float* y, int* incy){
+    return *n > 0 ? slach_sdot((size_t)*n, x, *incx, y, *incy) : 0;
+}
+
+/** \brief Fortran SNRM2
+ *
+ * \param n, x, incx
+ * \return float
+ *
+ */
+
+float snrm2_(int* n, float* x, int* incx){
+    return (*n > 0 && *incx > 0) ? slach_snrm2((size_t)*n, x, *incx) : 0;
+}
+
+/** \brief Fortran SGEMV on a column-major m x n matrix
+ *
+ * \param trans, m, n, alpha, A, lda, x, incx, beta, y, incy
+ * \return
+ *
+ */
+
+void sgemv_(char* trans, int* m, int* n, float* alpha, float* A, int* lda,
+            float* x, int* incx, float* beta, float* y, int* incy){
+    if (*m <= 0 || *n <= 0) return;
+    slach_sgemv(!_blasIsTrans(trans), (size_t)*n, (size_t)*m, *alpha, A, (size_t)*lda,
+                x, *incx, *beta, y, *incy);
+}
+
+/** \brief Fortran SGER on a column-major m x n matrix
+ *
+ * \param m, n, alpha, x, incx, y, incy, A, lda
+ * \return
+ *
+ */
+
+void sger_(int* m, int* n, float* alpha, float* x, int* incx, float* y, int* incy, float* A, int* lda){
+    if (*m <= 0 || *n <= 0) return;
+    slach_sger((size_t)*n, (size_t)*m, *alpha, y, *incy, x, *incx, A, (size_t)*lda);
+}
+
+/** \brief Fortran SSYR on a column-major n x n matrix
+ *
+ * \param uplo, n, alpha, x, incx, A, lda
+ * \return
+ *
+ */
+
+void ssyr_(char* uplo, int* n, float* alpha, float* x, int* incx, float* A, int* lda){
+    int u;
+    if (*n <= 0) return;
+    //the upper triangle in column-major is the lower one in row-major
+    u = (*uplo == 'U' || *uplo == 'u') ? SLACH_LOWER : SLACH_UPPER;
+    slach_ssyr(u, (size_t)*n, *alpha, x, *incx, A, (size_t)*lda);
+}
+
+/** \brief Fortran SGEMM on column-major matrices
+ *
+ * \param transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc
+ * \return
+ *
+ */
+
+void sgemm_(char* transA, char* transB, int* m, int* n, int* k, float* alpha, float* A, int* lda,
+            float* B, int* ldb, float* beta, float* C, int* ldc){
+    if (*m <= 0 || *n <= 0) return;
+    //C^T = op(B)^T * op(A)^T in row-major terms
+    slach_sgemm(_blasIsTrans(transB), _blasIsTrans(transA), (size_t)*n, (size_t)*m, (size_t)MAX(*k, 0),
+                *alpha, B, (size_t)*ldb, A, (size_t)*lda, *beta, C, (size_t)*ldc);
+}
+
+/** \brief Fortran SSYRK on column-major matrices
+ *
+ * \param uplo, trans, n, k, alpha, A, lda, beta, C, ldc
+ * \return
+ *
+ */
+
+void ssyrk_(char* uplo, char* trans, int* n, int* k, float* alpha, float* A, int* lda,
+            float* beta, float* C, int* ldc){
+    if (*n <= 0) return;
+    //A (n x k, column-major) is A^T in row-major terms, so op flips along with the triangle
+    slach_ssyrk((*uplo == 'U' || *uplo == 'u') ? SLACH_LOWER : SLACH_UPPER, !_blasIsTrans(trans),
+                (size_t)*n, (size_t)MAX(*k, 0), *alpha, A, (size_t)*lda, *beta, C, (size_t)*ldc);
+}
+
+/** \brief Fortran STRSM on column-major matrices
+ *
+ * \param side, uplo, transA, diag, m, n, alpha, A, lda, B, ldb
+ * \return
+ *
+ */
+
+void strsm_(char* side, char* uplo, char* transA, char* diag, int* m, int* n, float* alpha,
+            float* A, int* lda, float* B, int* ldb){
+    if (*m <= 0 || *n <= 0) return;
+    //op(A)*X = B is X^T*op(A)^T = B^T: the side and the triangle flip, op stays
+    slach_strsm((*side == 'L' || *side == 'l') ? SLACH_RIGHT : SLACH_LEFT,
+                (*uplo == 'U' || *uplo == 'u') ? SLACH_LOWER : SLACH_UPPER, _blasIsTrans(transA),
+                (*diag == 'U' || *diag == 'u') ? SLACH_UNIT : SLACH_NON_UNIT,
+                (size_t)*n, (size_t)*m, *alpha, A, (size_t)*lda, B, (size_t)*ldb);
+}
+
+/** \brief Fortran STRMM on column-major matrices
+ *
+ * \param side, uplo, transA, diag, m, n, alpha, A, lda, B, ldb
+ * \return
+ *
+ */
+
+void strmm_(char* side, char* uplo, char* transA, char* diag, int* m, int* n, float* alpha,
+            float* A, int* lda, float* B, int* ldb){
+    if (*m <= 0 || *n <= 0) return;
+    slach_strmm((*side == 'L' || *side == 'l') ? SLACH_RIGHT : SLACH_LEFT,
+                (*uplo == 'U' || *uplo == 'u') ? SLACH_LOWER : SLACH_UPPER, _blasIsTrans(transA),
+                (*diag == 'U' || *diag == 'u') ? SLACH_UNIT : SLACH_NON_UNIT,
+                (size_t)*n, (size_t)*m, *alpha, A, (size_t)*lda, B, (size_t)*ldb);
+}
+#endif
@@ -0,0 +1,390 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/conv.h"
+#include "../include/GEMM.h"
+#include "../include/FFT.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+#include "simd.h"
+
+#define CONV_PAR_MIN (slach_tune()->parMin) //tunable, see tune.h
+#define CONV_PANEL (1<<16)  //floats of one im2col panel, about L2 sized
+#define CONV_DIRECT_MAX 32  //C*kh*kw up to this is too shallow a product for the GEMM path
+#define CONV_GEMM_MIN_K 8   //with fewer kernels the product reuses too little of each panel
+#define CONV_FFT_MIN 729    //kh*kw from 27x27 up goes through the FFT at stride 1
+
+typedef struct _ConvCtx_{
+    size_t C, H, W, K, kh, kw, stride, pad, OH, OW;
+    size_t ckk;      //C*kh*kw, the depth of the product
+    size_t nb;       //output pixels per im2col panel
+    size_t P, Q;     //FFT sizes
+    float* in;
+    float* w;        //kernels, flipped for a true convolution
+    float* bias;
+    float* out;
+    complex* xf;     //spectra of the input channels
+}ConvCtx;
+
+/** \brief output length of a convolution along one axis
+ *
+ * \param n: input length
+ * \param k: kernel length
+ * \param stride, pad
+ * \return size_t
+ *
+ */
+
+size_t conv2dOutSize(size_t n, size_t k, size_t stride, size_t pad){
+    if (stride == 0) perr("In conv2dOutSize(), stride must be positive!\n");
+    if (k == 0 || n + 2*pad < k) perr("In conv2dOutSize(), the kernel doesn't fit in the padded input!\n");
+    return (n + 2*pad - k)/stride + 1;
+}
+
+/** \brief CONV_GEMM task: output pixel blocks [b0, b1), private function
+ *
+ *   Each block unrolls its receptive fields into a ckk x nb panel (zeros for the padding)
+ *   and multiplies the K x ckk kernel matrix by it straight into the output columns.
+ *
+ * \param ctx: ConvCtx
+ * \param b0, b1: blocks of nb pixels
+ * \return
+ *
+ */
+
+void _convGemmRange(void* ctx, size_t b0, size_t b1){
+    ConvCtx* c = (ConvCtx*)ctx;
+    size_t npix = c->OH*c->OW, s = c->stride;
+    float* panel = slach_malloc(float, c->ckk*c->nb);
+    GemmEpilogue ep;
+    size_t b, p0, np, ch, u, v, j, oy, ox, lo, hi, end;
+    long iy;
+    float* row;
+    float* src;
+    gemmEpilogueInit(&ep);
+    ep.colBias = c->bias;
+    for (b=b0; b<b1; b++){
+        p0 = b*c->nb;
+        np = MIN(c->nb, npix - p0);
+        row = panel;
+        for (ch=0; ch<c->C; ch++){
+            for (u=0; u<c->kh; u++){
+                for (v=0; v<c->kw; v++, row+=np){
+                    //the columns of one output row that read inside the input, as in _convDirectRange
+                    lo = c->pad > v ? (c->pad - v + s - 1)/s : 0;
+                    hi = c->W + c->pad > v ? MIN(c->OW, (c->W + c->pad - v - 1)/s + 1) : 0;
+                    for (j=0; j<np; j=end){
+                        oy = (p0 + j)/c->OW;
+                        ox = (p0 + j)%c->OW;
+                        end = MIN(np, j + c->OW - ox);
+                        iy = (long)(oy*s + u) - (long)c->pad;
+                        if (iy < 0 || iy >= (long)c->H){
+                            memset(row + j, 0, (end - j)*sizeof(float));
+                            continue;
+                        }
+                        src = c->in + (ch*c->H + iy)*c->W;
+                        for (; j<end && ox<lo; j++, ox++) row[j] = 0;
+                        if (s == 1 && ox < hi && j < end){
+                            memcpy(row + j, src + ox + v - c->pad, MIN(hi - ox, end - j)*sizeof(float));
+                            j += MIN(hi - ox, end - j);
+                            ox = hi;
+                        }
+                        for (; j<end && ox<hi; j++, ox++) row[j] = src[ox*s + v - c->pad];
+                        for (; j<end; j++) row[j] = 0;
+                    }
+                }
+            }
+        }
+        gemmEx(0, 0, c->K, np, c->ckk, c->w, c->ckk, panel, np, c->out + p0, npix, &ep);
+    }
+    slach_free(panel);
+}
+
+/** \brief CONV_DIRECT task: output rows [r0, r1) over all channels, private function
+ *
+ *   Every kernel tap adds a scaled input row to the output row; at stride 1 that is a
+ *   contiguous multiply-add over the taps' valid columns.
+ *
+ * \param ctx: ConvCtx
+ * \param r0, r1: rows k*OH + oy
+ * \return
+ *
+ */
+
+void _convDirectRange(void* ctx, size_t r0, size_t r1){
+    ConvCtx* c = (ConvCtx*)ctx;
+    size_t r, k, oy, ch, u, v, lo, hi, ox, s = c->stride;
+    long iy;
+    float* o;
+    float* irow;
+    float* x;
+    float wv;
+    vfloat vw;
+    for (r=r0; r<r1; r++){
+        k = r/c->OH; oy = r%c->OH;
+        o = c->out + r*c->OW;
+        for (ox=0; ox<c->OW; ox++) o[ox] = c->bias != NULL ? c->bias[k] : 0;
+        for (ch=0; ch<c->C; ch++){
+            for (u=0; u<c->kh; u++){
+                iy = (long)(oy*s + u) - (long)c->pad;
+                if (iy < 0 || iy >= (long)c->H) continue;
+                irow = c->in + (ch*c->H + iy)*c->W;
+                for (v=0; v<c->kw; v++){
+                    wv = c->w[((k*c->C + ch)*c->kh + u)*c->kw + v];
+                    //output columns whose input column ox*s + v - pad is inside [0, W)
+                    lo = c->pad > v ? (c->pad - v + s - 1)/s : 0;
+                    hi = c->W + c->pad > v ? MIN(c->OW, (c->W + c->pad - v - 1)/s + 1) : 0;
+                    if (lo >= hi) continue;
+                    x = irow + lo*s + v - c->pad;
+                    if (s == 1){
+                        vw = vfSet1(wv);
+                        for (ox=lo; ox+SLACH_VLEN<=hi; ox+=SLACH_VLEN, x+=SLACH_VLEN)
+                            vfStore(o+ox, vfFmadd(vw, vfLoad(x), vfLoad(o+ox)));
+                        for (; ox<hi; ox++, x++) o[ox] += wv*(*x);
+                    }
+                    else{
+                        for (ox=lo; ox<hi; ox++, x+=s) o[ox] += wv*(*x);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/** \brief 2-D FFT of a P x Q array in place: rows, then columns through buf, private function
+ *
+ * \param a: P*Q points
+ * \param P, Q: powers of two
+ * \param r0, r1: rows outside [r0, r1) are zero and skip the row pass
+ * \param inverse: as in fftRadix2
+ * \param buf: P points of scratch
+ * \return
+ *
+ */
+
+void _convFft2(complex* a, size_t P, size_t Q, size_t r0, size_t r1, int inverse, complex* buf){
+    size_t i, j;
+    for (i=r0; i<r1; i++) fftRadix2(a + i*Q, (int)Q, inverse);
+    for (j=0; j<Q; j++){
+        for (i=0; i<P; i++) buf[i] = a[i*Q + j];
+        fftRadix2(buf, (int)P, inverse);
+        for (i=0; i<P; i++) a[i*Q + j] = buf[i];
+    }
+}
+
+/** \brief CONV_FFT task: spectra of the padded input channels [c0, c1), private function
+ *
+ * \param ctx: ConvCtx
+ * \param c0, c1: channels
+ * \return
+ *
+ */
+
+void _convFftInRange(void* ctx, size_t c0, size_t c1){
+    ConvCtx* c = (ConvCtx*)ctx;
+    complex* buf = slach_malloc(complex, c->P);
+    complex* a;
+    size_t ch, i, j;
+    for (ch=c0; ch<c1; ch++){
+        a = c->xf + ch*c->P*c->Q;
+        memset(a, 0, c->P*c->Q*sizeof(complex));
+        for (i=0; i<c->H; i++){
+            for (j=0; j<c->W; j++) a[(i + c->pad)*c->Q + j + c->pad].re = c->in[(ch*c->H + i)*c->W + j];
+        }
+        _convFft2(a, c->P, c->Q, c->pad, c->pad + c->H, 0, buf);
+    }
+    slach_free(buf);
+}
+
+/** \brief CONV_FFT task: output channels [k0, k1), private function
+ *
+ *   The circular correlation of the padded input with a kernel is the inverse transform of
+ *   X * conj(Wf); P and Q cover the padded input so the kept outputs never wrap.
+ *
+ * \param ctx: ConvCtx
+ * \param k0, k1: output channels
+ * \return
+ *
+ */
+
+void _convFftOutRange(void* ctx, size_t k0, size_t k1){
+    ConvCtx* c = (ConvCtx*)ctx;
+    size_t pq = c->P*c->Q;
+    complex* acc = slach_malloc(complex, pq);
+    complex* wf = slach_malloc(complex, pq);
+    complex* buf = slach_malloc(complex, c->P);
+    complex* x;
+    size_t k, ch, i, j;
+    float* wk;
+    float scale = 1.0f/(float)pq;
+    for (k=k0; k<k1; k++){
+        memset(acc, 0, pq*sizeof(complex));
+        for (ch=0; ch<c->C; ch++){
+            memset(wf, 0, pq*sizeof(complex));
+            wk = c->w + (k*c->C + ch)*c->kh*c->kw;
+            for (i=0; i<c->kh; i++){
+                for (j=0; j<c->kw; j++) wf[i*c->Q + j].re = wk[i*c->kw + j];
+            }
+            _convFft2(wf, c->P, c->Q, 0, c->kh, 0, buf);
+            x = c->xf + ch*pq;
+            for (i=0; i<pq; i++){
+                acc[i].re += x[i].re*wf[i].re + x[i].im*wf[i].im;
+                acc[i].im += x[i].im*wf[i].re - x[i].re*wf[i].im;
+            }
+        }
+        _convFft2(acc, c->P, c->Q, 0, c->P, 1, buf);
+        for (i=0; i<c->OH; i++){
+            for (j=0; j<c->OW; j++){
+                c->out[(k*c->OH + i)*c->OW + j] = acc[i*c->stride*c->Q + j*c->stride].re*scale
+                                                   + (c->bias != NULL ? c->bias[k] : 0);
+            }
+        }
+    }
+    slach_free(acc);
+    slach_free(wf);
+    slach_free(buf);
+}
+
+/** \brief smallest power of two >= n, private function
+ *
+ * \param n
+ * \return size_t
+ *
+ */
+
+size_t _convPow2(size_t n){
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+/** \brief multi-channel 2-D convolution or correlation
+ *
+ * \param algo: CONV_AUTO, CONV_GEMM, CONV_DIRECT or CONV_FFT
+ * \param flip: 1 flips the kernels (convolution), 0 does not (correlation)
+ * \param C, H, W, in: C x H x W input
+ * \param K, kh, kw, kernel: K x C x kh x kw kernels
+ * \param bias: K values or NULL
+ * \param stride, pad: same along both axes, zero padding
+ * \param out: K x OH x OW, OH = conv2dOutSize(H, kh, stride, pad), OW likewise
+ * \return
+ *
+ */
+
+void conv2dEx(ConvAlgo algo, int flip, size_t C, size_t H, size_t W, IN float* in,
+              size_t K, size_t kh, size_t kw, IN float* kernel, IN float* bias,
+              size_t stride, size_t pad, OUT float* out){
+    ConvCtx c;
+    size_t i, j, n, sz;
+    if (in == NULL || kernel == NULL || out == NULL) perr("In conv2dEx(), in, kernel and out can't be NULL!\n");
+    if (C == 0 || K == 0 || H == 0 || W == 0) perr("In conv2dEx(), empty input or kernel set!\n");
+    c.OH = conv2dOutSize(H, kh, stride, pad);
+    c.OW = conv2dOutSize(W, kw, stride, pad);
+    c.C = C; c.H = H; c.W = W; c.K = K; c.kh = kh; c.kw = kw;
+    c.stride = stride; c.pad = pad;
+    c.ckk = C*kh*kw;
+    c.in = in; c.bias = bias; c.out = out;
+    c.w = kernel;
+    if (flip){
+        sz = kh*kw;
+        c.w = slach_malloc(float, K*c.ckk);
+        for (n=0; n<K*C; n++){
+            for (i=0; i<sz; i++) c.w[n*sz + i] = kernel[n*sz + sz-1-i];
+        }
+    }
+    if (algo == CONV_AUTO){
+        if (stride == 1 && kh*kw >= CONV_FFT_MIN) algo = CONV_FFT;
+        else if (c.ckk <= CONV_DIRECT_MAX || K < CONV_GEMM_MIN_K) algo = CONV_DIRECT;
+        else algo = CONV_GEMM;
+    }
+    if (algo == CONV_GEMM){
+        c.nb = MIN(c.OH*c.OW, MAX((size_t)64, (CONV_PANEL/c.ckk) & ~(size_t)15));
+        slach_parallel_for((c.OH*c.OW + c.nb - 1)/c.nb, 1, _convGemmRange, &c);
+    }
+    else if (algo == CONV_DIRECT){
+        slach_parallel_for(K*c.OH, MAX((size_t)1, CONV_PAR_MIN/(c.ckk*c.OW)), _convDirectRange, &c);
+    }
+    else if (algo == CONV_FFT){
+        c.P = _convPow2(H + 2*pad);
+        c.Q = _convPow2(W + 2*pad);
+        if (c.P > INT_MAX || c.Q > INT_MAX) perr("In conv2dEx(), input too large for the FFT path!\n");
+        c.xf = slach_malloc(complex, C*c.P*c.Q);
+        j = c.P*c.Q*(c.P + c.Q); //rough cost of one 2-D transform
+        slach_parallel_for(C, MAX((size_t)1, CONV_PAR_MIN/j), _convFftInRange, &c);
+        slach_parallel_for(K, MAX((size_t)1, CONV_PAR_MIN/(C*j)), _convFftOutRange, &c);
+        slach_free(c.xf);
+    }
+    else perr("In conv2dEx(), unknown algorithm!\n");
+    if (flip) slach_free(c.w);
+}
+
+/** \brief single channel convolution (the kernel is flipped)
+ *
+ * \param arr, row, col: input
+ * \param kernel, kh, kw
+ * \param stride, pad
+ * \param dest, height, width: conv2dOutSize(row, kh, stride, pad) x conv2dOutSize(col, kw, stride, pad)
+ * \return
+ *
+ */
+
+void conv2d(INOUT float* arr, size_t row, size_t col, INOUT float* kernel, size_t kh, size_t kw,
+            size_t stride, size_t pad, OUT float* dest, size_t height, size_t width){
+    if (height != conv2dOutSize(row, kh, stride, pad) || width != conv2dOutSize(col, kw, stride, pad))
+        perr("In conv2d(), dest has the wrong size!\n");
+    conv2dEx(CONV_AUTO, 1, 1, row, col, arr, 1, kh, kw, kernel, NULL, stride, pad, dest);
+}
+
+/** \brief single channel correlation
+ *
+ * \param arr, row, col: input
+ * \param kernel, kh, kw
+ * \param stride, pad
+ * \param dest, height, width: conv2dOutSize(row, kh, stride, pad) x conv2dOutSize(col, kw, stride, pad)
+ * \return
+ *
+ */
+
+void corr2d(INOUT float* arr, size_t row, size_t col, INOUT float* kernel, size_t kh, size_t kw,
+            size_t stride, size_t pad, OUT float* dest, size_t height, size_t width){
+    if (height != conv2dOutSize(row, kh, stride, pad) || width != conv2dOutSize(col, kw, stride, pad))
+        perr("In corr2d(), dest has the wrong size!\n");
+    conv2dEx(CONV_AUTO, 0, 1, row, col, arr, 1, kh, kw, kernel, NULL, stride, pad, dest);
+}
@@ -0,0 +1,361 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/distance.h"
+#include "../include/GEMM.h"
+#include "../include/parallel.h"
+
+#define DIST_TILE_M 128   //rows of X per tile
+#define DIST_TILE_N 1024  //rows of Y per tile, a 128 x 1024 tile of floats stays in L2
+
+typedef struct _DistCtx_{
+    DistMetric metric;
+    size_t m, n, d, ldx, ldy, ldd, k, tm;
+    float* X;
+    float* Y;
+    float* D;
+    float* xs;   //squared norms for the Euclidean metrics, inverse norms for cosine
+    float* ys;
+    float* dist;
+    size_t* idx;
+}DistCtx;
+
+typedef struct _DistNormCtx_{
+    float* M;
+    size_t ld, d;
+    int cosine;
+    float* out;
+}DistNormCtx;
+
+/** \brief squared norms (or inverse norms for cosine) of the rows [t0, t1) of M, private function
+ *
+ * \param ctx: DistNormCtx
+ * \param t0, t1: rows
+ * \return
+ *
+ */
+
+void _distNormRange(void* ctx, size_t t0, size_t t1){
+    DistNormCtx* c = (DistNormCtx*)ctx;
+    size_t i, j;
+    double s;
+    float* r;
+    for (i=t0; i<t1; i++){
+        r = c->M + i*c->ld;
+        for (j=0, s=0; j<c->d; j++) s += (double)r[j]*r[j];
+        if (c->cosine) c->out[i] = s > 0 ? (float)(1/sqrt(s)) : 0;
+        else c->out[i] = (float)s;
+    }
+}
+
+/** \brief row norms of a row-major matrix on the thread pool, private function
+ *
+ * \param metric
+ * \param M, rows, d, ld: the matrix
+ * \return float*: slach_malloc'd, rows entries
+ *
+ */
+
+float* _distNorms(DistMetric metric, float* M, size_t rows, size_t d, size_t ld){
+    DistNormCtx c;
+    c.M = M; c.ld = ld; c.d = d;
+    c.cosine = metric == DIST_COSINE;
+    c.out = slach_malloc(float, rows);
+    slach_parallel_for(rows, MAX((size_t)1, 4096/MAX(d, (size_t)1)), _distNormRange, &c);
+    return c.out;
+}
+
+/** \brief one tile of distances: rows i0..i0+mi of X against rows j0..j0+nj of Y, private function
+ *
+ *   The product and the norm biases come from gemmEx, the clamping and the square root or the
+ *   cosine scaling run right after on the tile.
+ *
+ * \param c: context
+ * \param metric: DIST_EUCLIDEAN is computed as DIST_SQEUCLIDEAN when the caller asks for it
+ * \param i0, mi, j0, nj: tile
+ * \param out, ldo: destination
+ * \return
+ *
+ */
+
+void _distTile(DistCtx* c, DistMetric metric, size_t i0, size_t mi, size_t j0, size_t nj, float* out, size_t ldo){
+    GemmEpilogue ep;
+    size_t i, j;
+    float* o;
+    float x;
+    gemmEpilogueInit(&ep);
+    if (metric != DIST_COSINE){
+        ep.alpha = -2;
+        ep.colBias = c->xs + i0;
+        ep.rowBias = c->ys + j0;
+    }
+    gemmEx(0, 1, mi, nj, c->d, c->X + i0*c->ldx, c->ldx, c->Y + j0*c->ldy, c->ldy, out, ldo, &ep);
+    for (i=0; i<mi; i++){
+        o = out + i*ldo;
+        if (metric == DIST_COSINE){
+            x = c->xs[i0+i];
+            for (j=0; j<nj; j++) o[j] = 1 - o[j]*x*c->ys[j0+j];
+        }
+        else if (metric == DIST_EUCLIDEAN){
+            for (j=0; j<nj; j++) o[j] = o[j] > 0 ? sqrtf(o[j]) : 0;
+        }
+        else{
+            for (j=0; j<nj; j++) o[j] = o[j] > 0 ? o[j] : 0;
+        }
+    }
+}
+
+/** \brief pdistEx task: tiles [t0, t1) of the distance matrix, private function
+ *
+ * \param ctx: DistCtx
+ * \param t0, t1: tile numbers, row-major over the tile grid
+ * \return
+ *
+ */
+
+void _pdistRange(void* ctx, size_t t0, size_t t1){
+    DistCtx* c = (DistCtx*)ctx;
+    size_t nt = (c->n + DIST_TILE_N - 1)/DIST_TILE_N;
+    size_t t, i0, j0;
+    for (t=t0; t<t1; t++){
+        i0 = (t/nt)*DIST_TILE_M;
+        j0 = (t%nt)*DIST_TILE_N;
+        _distTile(c, c->metric, i0, MIN((size_t)DIST_TILE_M, c->m - i0), j0, MIN((size_t)DIST_TILE_N, c->n - j0),
+                  c->D + i0*c->ldd + j0, c->ldd);
+    }
+}
+
+/** \brief checks shared by pdistEx and knnEx and the norms, private function
+ *
+ * \param c: filled in
+ * \param func: caller name for the error message
+ * \return
+ *
+ */
+
+void _distInit(DistCtx* c, DistMetric metric, size_t m, size_t n, size_t d, float* X, size_t ldx,
+               float* Y, size_t ldy, const char* func){
+    char msg[128];
+    if (X == NULL || Y == NULL){
+        snprintf(msg, sizeof(msg), "In %s(), X and Y can't be NULL!\n", func);
+        perr(msg);
+    }
+    if (d == 0 || ldx < d || ldy < d){
+        snprintf(msg, sizeof(msg), "In %s(), d must be positive and not above the leading dimensions!\n", func);
+        perr(msg);
+    }
+    if (metric != DIST_SQEUCLIDEAN && metric != DIST_EUCLIDEAN && metric != DIST_COSINE){
+        snprintf(msg, sizeof(msg), "In %s(), unknown metric!\n", func);
+        perr(msg);
+    }
+    c->metric = metric;
+    c->m = m; c->n = n; c->d = d;
+    c->X = X; c->ldx = ldx;
+    c->Y = Y; c->ldy = ldy;
+    c->xs = _distNorms(metric, X, m, d, ldx);
+    c->ys = _distNorms(metric, Y, n, d, ldy);
+}
+
+/** \brief pairwise distance matrix D[i][j] = dist(X row i, Y row j)
+ *
+ * \param metric: DIST_SQEUCLIDEAN, DIST_EUCLIDEAN or DIST_COSINE
+ * \param m, n, d: X is m x d, Y is n x d
+ * \param X, ldx, Y, ldy: row-major inputs, Y may be X
+ * \param D, ldd: m x n output
+ * \return
+ *
+ */
+
+void pdistEx(DistMetric metric, size_t m, size_t n, size_t d, IN float* X, size_t ldx,
+             IN float* Y, size_t ldy, OUT float* D, size_t ldd){
+    DistCtx c;
+    if (m == 0 || n == 0) return;
+    if (D == NULL || ldd < n) perr("In pdistEx(), D is NULL or its leading dimension is too small!\n");
+    _distInit(&c, metric, m, n, d, X, ldx, Y, ldy, "pdistEx");
+    c.D = D; c.ldd = ldd;
+    slach_parallel_for(((m + DIST_TILE_M - 1)/DIST_TILE_M)*((n + DIST_TILE_N - 1)/DIST_TILE_N), 1, _pdistRange, &c);
+    slach_free(c.xs);
+    slach_free(c.ys);
+}
+
+/** \brief pairwise distances between the rows of two arrays
+ *
+ * \param metric
+ * \param arr1, row1, col1: X
+ * \param arr2, row2, col2: Y, col2 == col1
+ * \param dest, height, width: row1 x row2
+ * \return
+ *
+ */
+
+void pdist(DistMetric metric, INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+           OUT float* dest, size_t height, size_t width){
+    if (col1 != col2) perr("In pdist(), the two arrays must have the same number of columns!\n");
+    if (height != row1 || width != row2) perr("In pdist(), dest must be row1 x row2!\n");
+    pdistEx(metric, row1, row2, col1, arr1, col1, arr2, col2, dest, width);
+}
+
+/** \brief (d1, i1) comes before (d2, i2): smaller distance, then smaller index, private function
+ *
+ * \param d1, i1, d2, i2
+ * \return int
+ *
+ */
+
+int _knnBefore(float d1, size_t i1, float d2, size_t i2){
+    return d1 < d2 || (d1 == d2 && i1 < i2);
+}
+
+/** \brief restores the max-heap (farthest neighbour at the root) from position p down, private function
+ *
+ * \param hd, hi: heap of cnt distances and indices
+ * \param cnt, p
+ * \return
+ *
+ */
+
+void _knnSift(float* hd, size_t* hi, size_t cnt, size_t p){
+    size_t ch;
+    float td;
+    size_t ti;
+    while ((ch = 2*p + 1) < cnt){
+        if (ch + 1 < cnt && _knnBefore(hd[ch], hi[ch], hd[ch+1], hi[ch+1])) ch++;
+        if (!_knnBefore(hd[p], hi[p], hd[ch], hi[ch])) break;
+        td = hd[p]; hd[p] = hd[ch]; hd[ch] = td;
+        ti = hi[p]; hi[p] = hi[ch]; hi[ch] = ti;
+        p = ch;
+    }
+}
+
+/** \brief knnEx task: the k nearest rows of Y for the rows of X in blocks [t0, t1), private function
+ *
+ *   Every block streams over the tiles of Y with one tile of scratch; the heaps of a block
+ *   live in its rows of dist and idx until they are sorted in place at the end.
+ *
+ * \param ctx: DistCtx
+ * \param t0, t1: blocks of c->tm rows of X
+ * \return
+ *
+ */
+
+void _knnRange(void* ctx, size_t t0, size_t t1){
+    DistCtx* c = (DistCtx*)ctx;
+    DistMetric metric = c->metric == DIST_EUCLIDEAN ? DIST_SQEUCLIDEAN : c->metric; //same order, sqrt of the winners only
+    float* tile = slach_malloc(float, c->tm*MIN((size_t)DIST_TILE_N, c->n));
+    size_t t, i0, mi, j0, nj, i, j, cnt, k = c->k;
+    float* hd;
+    size_t* hi;
+    float* o;
+    float td;
+    size_t ti;
+    for (t=t0; t<t1; t++){
+        i0 = t*c->tm;
+        mi = MIN(c->tm, c->m - i0);
+        for (j0=0; j0<c->n; j0+=DIST_TILE_N){
+            nj = MIN((size_t)DIST_TILE_N, c->n - j0);
+            _distTile(c, metric, i0, mi, j0, nj, tile, nj);
+            for (i=0; i<mi; i++){
+                hd = c->dist + (i0+i)*k;
+                hi = c->idx + (i0+i)*k;
+                o = tile + i*nj;
+                j = 0;
+                if (j0 < k){
+                    //the heap is still filling up
+                    for (; j<nj && j0+j<k; j++){
+                        cnt = j0 + j;
+                        hd[cnt] = o[j]; hi[cnt] = j0 + j;
+                        for (; cnt>0 && _knnBefore(hd[(cnt-1)/2], hi[(cnt-1)/2], hd[cnt], hi[cnt]); cnt=(cnt-1)/2){
+                            td = hd[cnt]; hd[cnt] = hd[(cnt-1)/2]; hd[(cnt-1)/2] = td;
+                            ti = hi[cnt]; hi[cnt] = hi[(cnt-1)/2]; hi[(cnt-1)/2] = ti;
+                        }
+                    }
+                }
+                for (; j<nj; j++){
+                    if (o[j] < hd[0]){  //indices only grow, so a tie never displaces the root
+                        hd[0] = o[j]; hi[0] = j0 + j;
+                        _knnSift(hd, hi, k, 0);
+                    }
+                }
+            }
+        }
+        //heap sort: pop the farthest to the back
+        for (i=0; i<mi; i++){
+            hd = c->dist + (i0+i)*k;
+            hi = c->idx + (i0+i)*k;
+            for (cnt=k; cnt>1; cnt--){
+                td = hd[0]; hd[0] = hd[cnt-1]; hd[cnt-1] = td;
+                ti = hi[0]; hi[0] = hi[cnt-1]; hi[cnt-1] = ti;
+                _knnSift(hd, hi, cnt-1, 0);
+            }
+            if (c->metric == DIST_EUCLIDEAN){
+                for (j=0; j<k; j++) hd[j] = sqrtf(hd[j]);
+            }
+        }
+    }
+    slach_free(tile);
+}
+
+/** \brief brute-force k nearest neighbours: for every row of X the k closest rows of Y
+ *
+ * \param metric: DIST_SQEUCLIDEAN, DIST_EUCLIDEAN or DIST_COSINE
+ * \param m, n, d: X is m x d, Y is n x d
+ * \param X, ldx, Y, ldy: row-major inputs, Y may be X (each row is then its own nearest neighbour)
+ * \param k: 1 <= k <= n
+ * \param dist: m x k distances, ascending along a row
+ * \param idx: m x k row numbers of Y matching dist
+ * \return
+ *
+ */
+
+void knnEx(DistMetric metric, size_t m, size_t n, size_t d, IN float* X, size_t ldx,
+           IN float* Y, size_t ldy, size_t k, OUT float* dist, OUT size_t* idx){
+    DistCtx c;
+    size_t nt = slach_get_num_threads();
+    if (m == 0) return;
+    if (k == 0 || k > n) perr("In knnEx(), k must be in [1, n]!\n");
+    if (dist == NULL || idx == NULL) perr("In knnEx(), dist and idx can't be NULL!\n");
+    _distInit(&c, metric, m, n, d, X, ldx, Y, ldy, "knnEx");
+    c.k = k; c.dist = dist; c.idx = idx;
+    //blocks of X are the tasks: shrink them until every thread gets a couple
+    c.tm = MAX((size_t)8, MIN((size_t)DIST_TILE_M, (m + 2*nt - 1)/(2*nt)));
+    slach_parallel_for((m + c.tm - 1)/c.tm, 1, _knnRange, &c);
+    slach_free(c.xs);
+    slach_free(c.ys);
+}
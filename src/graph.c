@@ -0,0 +1,846 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/graph.h"
+#include "../include/GEMM.h"
+#include "../include/LUD.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+
+/*
+Nodes are stored in the order they were recorded, which is a topological order: a node only
+refers to older nodes. slach_eval first rewrites the graph once (fusion, dead node removal),
+then plans buffers level by level, a level being the nodes whose inputs all belong to
+earlier levels. Element-wise nodes are programs: a load of the first operand followed by
+unary, scalar and binary steps, each applied to a tile of LAZY_CHUNK floats while it is in L1.
+*/
+#define LAZY_BLOCK 4096 //columns of one element-wise task
+#define LAZY_CHUNK 256  //floats a fused program works on at a time
+#define LAZY_PAR_MIN (slach_tune()->parMin) //tunable, see tune.h
+#define LAZY_REFS_MUL 5 //A, B, added matrix, column bias, row bias
+
+typedef enum _LazyKind_{
+    LAZY_INPUT = 0, LAZY_MUL, LAZY_INV, LAZY_T, LAZY_EW, LAZY_DEAD
+}LazyKind;
+
+typedef enum _LazyStepKind_{
+    LAZY_LOAD = 0, LAZY_UNARY, LAZY_SCALAR, LAZY_BINARY
+}LazyStepKind;
+
+/** \brief one step of an element-wise program
+ *
+ * \param kind: LazyStepKind
+ * \param arg: operand node of LAZY_LOAD and LAZY_BINARY, -1 otherwise
+ * \param rev: LAZY_BINARY computes arg op x instead of x op arg
+ * \param op, order: EwOp (with the exponent of EW_POW) or EwBinOp
+ * \param s: operand of LAZY_SCALAR
+ * \return
+ *
+ */
+
+typedef struct _LazyStep_{
+    LazyStepKind kind;
+    int arg;
+    int rev;
+    int op;
+    double order;
+    float s;
+}LazyStep;
+
+/** \brief a node of the graph
+ *
+ * \param kind, row, col: operation and shape of the result
+ * \param a, b: operands (b only for LAZY_MUL), -1 when unused
+ * \param transA, transB, ep, c, colBias, rowBias: LAZY_MUL, c is the added matrix (beta*C),
+ *   the bias pointers of ep are filled in from colBias and rowBias at run time
+ * \param step, nStep: program of LAZY_EW
+ * \param data: array of LAZY_INPUT
+ * \param dest: output array, NULL when the node is not an output
+ * \param uses: references from other live nodes
+ * \param level, slot, buf: plan of the current slach_eval
+ * \return
+ *
+ */
+
+typedef struct _LazyNode_{
+    LazyKind kind;
+    size_t row, col;
+    int a, b;
+    int transA, transB;
+    GemmEpilogue ep;
+    int c, colBias, rowBias;
+    LazyStep* step;
+    size_t nStep;
+    float* data;
+    float* dest;
+    int uses;
+    int level;
+    int slot;
+    float* buf;
+}LazyNode;
+
+struct _SlachGraph_{
+    LazyNode* node;
+    size_t n;
+    size_t cap;
+    int evaluated;
+};
+
+/** \brief arguments of one level or one element-wise node on the thread pool
+ *
+ * \param g
+ * \param ids: nodes of the level
+ * \param x: element-wise node, nb: column blocks per row
+ * \return
+ *
+ */
+
+typedef struct _LazyCtx_{
+    SlachGraph* g;
+    int* ids;
+    LazyNode* x;
+    size_t nb;
+}LazyCtx;
+
+/** \brief create an empty graph
+ *
+ * \param empty
+ * \return SlachGraph*
+ *
+ */
+
+SlachGraph* slach_graph_create(){
+    SlachGraph* g = slach_malloc(SlachGraph, 1);
+    g->cap = 16;
+    g->node = slach_malloc(LazyNode, g->cap);
+    return g;
+}
+
+/** \brief free a graph; the input and output arrays are not touched
+ *
+ * \param g
+ * \return
+ *
+ */
+
+void slach_graph_destroy(SlachGraph* g){
+    size_t i;
+    if (g == NULL){
+        perr("In slach_graph_destroy(), g is NULL!\n");
+    }
+    for (i=0; i<g->n; i++){
+        if (g->node[i].step != NULL) slach_free(g->node[i].step);
+    }
+    slach_free(g->node);
+    slach_free(g);
+}
+
+/** \brief number of reference slots of a node, see _lazyRef, private function
+ *
+ * \param x
+ * \return size_t
+ *
+ */
+
+size_t _lazyNRefs(LazyNode* x){
+    switch (x->kind){
+        case LAZY_MUL: return LAZY_REFS_MUL;
+        case LAZY_INV:
+        case LAZY_T:   return 1;
+        case LAZY_EW:  return x->nStep;
+        default:       return 0;
+    }
+}
+
+/** \brief k-th node referenced by a node, private function
+ *
+ * \param x
+ * \param k: below _lazyNRefs(x)
+ * \return int, node id or -1 for an empty slot
+ *
+ */
+
+int _lazyRef(LazyNode* x, size_t k){
+    if (x->kind == LAZY_MUL){
+        int r[LAZY_REFS_MUL];
+        r[0] = x->a; r[1] = x->b; r[2] = x->c; r[3] = x->colBias; r[4] = x->rowBias;
+        return r[k];
+    }
+    if (x->kind == LAZY_EW) return x->step[k].arg;
+    return x->a;
+}
+
+/** \brief check a node id, private function
+ *
+ * \param g, id
+ * \param func: caller name for the message
+ * \return LazyNode*
+ *
+ */
+
+LazyNode* _lazyGet(SlachGraph* g, int id, const char* func){
+    char msg[128];
+    if (g == NULL || id < 0 || (size_t)id >= g->n){
+        snprintf(msg, sizeof(msg), "In %s(), g is NULL or node %d does not exist!\n", func, id);
+        perr(msg);
+    }
+    return g->node+id;
+}
+
+/** \brief append a node and count its references, private function
+ *
+ * \param g
+ * \param x: the node, steps owned by the graph from now on
+ * \return int, node id
+ *
+ */
+
+int _lazyAdd(SlachGraph* g, LazyNode* x){
+    LazyNode* grown;
+    size_t k;
+    int r;
+    if (g->evaluated){
+        perr("In slach_lazy_*(), the graph has been evaluated already!\n");
+    }
+    if (g->n == g->cap){
+        grown = slach_malloc(LazyNode, 2*g->cap);
+        memcpy(grown, g->node, g->n*sizeof(LazyNode));
+        slach_free(g->node);
+        g->node = grown;
+        g->cap *= 2;
+    }
+    for (k=0; k<_lazyNRefs(x); k++){
+        if ((r = _lazyRef(x, k)) >= 0) g->node[r].uses++;
+    }
+    g->node[g->n] = *x;
+    return (int)g->n++;
+}
+
+/** \brief a node with no operands and no epilogue, private function
+ *
+ * \param kind, row, col
+ * \return LazyNode
+ *
+ */
+
+LazyNode _lazyNode(LazyKind kind, size_t row, size_t col){
+    LazyNode x;
+    memset(&x, 0, sizeof(x));
+    x.kind = kind; x.row = row; x.col = col;
+    x.a = x.b = x.c = x.colBias = x.rowBias = -1;
+    x.slot = -1;
+    gemmEpilogueInit(&x.ep);
+    return x;
+}
+
+/** \brief element-wise node: load of a followed by one step, private function
+ *
+ * \param g
+ * \param a: first operand
+ * \param row, col: shape of the result
+ * \param st: the step
+ * \return int
+ *
+ */
+
+int _lazyEw(SlachGraph* g, int a, size_t row, size_t col, LazyStep st){
+    LazyNode x = _lazyNode(LAZY_EW, row, col);
+    x.step = slach_malloc(LazyStep, 2);
+    x.step[0].kind = LAZY_LOAD;
+    x.step[0].arg = a;
+    x.step[1] = st;
+    x.nStep = 2;
+    return _lazyAdd(g, &x);
+}
+
+/** \brief record an input matrix, read at every slach_eval
+ *
+ * \param g
+ * \param 2-dim array, row, col
+ * \return int, node id
+ *
+ */
+
+int slach_lazy_input(SlachGraph* g, IN float* arr, size_t row, size_t col){
+    LazyNode x;
+    if (g == NULL || arr == NULL){
+        perr("In slach_lazy_input(), g or arr is NULL!\n");
+    }
+    if (row == 0 || col == 0){
+        perr("In slach_lazy_input(), col or row has problems!\n");
+    }
+    x = _lazyNode(LAZY_INPUT, row, col);
+    x.data = arr;
+    return _lazyAdd(g, &x);
+}
+
+/** \brief record the matrix product a*b
+ *
+ * \param g
+ * \param a, b: node ids
+ * \return int, node id
+ *
+ */
+
+int slach_lazy_mmMul(SlachGraph* g, int a, int b){
+    LazyNode* na = _lazyGet(g, a, "slach_lazy_mmMul");
+    LazyNode* nb = _lazyGet(g, b, "slach_lazy_mmMul");
+    LazyNode x;
+    if (na->col != nb->row){
+        perr("In slach_lazy_mmMul(), col1 != row2!\n");
+    }
+    x = _lazyNode(LAZY_MUL, na->row, nb->col);
+    x.a = a; x.b = b;
+    return _lazyAdd(g, &x);
+}
+
+/** \brief record dest = op(a, b) with the broadcasting rules of ewBinary
+ *
+ * \param g
+ * \param op: EW_ADD, EW_SUB, EW_MUL, EW_DIV, EW_MIN or EW_MAX
+ * \param a, b: node ids
+ * \return int, node id
+ *
+ */
+
+int slach_lazy_ewBinary(SlachGraph* g, EwBinOp op, int a, int b){
+    LazyNode* na = _lazyGet(g, a, "slach_lazy_ewBinary");
+    LazyNode* nb = _lazyGet(g, b, "slach_lazy_ewBinary");
+    size_t row = MAX(na->row, nb->row), col = MAX(na->col, nb->col);
+    LazyStep st;
+    if ((int)op < EW_ADD || op > EW_MAX){
+        perr("In slach_lazy_ewBinary(), unknown op!\n");
+    }
+    if ((na->row != row && na->row != 1) || (na->col != col && na->col != 1) ||
+        (nb->row != row && nb->row != 1) || (nb->col != col && nb->col != 1)){
+        perr("In slach_lazy_ewBinary(), shapes cannot be broadcast!\n");
+    }
+    memset(&st, 0, sizeof(st));
+    st.kind = LAZY_BINARY; st.op = op;
+    //load the operand of full shape when there is one, so that the program can fuse with it
+    if (na->row == row && na->col == col){
+        st.arg = b;
+        return _lazyEw(g, a, row, col, st);
+    }
+    st.arg = a;
+    st.rev = 1;
+    return _lazyEw(g, b, row, col, st);
+}
+
+/** \brief record mmAdd: a + b of the same shape
+ *
+ * \param g
+ * \param a, b: node ids
+ * \return int, node id
+ *
+ */
+
+int slach_lazy_mmAdd(SlachGraph* g, int a, int b){
+    LazyNode* na = _lazyGet(g, a, "slach_lazy_mmAdd");
+    LazyNode* nb = _lazyGet(g, b, "slach_lazy_mmAdd");
+    if (na->row != nb->row || na->col != nb->col){
+        perr("In slach_lazy_mmAdd(), shapes are mismatched!\n");
+    }
+    return slach_lazy_ewBinary(g, EW_ADD, a, b);
+}
+
+/** \brief record dest = op(a, s)
+ *
+ * \param g
+ * \param op: EW_ADD, EW_SUB, EW_MUL, EW_DIV, EW_MIN or EW_MAX
+ * \param a: node id
+ * \param s: scalar
+ * \return int, node id
+ *
+ */
+
+int slach_lazy_ewBinaryScalar(SlachGraph* g, EwBinOp op, int a, float s){
+    LazyNode* na = _lazyGet(g, a, "slach_lazy_ewBinaryScalar");
+    LazyStep st;
+    if ((int)op < EW_ADD || op > EW_MAX){
+        perr("In slach_lazy_ewBinaryScalar(), unknown op!\n");
+    }
+    memset(&st, 0, sizeof(st));
+    st.kind = LAZY_SCALAR; st.arg = -1; st.op = op; st.s = s;
+    return _lazyEw(g, a, na->row, na->col, st);
+}
+
+/** \brief record an element-wise function (the lazy form of absm, expm, powm, ...)
+ *
+ * \param g
+ * \param op: EW_* code, order: exponent for EW_POW
+ * \param a: node id
+ * \return int, node id
+ *
+ */
+
+int slach_lazy_ew(SlachGraph* g, EwOp op, double order, int a){
+    LazyNode* na = _lazyGet(g, a, "slach_lazy_ew");
+    LazyStep st;
+    if ((int)op < EW_NONE || op > EW_SQRT){
+        perr("In slach_lazy_ew(), unknown op!\n");
+    }
+    memset(&st, 0, sizeof(st));
+    st.kind = LAZY_UNARY; st.arg = -1; st.op = op; st.order = order;
+    return _lazyEw(g, a, na->row, na->col, st);
+}
+
+/** \brief record the transpose of a
+ *
+ * \param g
+ * \param a: node id
+ * \return int, node id
+ *
+ */
+
+int slach_lazy_mT(SlachGraph* g, int a){
+    LazyNode* na = _lazyGet(g, a, "slach_lazy_mT");
+    LazyNode x = _lazyNode(LAZY_T, na->col, na->row);
+    x.a = a;
+    return _lazyAdd(g, &x);
+}
+
+/** \brief record the inverse of a square matrix
+ *
+ * \param g
+ * \param a: node id
+ * \return int, node id
+ *
+ */
+
+int slach_lazy_inv(SlachGraph* g, int a){
+    LazyNode* na = _lazyGet(g, a, "slach_lazy_inv");
+    LazyNode x;
+    if (na->row != na->col){
+        perr("In slach_lazy_inv(), inv needs squared matrix!\n");
+    }
+    x = _lazyNode(LAZY_INV, na->row, na->col);
+    x.a = a;
+    return _lazyAdd(g, &x);
+}
+
+/** \brief compute a node into dest at slach_eval
+ *
+ * \param g
+ * \param node: node id
+ * \param 2-dim array to save result, row, col
+ * \return
+ *
+ */
+
+void slach_lazy_output(SlachGraph* g, int node, OUT float* dest, size_t height, size_t width){
+    LazyNode* x = _lazyGet(g, node, "slach_lazy_output");
+    if (g->evaluated){
+        perr("In slach_lazy_output(), the graph has been evaluated already!\n");
+    }
+    if (dest == NULL || height != x->row || width != x->col){
+        perr("In slach_lazy_output(), dest is NULL or its shape is mismatched!\n");
+    }
+    if (x->dest != NULL){
+        perr("In slach_lazy_output(), the node is an output already!\n");
+    }
+    x->dest = dest;
+}
+
+/** \brief drop a node and its references, then every node left without a use, private function
+ *
+ * \param g, id
+ * \return
+ *
+ */
+
+void _lazyKill(SlachGraph* g, int id){
+    LazyNode* x = g->node+id;
+    size_t k;
+    int r;
+    for (k=0; k<_lazyNRefs(x); k++){
+        if ((r = _lazyRef(x, k)) >= 0 && --g->node[r].uses == 0 &&
+            g->node[r].dest == NULL && g->node[r].kind != LAZY_INPUT){
+            _lazyKill(g, r);
+        }
+    }
+    if (x->step != NULL) slach_free(x->step);
+    x->step = NULL; x->nStep = 0;
+    x->kind = LAZY_DEAD;
+}
+
+/** \brief whether a node is an intermediate used only once, so that its consumer may absorb it,
+ *   private function
+ *
+ * \param g, id
+ * \param row, col: shape the consumer needs
+ * \return int
+ *
+ */
+
+int _lazyPrivate(SlachGraph* g, int id, size_t row, size_t col){
+    LazyNode* p = g->node+id;
+    return p->uses == 1 && p->dest == NULL && p->row == row && p->col == col;
+}
+
+/** \brief move one element-wise step into the epilogue of a product, private function
+ *
+ * \param g
+ * \param m: LAZY_MUL node
+ * \param st: step applied to the product
+ * \return int, 0 when the epilogue cannot express it
+ *
+ */
+
+int _lazyAbsorb(SlachGraph* g, LazyNode* m, LazyStep* st){
+    LazyNode* q;
+    if (m->ep.op != EW_NONE) return 0;
+    if (st->kind == LAZY_UNARY){
+        m->ep.op = (EwOp)st->op;
+        m->ep.order = st->order;
+        return st->op != EW_NONE;
+    }
+    if (st->kind == LAZY_SCALAR){
+        if (st->op != EW_MUL || m->c >= 0 || m->colBias >= 0 || m->rowBias >= 0) return 0;
+        m->ep.alpha *= st->s;
+        return 1;
+    }
+    if (st->kind != LAZY_BINARY) return 0;
+    q = g->node+st->arg;
+    if (q->row == m->row && q->col == m->col){
+        if (m->c >= 0 || !(st->op == EW_ADD || (st->op == EW_SUB && !st->rev))) return 0;
+        m->c = st->arg;
+        m->ep.beta = st->op == EW_ADD ? 1 : -1;
+        return 1;
+    }
+    if (st->op != EW_ADD) return 0;
+    if (q->row == 1 && q->col == m->col && m->rowBias < 0){
+        m->rowBias = st->arg;
+        return 1;
+    }
+    if (q->col == 1 && q->row == m->row && m->colBias < 0){
+        m->colBias = st->arg;
+        return 1;
+    }
+    return 0;
+}
+
+/** \brief rewrite the graph once before its first evaluation: transposes into products,
+ *   element-wise chains into one program, element-wise steps into product epilogues,
+ *   unused nodes out, private function
+ *
+ * \param g
+ * \return
+ *
+ */
+
+void _lazyFuse(SlachGraph* g){
+    LazyNode* x;
+    LazyNode* p;
+    LazyStep* merged;
+    size_t i, k;
+    int id, *op, *tr;
+    for (i=g->n; i-- > 0; ){
+        x = g->node+i;
+        if (x->kind != LAZY_DEAD && x->kind != LAZY_INPUT && x->uses == 0 && x->dest == NULL){
+            _lazyKill(g, (int)i);
+        }
+    }
+    for (i=0; i<g->n; i++){
+        x = g->node+i;
+        if (x->kind == LAZY_MUL){
+            for (k=0; k<2; k++){
+                op = k == 0 ? &x->a : &x->b;
+                tr = k == 0 ? &x->transA : &x->transB;
+                while (g->node[*op].kind == LAZY_T){
+                    id = *op;
+                    *op = g->node[id].a;
+                    *tr ^= 1;
+                    g->node[*op].uses++;
+                    if (--g->node[id].uses == 0 && g->node[id].dest == NULL) _lazyKill(g, id);
+                }
+            }
+        }
+        if (x->kind != LAZY_EW) continue;
+        //an element-wise producer used only here: prepend its program
+        id = x->step[0].arg;
+        p = g->node+id;
+        if (p->kind == LAZY_EW && _lazyPrivate(g, id, x->row, x->col)){
+            merged = slach_malloc(LazyStep, p->nStep+x->nStep-1);
+            memcpy(merged, p->step, p->nStep*sizeof(LazyStep));
+            memcpy(merged+p->nStep, x->step+1, (x->nStep-1)*sizeof(LazyStep));
+            slach_free(x->step); slach_free(p->step);
+            x->step = merged;
+            x->nStep += p->nStep-1;
+            p->step = NULL; p->nStep = 0; p->uses = 0;
+            p->kind = LAZY_DEAD;
+        }
+        //a product used only here: move the leading steps into its epilogue
+        id = x->step[0].arg;
+        p = g->node+id;
+        if (p->kind != LAZY_MUL || !_lazyPrivate(g, id, x->row, x->col)) continue;
+        for (k=1; k<x->nStep && _lazyAbsorb(g, p, x->step+k); k++);
+        if (k == x->nStep){
+            slach_free(x->step);
+            x->step = NULL; x->nStep = 0;
+            x->kind = LAZY_MUL;
+            x->a = p->a; x->b = p->b; x->transA = p->transA; x->transB = p->transB;
+            x->ep = p->ep; x->c = p->c; x->colBias = p->colBias; x->rowBias = p->rowBias;
+            p->uses = 0;
+            p->kind = LAZY_DEAD;
+        }
+        else if (k > 1){
+            memmove(x->step+1, x->step+k, (x->nStep-k)*sizeof(LazyStep));
+            x->nStep -= k-1;
+        }
+    }
+}
+
+/** \brief element-wise tiles [t0, t1) of a node, thread pool body, private function
+ *
+ * \param arg: LazyCtx*
+ * \param t0, t1: tiles, one row by at most LAZY_BLOCK columns each
+ * \return
+ *
+ */
+
+void _lazyEwRange(void* arg, size_t t0, size_t t1){
+    LazyCtx* c = (LazyCtx*)arg;
+    LazyNode* x = c->x;
+    LazyNode* q;
+    float splat[LAZY_CHUNK];
+    float* d;
+    float* src;
+    size_t t, i, j, j1, n, k, l;
+    for (t=t0; t<t1; t++){
+        i = t/c->nb;
+        j = (t%c->nb)*LAZY_BLOCK;
+        j1 = MIN(x->col, j+LAZY_BLOCK);
+        for (; j<j1; j+=n){
+            n = MIN(LAZY_CHUNK, j1-j);
+            d = x->buf+i*x->col+j;
+            for (k=0; k<x->nStep; k++){
+                LazyStep* st = x->step+k;
+                src = NULL;
+                if (st->arg >= 0){
+                    //operand tile, a value broadcast along the row is splatted
+                    q = c->g->node+st->arg;
+                    src = q->buf+(q->row == 1 ? 0 : i*q->col)+(q->col == 1 ? 0 : j);
+                    if (q->col == 1 && x->col != 1){
+                        for (l=0; l<n; l++) splat[l] = *src;
+                        src = splat;
+                    }
+                }
+                switch (st->kind){
+                    case LAZY_LOAD:
+                        if (src != d) memcpy(d, src, n*sizeof(float));
+                        break;
+                    case LAZY_UNARY:
+                        ewApply((EwOp)st->op, st->order, d, n);
+                        break;
+                    case LAZY_SCALAR:
+                        for (l=0; l<n; l++) splat[l] = st->s;
+                        _ewBinKernel(st->op, d, splat, d, n);
+                        break;
+                    default:
+                        if (st->rev) _ewBinKernel(st->op, src, d, d, n);
+                        else _ewBinKernel(st->op, d, src, d, n);
+                        break;
+                }
+            }
+        }
+    }
+}
+
+/** \brief run one node on its planned buffer, private function
+ *
+ * \param g, id
+ * \return
+ *
+ */
+
+void _lazyRun(SlachGraph* g, int id){
+    LazyNode* x = g->node+id;
+    LazyNode* a = x->a >= 0 ? g->node+x->a : NULL;
+    LazyNode* b;
+    GemmEpilogue ep;
+    LazyCtx c;
+    size_t nt;
+    switch (x->kind){
+        case LAZY_INPUT:
+            if (x->dest != NULL && x->dest != x->data) memcpy(x->dest, x->data, x->row*x->col*sizeof(float));
+            break;
+        case LAZY_MUL:
+            b = g->node+x->b;
+            ep = x->ep;
+            if (x->c >= 0 && g->node[x->c].buf != x->buf){
+                memcpy(x->buf, g->node[x->c].buf, x->row*x->col*sizeof(float));
+            }
+            ep.colBias = x->colBias >= 0 ? g->node[x->colBias].buf : NULL;
+            ep.rowBias = x->rowBias >= 0 ? g->node[x->rowBias].buf : NULL;
+            gemmEx(x->transA, x->transB, x->row, x->col, x->transA ? a->row : a->col,
+                   a->buf, a->col, b->buf, b->col, x->buf, x->col, &ep);
+            break;
+        case LAZY_INV:
+            inv(a->buf, a->row, a->col, x->buf, x->row, x->col);
+            break;
+        case LAZY_T:
+            transposeEx(a->row, a->col, a->buf, a->col, x->buf, x->col);
+            break;
+        case LAZY_EW:
+            c.g = g; c.x = x;
+            c.nb = (x->col+LAZY_BLOCK-1)/LAZY_BLOCK;
+            nt = x->row*c.nb;
+            if (x->row*x->col < LAZY_PAR_MIN) _lazyEwRange(&c, 0, nt);
+            else slach_parallel_for(nt, MAX(1, LAZY_BLOCK/MIN(x->col, LAZY_BLOCK)), _lazyEwRange, &c);
+            break;
+        default:
+            break;
+    }
+}
+
+/** \brief nodes [i0, i1) of one level, thread pool body, private function
+ *
+ * \param arg: LazyCtx*
+ * \param i0, i1
+ * \return
+ *
+ */
+
+void _lazyLevelRange(void* arg, size_t i0, size_t i1){
+    LazyCtx* c = (LazyCtx*)arg;
+    size_t i;
+    for (i=i0; i<i1; i++) _lazyRun(c->g, c->ids[i]);
+}
+
+/** \brief evaluate the graph: fuse (first time only), plan the buffers, run level by level
+ *
+ * \param g
+ * \return size_t, floats allocated for intermediates
+ *
+ */
+
+size_t slach_eval(SlachGraph* g){
+    LazyNode* x;
+    size_t i, k, nSlot = 0, total = 0, need, cnt;
+    size_t* size;
+    int* owner;
+    int* left;
+    int* ids;
+    float** mem;
+    int r, s, best, level, maxLevel = 0;
+    LazyCtx c;
+    if (g == NULL){
+        perr("In slach_eval(), g is NULL!\n");
+    }
+    if (!g->evaluated) _lazyFuse(g);
+    g->evaluated = 1;
+    //levels and remaining uses
+    left = slach_malloc(int, g->n+1);
+    ids = slach_malloc(int, g->n+1);
+    for (i=0; i<g->n; i++){
+        x = g->node+i;
+        x->level = 0; x->slot = -1;
+        x->buf = x->kind == LAZY_INPUT ? x->data : x->dest;
+        if (x->kind == LAZY_DEAD) continue;
+        for (k=0; k<_lazyNRefs(x); k++){
+            if ((r = _lazyRef(x, k)) < 0) continue;
+            x->level = MAX(x->level, g->node[r].level+1);
+            left[r]++;
+        }
+        if (x->kind == LAZY_INPUT && x->dest != NULL) x->level = 1;
+        maxLevel = MAX(maxLevel, x->level);
+    }
+    //buffer plan: a level takes its buffers, then frees those of operands it used last
+    size = slach_malloc(size_t, g->n+1);
+    owner = slach_malloc(int, g->n+1);
+    for (level=1; level<=maxLevel; level++){
+        for (i=0; i<g->n; i++){
+            x = g->node+i;
+            if (x->level != level || x->kind == LAZY_DEAD || x->buf != NULL) continue;
+            need = x->row*x->col;
+            r = x->kind == LAZY_EW ? x->step[0].arg : x->kind == LAZY_MUL ? x->c : -1;
+            if (r >= 0 && g->node[r].slot >= 0 && owner[g->node[r].slot] == r && left[r] == 1 &&
+                g->node[r].row == x->row && g->node[r].col == x->col){
+                x->slot = g->node[r].slot;
+                owner[x->slot] = (int)i;
+                continue;
+            }
+            //smallest free buffer that fits, else the largest free one, grown
+            best = -1;
+            for (s=0; s<(int)nSlot; s++){
+                if (owner[s] >= 0) continue;
+                if (best < 0) best = s;
+                else if (size[s] >= need){
+                    if (size[best] < need || size[s] < size[best]) best = s;
+                }
+                else if (size[best] < need && size[s] > size[best]) best = s;
+            }
+            if (best < 0) best = (int)nSlot++;
+            size[best] = MAX(size[best], need);
+            owner[best] = (int)i;
+            x->slot = best;
+        }
+        for (i=0; i<g->n; i++){
+            x = g->node+i;
+            if (x->level != level || x->kind == LAZY_DEAD) continue;
+            for (k=0; k<_lazyNRefs(x); k++){
+                if ((r = _lazyRef(x, k)) < 0) continue;
+                if (--left[r] == 0 && g->node[r].slot >= 0 && owner[g->node[r].slot] == r){
+                    owner[g->node[r].slot] = -1;
+                }
+            }
+        }
+    }
+    mem = slach_malloc(float*, nSlot+1);
+    for (s=0; s<(int)nSlot; s++){
+        mem[s] = slach_malloc(float, size[s]);
+        total += size[s];
+    }
+    for (i=0; i<g->n; i++){
+        if (g->node[i].slot >= 0) g->node[i].buf = mem[g->node[i].slot];
+    }
+    //run: the nodes of a level are independent
+    c.g = g; c.ids = ids;
+    for (level=1; level<=maxLevel; level++){
+        for (i=0, cnt=0; i<g->n; i++){
+            if (g->node[i].level == level && g->node[i].kind != LAZY_DEAD) ids[cnt++] = (int)i;
+        }
+        slach_parallel_for(cnt, 1, _lazyLevelRange, &c);
+    }
+    for (s=0; s<(int)nSlot; s++) slach_free(mem[s]);
+    slach_free(mem); slach_free(size); slach_free(owner); slach_free(left); slach_free(ids);
+    return total;
+}
@@ -0,0 +1,203 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/map.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+
+/*
+MAP_BLOCK elements of input and output (2 x 16KB) stay in L1 while a block is processed.
+Arrays shorter than MAP_PAR_MIN are mapped on the calling thread: below that the pool
+wake-up costs more than cheap callbacks save.
+*/
+#define MAP_BLOCK 4096
+#define MAP_PAR_MIN (slach_tune()->mapParMin) //tunable, see tune.h
+
+/** \brief arguments of a map job
+ *
+ * \param x, y (NULL for unary maps), dest, len
+ * \param fn: callback, the member in use is told apart by vec and y
+ * \param vec: whether fn is a block callback
+ * \param ctx: user context
+ * \return
+ *
+ */
+
+typedef struct _MapCtx_{
+    float* x;
+    float* y;
+    float* dest;
+    size_t len;
+    union{
+        mapFn f1;
+        map2Fn f2;
+        mapVecFn v1;
+        map2VecFn v2;
+    }fn;
+    int vec;
+    void* ctx;
+}MapCtx;
+
+/** \brief map blocks [b0, b1), thread pool body, private function
+ *
+ * \param arg: MapCtx*
+ * \param b0, b1: block range
+ * \return
+ *
+ */
+
+void _mapRange(void* arg, size_t b0, size_t b1){
+    MapCtx* c = (MapCtx*)arg;
+    size_t lo = b0*MAP_BLOCK;
+    size_t hi = MIN(c->len, b1*MAP_BLOCK);
+    size_t i, n;
+    if (c->vec){
+        for (i=lo; i<hi; i+=n){
+            n = MIN(MAP_BLOCK, hi-i);
+            if (c->y == NULL){
+                c->fn.v1(c->x+i, c->dest+i, n, c->ctx);
+            }
+            else{
+                c->fn.v2(c->x+i, c->y+i, c->dest+i, n, c->ctx);
+            }
+        }
+    }
+    else if (c->y == NULL){
+        for (i=lo; i<hi; i++){
+            c->dest[i] = c->fn.f1(c->x[i], c->ctx);
+        }
+    }
+    else{
+        for (i=lo; i<hi; i++){
+            c->dest[i] = c->fn.f2(c->x[i], c->y[i], c->ctx);
+        }
+    }
+}
+
+/** \brief check arguments and run a map job, private function
+ *
+ * \param c: MapCtx*
+ * \return
+ *
+ */
+
+void _map(MapCtx* c){
+    size_t nb;
+    if (c->len == 0) return;
+    nb = (c->len+MAP_BLOCK-1)/MAP_BLOCK;
+    if (c->len < MAP_PAR_MIN){
+        _mapRange(c, 0, nb);
+    }
+    else{
+        slach_parallel_for(nb, 1, _mapRange, c);
+    }
+}
+
+/** \brief dest[i] = fn(x[i], ctx)
+ *
+ * \param 1-dim array x, dest (may be x), len
+ * \param fn, ctx
+ * \return
+ *
+ */
+
+void slach_map(IN float* x, OUT float* dest, size_t len, mapFn fn, void* ctx){
+    MapCtx c;
+    if (fn == NULL){
+        perr("In slach_map(), fn is NULL!\n");
+    }
+    c.x = x; c.y = NULL; c.dest = dest; c.len = len;
+    c.fn.f1 = fn; c.vec = 0; c.ctx = ctx;
+    _map(&c);
+}
+
+/** \brief dest[i] = fn(x[i], y[i], ctx)
+ *
+ * \param 1-dim array x, y, dest (may be x or y), len
+ * \param fn, ctx
+ * \return
+ *
+ */
+
+void slach_map2(IN float* x, IN float* y, OUT float* dest, size_t len, map2Fn fn, void* ctx){
+    MapCtx c;
+    if (y == NULL || fn == NULL){
+        perr("In slach_map2(), y or fn is NULL!\n");
+    }
+    c.x = x; c.y = y; c.dest = dest; c.len = len;
+    c.fn.f2 = fn; c.vec = 0; c.ctx = ctx;
+    _map(&c);
+}
+
+/** \brief fn(x+i, dest+i, n, ctx) on consecutive blocks
+ *
+ * \param 1-dim array x, dest (may be x), len
+ * \param fn, ctx
+ * \return
+ *
+ */
+
+void slach_map_vec(IN float* x, OUT float* dest, size_t len, mapVecFn fn, void* ctx){
+    MapCtx c;
+    if (fn == NULL){
+        perr("In slach_map_vec(), fn is NULL!\n");
+    }
+    c.x = x; c.y = NULL; c.dest = dest; c.len = len;
+    c.fn.v1 = fn; c.vec = 1; c.ctx = ctx;
+    _map(&c);
+}
+
+/** \brief fn(x+i, y+i, dest+i, n, ctx) on consecutive blocks
+ *
+ * \param 1-dim array x, y, dest (may be x or y), len
+ * \param fn, ctx
+ * \return
+ *
+ */
+
+void slach_map2_vec(IN float* x, IN float* y, OUT float* dest, size_t len, map2VecFn fn, void* ctx){
+    MapCtx c;
+    if (y == NULL || fn == NULL){
+        perr("In slach_map2_vec(), y or fn is NULL!\n");
+    }
+    c.x = x; c.y = y; c.dest = dest; c.len = len;
+    c.fn.v2 = fn; c.vec = 1; c.ctx = ctx;
+    _map(&c);
+}
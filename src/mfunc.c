@@ -0,0 +1,352 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/mfunc.h"
+#include "../include/GEMM.h"
+#include "../include/LUD.h"
+
+/*
+workspace layout: MFUNC_BUFS buffers of n x n floats. mExp uses all of them (A/2^s, A^2,
+A^4, A^6, and three for the Pade numerator, denominator and squaring), mSqrt five, mPow three.
+*/
+#define MFUNC_BUFS 7
+#define MSQRT_MAXIT 64
+#define MSQRT_TOL 1e-5    //relative 1-norm change of the iterate that counts as converged
+#define MSQRT_STALL 1e-3  //a change that stops shrinking below this is rounding noise
+
+/*
+coefficients b_0 ... b_m of the diagonal Pade approximants and the largest |A|_1 each one
+is accurate for (Higham, The scaling and squaring method for the matrix exponential
+revisited, 2005)
+*/
+static const double mfPade[5][14] = {
+    {120, 60, 12, 1},
+    {30240, 15120, 3360, 420, 30, 1},
+    {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1},
+    {17643225600.0, 8821612800.0, 2075673600, 302702400, 30270240, 2162160, 110880, 3960, 90, 1},
+    {64764752532480000.0, 32382376266240000.0, 7771770303897600.0, 1187353796428800.0,
+     129060195264000.0, 10559470521600.0, 670442572800.0, 33522128640.0, 1323241920,
+     40840800, 960960, 16380, 182, 1}
+};
+static const double mfTheta[5] = {
+    1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+    2.097847961257068e0, 5.371920351148152e0
+};
+
+/** \brief floats of workspace the Ex matrix functions need for an n x n matrix
+ *
+ * \param n
+ * \return size_t
+ *
+ */
+
+size_t mfuncWorkSize(size_t n){
+    return MFUNC_BUFS*n*n;
+}
+
+/** \brief 1-norm (largest absolute column sum) of X, or of X - Y when Y is not NULL,
+ *   private function
+ *
+ * \param n, X, Y
+ * \return double
+ *
+ */
+
+double _mfNorm1(size_t n, float* X, float* Y){
+    double* col = slach_malloc(double, n);
+    double best = 0;
+    size_t i, j;
+    for (i=0; i<n; i++){
+        for (j=0; j<n; j++){
+            col[j] += fabs((double)X[i*n+j] - (Y != NULL ? Y[i*n+j] : 0));
+        }
+    }
+    for (j=0; j<n; j++) best = MAX(best, col[j]);
+    slach_free(col);
+    return best;
+}
+
+/** \brief dest = sum c[j]*X[j] + d*I, private function
+ *
+ * \param n, dest
+ * \param c, X, cnt: terms
+ * \param d: multiple of the identity
+ * \return
+ *
+ */
+
+void _mfComb(size_t n, float* dest, const double* c, float** X, int cnt, double d){
+    size_t i;
+    double s;
+    int j;
+    for (i=0; i<n*n; i++){
+        for (j=0, s=0; j<cnt; j++) s += c[j]*X[j][i];
+        dest[i] = (float)s;
+    }
+    for (i=0; i<n; i++) dest[i*n+i] += (float)d;
+}
+
+/** \brief C = alpha*A*B + beta*C on n x n arrays through gemmEx, private function
+ *
+ * \param n, A, B, C, alpha, beta
+ * \return
+ *
+ */
+
+void _mfGemm(size_t n, float* A, float* B, float* C, float alpha, float beta){
+    GemmEpilogue ep;
+    gemmEpilogueInit(&ep);
+    ep.alpha = alpha; ep.beta = beta;
+    gemmEx(0, 0, n, n, n, A, n, B, n, C, n, &ep);
+}
+
+/** \brief matrix exponential by scaling and squaring of a Pade approximant
+ *
+ * \param n: order
+ * \param A: n x n array
+ * \param dest: n x n array to save exp(A), may be A
+ * \param work: mfuncWorkSize(n) floats or NULL
+ * \return
+ *
+ */
+
+void mExpEx(size_t n, IN float* A, OUT float* dest, float* work){
+    float* w;
+    float *As, *P[4], *T, *U, *V, *X, *Y, *S;
+    double c[4], norm;
+    const double* b;
+    size_t i, n2 = n*n;
+    int k, m, s = 0, terms;
+    if (n == 0 || A == NULL || dest == NULL){
+        perr("In mExpEx(), n is 0 or an array is NULL!\n");
+    }
+    w = work != NULL ? work : slach_malloc(float, mfuncWorkSize(n));
+    As = w; P[0] = w+n2; P[1] = w+2*n2; P[2] = w+3*n2; T = w+4*n2; U = w+5*n2; V = w+6*n2;
+    //the lowest degree accurate for |A|_1, else degree 13 on A/2^s
+    norm = _mfNorm1(n, A, NULL);
+    for (k=0; k<4 && norm > mfTheta[k]; k++);
+    m = k == 4 ? 13 : 2*k+3;
+    b = mfPade[k];
+    if (k == 4 && norm > mfTheta[4]) s = (int)ceil(log2(norm/mfTheta[4]));
+    for (i=0; i<n2; i++) As[i] = (float)ldexp(A[i], -s);
+    //even powers A^2, A^4, A^6
+    _mfGemm(n, As, As, P[0], 1, 0);
+    if (m >= 5) _mfGemm(n, P[0], P[0], P[1], 1, 0);
+    if (m >= 7) _mfGemm(n, P[1], P[0], P[2], 1, 0);
+    if (m == 13){
+        //U = A*(A^6*(b13 A^6 + b11 A^4 + b9 A^2) + b7 A^6 + b5 A^4 + b3 A^2 + b1 I), into T
+        c[0] = b[9]; c[1] = b[11]; c[2] = b[13];
+        _mfComb(n, T, c, P, 3, 0);
+        c[0] = b[3]; c[1] = b[5]; c[2] = b[7];
+        _mfComb(n, U, c, P, 3, b[1]);
+        _mfGemm(n, P[2], T, U, 1, 1);
+        _mfGemm(n, As, U, T, 1, 0);
+        //V = A^6*(b12 A^6 + b10 A^4 + b8 A^2) + b6 A^6 + b4 A^4 + b2 A^2 + b0 I
+        c[0] = b[8]; c[1] = b[10]; c[2] = b[12];
+        _mfComb(n, U, c, P, 3, 0);
+        c[0] = b[2]; c[1] = b[4]; c[2] = b[6];
+        _mfComb(n, V, c, P, 3, b[0]);
+        _mfGemm(n, P[2], U, V, 1, 1);
+    }
+    else{
+        //U = A*(b1 I + b3 A^2 + ...), V = b0 I + b2 A^2 + ...; A^8 lives in T until U is formed
+        terms = m/2;
+        if (m == 9){
+            P[3] = T;
+            _mfGemm(n, P[1], P[1], P[3], 1, 0);
+        }
+        for (k=0; k<terms; k++) c[k] = b[2*k+3];
+        _mfComb(n, U, c, P, terms, b[1]);
+        for (k=0; k<terms; k++) c[k] = b[2*k+2];
+        _mfComb(n, V, c, P, terms, b[0]);
+        _mfGemm(n, As, U, T, 1, 0);
+    }
+    //(V - U) X = V + U, then square s times, landing in dest
+    for (i=0; i<n2; i++){
+        U[i] = V[i]-T[i];
+        V[i] = V[i]+T[i];
+    }
+    X = s%2 == 0 ? dest : T;
+    Y = s%2 == 0 ? T : dest;
+    LUsolvem(U, n, n, V, n, n, X, n, n);
+    for (k=0; k<s; k++){
+        _mfGemm(n, X, X, Y, 1, 0);
+        S = X; X = Y; Y = S;
+    }
+    if (work == NULL) slach_free(w);
+}
+
+/** \brief integer power of a matrix by repeated squaring
+ *
+ * \param n: order
+ * \param A: n x n array
+ * \param p: exponent, negative powers use the inverse of A
+ * \param dest: n x n array to save A^p, may be A
+ * \param work: mfuncWorkSize(n) floats or NULL
+ * \return
+ *
+ */
+
+void mPowEx(size_t n, IN float* A, int p, OUT float* dest, float* work){
+    float* w;
+    float *B, *R, *S, *tmp;
+    unsigned e = p < 0 ? 0u-(unsigned)p : (unsigned)p;
+    size_t i, n2 = n*n;
+    int have = 0;
+    if (n == 0 || A == NULL || dest == NULL){
+        perr("In mPowEx(), n is 0 or an array is NULL!\n");
+    }
+    if (e == 0){
+        memset(dest, 0, n2*sizeof(float));
+        for (i=0; i<n; i++) dest[i*n+i] = 1;
+        return;
+    }
+    w = work != NULL ? work : slach_malloc(float, mfuncWorkSize(n));
+    B = w; R = w+n2; S = w+2*n2;
+    if (p < 0) inv(A, n, n, B, n, n);
+    else memcpy(B, A, n2*sizeof(float));
+    //R collects the squares B^(2^i) of the set bits of e
+    for (;;){
+        if (e & 1){
+            if (!have) memcpy(R, B, n2*sizeof(float));
+            else{
+                _mfGemm(n, R, B, S, 1, 0);
+                tmp = R; R = S; S = tmp;
+            }
+            have = 1;
+        }
+        e >>= 1;
+        if (e == 0) break;
+        _mfGemm(n, B, B, S, 1, 0);
+        tmp = B; B = S; S = tmp;
+    }
+    memcpy(dest, R, n2*sizeof(float));
+    if (work == NULL) slach_free(w);
+}
+
+/** \brief principal square root by the product form of the Denman-Beavers iteration:
+ *   M_0 = Y_0 = A, Y_{k+1} = Y_k (I + M_k^-1)/2, M_{k+1} = (I + (M_k + M_k^-1)/2)/2, Y -> A^(1/2)
+ *
+ * \param n: order
+ * \param A: n x n array
+ * \param dest: n x n array to save the square root, may be A
+ * \param work: mfuncWorkSize(n) floats or NULL
+ * \return
+ *
+ */
+
+void mSqrtEx(size_t n, IN float* A, OUT float* dest, float* work){
+    float* w;
+    float *M, *Y, *Mi, *T, *Yn, *tmp;
+    double diff, prev = HUGE_VAL, nrm;
+    size_t i, n2 = n*n;
+    int it, done = 0;
+    if (n == 0 || A == NULL || dest == NULL){
+        perr("In mSqrtEx(), n is 0 or an array is NULL!\n");
+    }
+    w = work != NULL ? work : slach_malloc(float, mfuncWorkSize(n));
+    M = w; Y = w+n2; Mi = w+2*n2; T = w+3*n2; Yn = w+4*n2;
+    memcpy(M, A, n2*sizeof(float));
+    memcpy(Y, A, n2*sizeof(float));
+    for (it=0; it<MSQRT_MAXIT && !done; it++){
+        inv(M, n, n, Mi, n, n);
+        for (i=0; i<n2; i++) T[i] = 0.5f*Mi[i];
+        for (i=0; i<n; i++) T[i*n+i] += 0.5f;
+        _mfGemm(n, Y, T, Yn, 1, 0);
+        for (i=0; i<n2; i++) M[i] = 0.25f*(M[i]+Mi[i]);
+        for (i=0; i<n; i++) M[i*n+i] += 0.5f;
+        diff = _mfNorm1(n, Yn, Y);
+        nrm = _mfNorm1(n, Yn, NULL);
+        tmp = Y; Y = Yn; Yn = tmp;
+        done = diff <= MSQRT_TOL*nrm || (diff >= prev && diff <= MSQRT_STALL*nrm);
+        prev = diff;
+    }
+    if (!done){
+        perr("In mSqrtEx(), no convergence: A has an eigenvalue on the negative real axis or is singular!\n");
+    }
+    memcpy(dest, Y, n2*sizeof(float));
+    if (work == NULL) slach_free(w);
+}
+
+/** \brief interface of the matrix exponential exp(A), see mExpEx
+ *
+ * \param 2-dim array, row, col
+ * \param 2-dim array to save result, row, col
+ * \return
+ *
+ */
+
+void mExp(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
+    if (row != col || height != row || width != col){
+        perr("In mExp(), the matrix is not square or dest is mismatched!\n");
+    }
+    mExpEx(row, arr, dest, NULL);
+}
+
+/** \brief interface of the matrix power A^p, see mPowEx
+ *
+ * \param 2-dim array, row, col
+ * \param p: exponent
+ * \param 2-dim array to save result, row, col
+ * \return
+ *
+ */
+
+void mPow(INOUT float* arr, size_t row, size_t col, int p, OUT float* dest, size_t height, size_t width){
+    if (row != col || height != row || width != col){
+        perr("In mPow(), the matrix is not square or dest is mismatched!\n");
+    }
+    mPowEx(row, arr, p, dest, NULL);
+}
+
+/** \brief interface of the principal matrix square root, see mSqrtEx
+ *
+ * \param 2-dim array, row, col
+ * \param 2-dim array to save result, row, col
+ * \return
+ *
+ */
+
+void mSqrt(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
+    if (row != col || height != row || width != col){
+        perr("In mSqrt(), the matrix is not square or dest is mismatched!\n");
+    }
+    mSqrtEx(row, arr, dest, NULL);
+}
@@ -0,0 +1,272 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/ooc.h"
+#include "../include/async.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+one tile of a mapped matrix and the buffer it is copied to
+*/
+typedef struct _OocTile_{
+    float* src;       //mapped matrix
+    size_t ld;        //its columns
+    size_t r0, rows, c0, cols;
+    float* dst;       //rows x cols, packed
+}OocTile;
+
+typedef struct _OocLoad_{
+    OocTile a;
+    OocTile b;
+}OocLoad;
+
+/** \brief edge of the square tiles oocGemmEx uses: one C tile and two A and two B tiles fit
+ *   the budget
+ *
+ * \param budget: bytes
+ * \return size_t
+ *
+ */
+
+size_t oocTileSize(size_t budget){
+    size_t t = (size_t)sqrt((double)budget/(5*sizeof(float)));
+    if (t == 0) perr("In oocTileSize(), the memory budget is too small!\n");
+    return t >= 64 ? t & ~(size_t)15 : t;
+}
+
+/** \brief maps a matrix file, private function
+ *
+ * \param path
+ * \param bytes: size the file must have
+ * \param writable: 1 opens read-write and creates or extends the file
+ * \return float*
+ *
+ */
+
+float* _oocMap(const char* path, size_t bytes, int writable){
+    struct stat st;
+    char msg[256];
+    void* p;
+    int fd = open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0 || fstat(fd, &st) != 0){
+        snprintf(msg, sizeof(msg), "In oocGemmEx(), can't open %s!\n", path);
+        perr(msg);
+    }
+    if ((size_t)st.st_size < bytes){
+        if (!writable || ftruncate(fd, (off_t)bytes) != 0){
+            snprintf(msg, sizeof(msg), "In oocGemmEx(), %s is smaller than the matrix!\n", path);
+            perr(msg);
+        }
+    }
+    p = mmap(NULL, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED){
+        snprintf(msg, sizeof(msg), "In oocGemmEx(), can't map %s!\n", path);
+        perr(msg);
+    }
+    return (float*)p;
+}
+
+/** \brief copies a tile out of its mapping, private function
+ *
+ *   Every row segment is first announced with MADV_WILLNEED, so the kernel reads them all in
+ *   parallel instead of faulting them in one by one during the copy.
+ *
+ * \param t
+ * \return
+ *
+ */
+
+void _oocCopy(OocTile* t){
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t i, a;
+    for (i=0; i<t->rows; i++){
+        a = (size_t)(t->src + (t->r0 + i)*t->ld + t->c0);
+        madvise((void*)(a & ~(page-1)), a - (a & ~(page-1)) + t->cols*sizeof(float), MADV_WILLNEED);
+    }
+    for (i=0; i<t->rows; i++) memcpy(t->dst + i*t->cols, t->src + (t->r0 + i)*t->ld + t->c0, t->cols*sizeof(float));
+}
+
+/** \brief loads the A and B tiles of one step, task body, private function
+ *
+ * \param arg: OocLoad*
+ * \return
+ *
+ */
+
+void _oocLoadFn(void* arg){
+    OocLoad* l = (OocLoad*)arg;
+    _oocCopy(&l->a);
+    _oocCopy(&l->b);
+}
+
+/** \brief C = epilogue(beta*C) tile by tile, the k == 0 case of oocGemmEx, private function
+ *
+ * \param mapC: mapped C, m x n
+ * \param m, n
+ * \param mt, nt: tile edges
+ * \param ep: epilogue
+ * \param tileC: mt x nt floats
+ * \return
+ *
+ */
+
+void _oocScaleC(float* mapC, size_t m, size_t n, size_t mt, size_t nt, const GemmEpilogue* ep, float* tileC){
+    GemmEpilogue e;
+    size_t i0, j0, mi, nw, r;
+    for (i0=0; i0<m; i0+=mt){
+        for (j0=0; j0<n; j0+=nt){
+            mi = MIN(mt, m - i0); nw = MIN(nt, n - j0);
+            if (ep->beta != 0){
+                for (r=0; r<mi; r++) memcpy(tileC + r*nw, mapC + (i0 + r)*n + j0, nw*sizeof(float));
+            }
+            e = *ep;
+            if (e.colBias != NULL) e.colBias += i0;
+            if (e.rowBias != NULL) e.rowBias += j0;
+            gemmEx(0, 0, mi, nw, 0, NULL, 0, NULL, nw, tileC, nw, &e);
+            for (r=0; r<mi; r++) memcpy(mapC + (i0 + r)*n + j0, tileC + r*nw, nw*sizeof(float));
+        }
+    }
+}
+
+/** \brief C = epilogue(alpha*A*B + beta*C) on matrix files, tile by tile
+ *
+ *   Steps run over C tiles and, inside one, over the tiles of k; the loads of step s+1 are
+ *   submitted before the product of step s and waited for after it.
+ *
+ * \param fileA, fileB, fileC: raw row-major floats, m x k, k x n and m x n
+ * \param m, n, k: with k == 0, A and B are not read and C = epilogue(beta*C), as in gemmEx
+ * \param budget: bytes for the tiles, see oocTileSize
+ * \param ep: epilogue or NULL, bias arrays are in memory (m and n entries)
+ * \return
+ *
+ */
+
+void oocGemmEx(const char* fileA, const char* fileB, const char* fileC, size_t m, size_t n, size_t k,
+               size_t budget, IN const GemmEpilogue* ep){
+    GemmEpilogue base, e;
+    OocLoad load[2];
+    SlachTask* task;
+    float* mapA;
+    float* mapB;
+    float* mapC;
+    float* buf[4];
+    float* tileC;
+    size_t t, mt, nt, kt, ni, nj, np, s, steps, i0, j0, p0, mi, nw, r;
+    int cur;
+    if (fileA == NULL || fileB == NULL || fileC == NULL) perr("In oocGemmEx(), file names can't be NULL!\n");
+    if (m == 0 || n == 0) return;
+    if (ep != NULL) base = *ep;
+    else gemmEpilogueInit(&base);
+    t = oocTileSize(budget);
+    mt = MIN(m, t); nt = MIN(n, t);
+    if (k == 0){
+        mapC = _oocMap(fileC, m*n*sizeof(float), 1);
+        tileC = slach_malloc(float, mt*nt);
+        _oocScaleC(mapC, m, n, mt, nt, &base, tileC);
+        msync(mapC, m*n*sizeof(float), MS_SYNC);
+        munmap(mapC, m*n*sizeof(float));
+        slach_free(tileC);
+        return;
+    }
+    kt = MIN(k, t);
+    ni = (m + mt - 1)/mt; nj = (n + nt - 1)/nt; np = (k + kt - 1)/kt;
+    mapA = _oocMap(fileA, m*k*sizeof(float), 0);
+    mapB = _oocMap(fileB, k*n*sizeof(float), 0);
+    mapC = _oocMap(fileC, m*n*sizeof(float), 1);
+    buf[0] = slach_malloc(float, mt*kt); buf[1] = slach_malloc(float, mt*kt);
+    buf[2] = slach_malloc(float, kt*nt); buf[3] = slach_malloc(float, kt*nt);
+    tileC = slach_malloc(float, mt*nt);
+    steps = ni*nj*np;
+    for (s=0; s<=steps; s++){
+        //describe the loads of step s into the buffers of s&1
+        if (s < steps){
+            cur = (int)(s & 1);
+            i0 = (s/(nj*np))*mt; j0 = ((s/np)%nj)*nt; p0 = (s%np)*kt;
+            load[cur].a.src = mapA; load[cur].a.ld = k;
+            load[cur].a.r0 = i0; load[cur].a.rows = MIN(mt, m - i0);
+            load[cur].a.c0 = p0; load[cur].a.cols = MIN(kt, k - p0);
+            load[cur].a.dst = buf[cur];
+            load[cur].b.src = mapB; load[cur].b.ld = n;
+            load[cur].b.r0 = p0; load[cur].b.rows = MIN(kt, k - p0);
+            load[cur].b.c0 = j0; load[cur].b.cols = MIN(nt, n - j0);
+            load[cur].b.dst = buf[2 + cur];
+        }
+        if (s == 0){
+            _oocLoadFn(&load[0]);
+            continue;
+        }
+        //step s-1 computes while step s loads
+        task = s < steps ? slach_submit(_oocLoadFn, &load[s & 1], NULL, 0) : NULL;
+        cur = (int)((s-1) & 1);
+        i0 = load[cur].a.r0; mi = load[cur].a.rows;
+        j0 = load[cur].b.c0; nw = load[cur].b.cols;
+        p0 = load[cur].a.c0;
+        if (p0 == 0 && base.beta != 0){
+            for (r=0; r<mi; r++) memcpy(tileC + r*nw, mapC + (i0 + r)*n + j0, nw*sizeof(float));
+        }
+        e = base;
+        if (p0 > 0) e.beta = 1;
+        if (p0 + kt < k){
+            e.colBias = NULL; e.rowBias = NULL; e.op = EW_NONE;
+        }
+        else{
+            if (e.colBias != NULL) e.colBias += i0;
+            if (e.rowBias != NULL) e.rowBias += j0;
+        }
+        gemmEx(0, 0, mi, nw, load[cur].a.cols, buf[cur], load[cur].a.cols, buf[2 + cur], nw, tileC, nw, &e);
+        if (p0 + kt >= k){
+            for (r=0; r<mi; r++) memcpy(mapC + (i0 + r)*n + j0, tileC + r*nw, nw*sizeof(float));
+        }
+        if (task != NULL){
+            slach_wait(task);
+            slach_release(task);
+        }
+    }
+    msync(mapC, m*n*sizeof(float), MS_SYNC);
+    munmap(mapA, m*k*sizeof(float));
+    munmap(mapB, k*n*sizeof(float));
+    munmap(mapC, m*n*sizeof(float));
+    slach_free(buf[0]); slach_free(buf[1]); slach_free(buf[2]); slach_free(buf[3]);
+    slach_free(tileC);
+}
@@ -39,166 +39,304 @@ limitations under the License.
 */
 
 #include "../include/operation.h"
+#include "../include/GEMM.h"
+#include "../include/GEMV.h"
+#include "../include/reduce.h"
+#include "../include/map.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+#include "simd.h"
 
 /**< Matrix operations */
-/** \brief matrix*matrix, private function
+/** \brief interface of matrix*matrix, runs on the blocked GEMM engine
  *
  * \param 2-dim array, row, col
  * \param 2-dim array, row, col
- * \return Matrix*
+ * \param 2-dim array to save result, row, col
+ * \return
  *
  */
 
-Matrix* _mmMul(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2){
-    Matrix* m1;
-    Matrix* m2;
-    Matrix* result;
-    size_t i,j,k;
-    float sum;
+void mmMul(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+                                                        OUT float* dest, size_t height, size_t width){
     if (col1 != row2){
         perr("In mmMul(), col1 != row2!\n");
     }
-
     if (col1<=1 || row1<=1 || col2<=1 || row2<=1){
         perr("In mmMul(), col or row has problems!\n");
     }
+    mmMulEx(arr1, row1, col1, arr2, row2, col2, NULL, dest, height, width);
+}
+/** \brief interface of matrix*vector OR vector*matrix, runs on the GEMV kernels
+ *
+ * \param 2-dim array, row, col OR 1-dim array, 1, col
+ * \param 1-dim array, row, 1 OR 2-dim array, row, col
+ * \param 1-dim array to save result, len (row1 for matrix*vector, col2 for vector*matrix)
+ * \return
+ *
+ */
 
-    else{
-        m1 = createMatrix(row1, col1);
-        m2 = createMatrix(row2, col2);
-        result = createMatrix(row1, col2);
-        arrayToMatrix(arr1, m1, row1, col1);
-        arrayToMatrix(arr2, m2, row2, col2);
-
-        for (i = 0; i<row1; i++){
-            for (j = 0; j<col2; j++){
-                sum = 0;
-                for (k = 0; k<row2; k++){
-                    sum += m1->mData[i][k]*m2->mData[k][j];
-                }
-                result->mData[i][j] = sum;
-            }
+void mvMul(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+                                                        OUT float* dest, size_t len){
+    float* out = dest;
+    int isRow;
+    if (col1 != row2){
+        perr("In mvMul(), col1 != row2!\n");
+    }
+    if ((col1 > 1 && row1>1) && (col2 == 1 && row2 > 1)){
+        isRow = 0;
+        if (len != row1){
+            perr("In mvMul(), len != row1!\n");
+        }
+    }
+    else if ((col1 > 1 && row1 == 1) && (col2 >1 || row2 > 1)){
+        isRow = 1;
+        if (len != col2){
+            perr("In mvMul(), len != col2!\n");
         }
-        destroyMatrix(m1);destroyMatrix(m2);
-        return result;
+    }
+    else{
+        perr("In mvMul(), auguments are illegal!\n");
+        return;
+    }
+    //the kernels write y while still reading A and x
+    if ((dest < arr1+row1*col1 && arr1 < dest+len) || (dest < arr2+row2*col2 && arr2 < dest+len)){
+        out = slach_malloc(float, len);
+    }
+    if (isRow){
+        gemvEx(1, row2, col2, 1, arr2, col2, arr1, 0, out);
+    }
+    else{
+        gemvEx(0, row1, col1, 1, arr1, col1, arr2, 0, out);
+    }
+    if (out != dest){
+        memcpy(dest, out, len*sizeof(float));
+        slach_free(out);
     }
 }
-/** \brief interface of matrix*matrix
+
+/*
+binary element-wise operations with NumPy-style broadcasting. The output is cut into
+tiles of one row by at most EWB_BLOCK columns that are spread over the thread pool; an
+operand broadcast along a row (one column) is splatted into a small buffer so that every
+inner loop runs on contiguous arrays.
+*/
+#define EWB_BLOCK 4096
+#define EWB_CHUNK 256
+#define EWB_PAR_MIN (slach_tune()->parMin) //tunable, see tune.h
+#define EWB_FMA (-1)
+
+/** \brief arguments of a binary element-wise job
  *
- * \param 2-dim array, row, col
- * \param 2-dim array, row, col
- * \param 2-dim array to save result, row, col
+ * \param op: EwBinOp or EWB_FMA, nIn: 2 or 3 operands
+ * \param in, rs, cs: operands and their row/col strides (0 along a broadcast axis)
+ * \param dest, height, width, nb: output and column blocks per row
  * \return
  *
  */
 
-void mmMul(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
-                                                        OUT float* dest, size_t height, size_t width){
+typedef struct _EwBinCtx_{
+    int op;
+    int nIn;
+    float* in[3];
+    size_t rs[3];
+    size_t cs[3];
+    float* dest;
+    size_t height;
+    size_t width;
+    size_t nb;
+}EwBinCtx;
+
+/** \brief d = op(x, y) on contiguous arrays, private function
+ *
+ * \param op: EwBinOp, x, y, d (may be x or y), n
+ * \return
+ *
+ */
 
-    matrixToArray(_mmMul(arr1, row1, col1, arr2, row2, col2), dest, height, width);
+void _ewBinKernel(int op, float* x, float* y, float* d, size_t n){
+    size_t i = 0;
+    vfloat a, b;
+    for (; i+SLACH_VLEN<=n; i+=SLACH_VLEN){
+        a = vfLoad(x+i);
+        b = vfLoad(y+i);
+        switch (op){
+            case EW_ADD: a = vfAdd(a, b); break;
+            case EW_SUB: a = vfSub(a, b); break;
+            case EW_MUL: a = vfMul(a, b); break;
+            case EW_DIV: a = vfDiv(a, b); break;
+            case EW_MIN: a = vfMin(a, b); break;
+            default:     a = vfMax(a, b); break;
+        }
+        vfStore(d+i, a);
+    }
+    for (; i<n; i++){
+        switch (op){
+            case EW_ADD: d[i] = x[i]+y[i]; break;
+            case EW_SUB: d[i] = x[i]-y[i]; break;
+            case EW_MUL: d[i] = x[i]*y[i]; break;
+            case EW_DIV: d[i] = x[i]/y[i]; break;
+            case EW_MIN: d[i] = MIN(x[i], y[i]); break;
+            default:     d[i] = MAX(x[i], y[i]); break;
+        }
+    }
 }
-/** \brief matrix*vector OR vector*matrix, private function
+
+/** \brief d = x*y + z on contiguous arrays, private function
  *
- * \param 2-dim array, row, col OR 1-dim array, row, 1
- * \param 1-dim array, 1, col OR 2-dim array, row, col
- * \return Vector*
+ * \param x, y, z, d (may be any input), n
+ * \return
  *
  */
 
-Vector* _mvMul(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2){
-    Matrix* m;
-    Vector* v;
-    Vector* result;
-    size_t i,k;
-    float sum;
-    if (col1 != row2){
-        perr("In mvMul(), col1 != row2!\n");
+void _ewFmaKernel(float* x, float* y, float* z, float* d, size_t n){
+    size_t i;
+    if (slach_get_reproducible()){
+        //vfFmadd is a separate multiply and add on SSE, fmaf rounds once on every build
+        for (i=0; i<n; i++){
+            d[i] = fmaf(x[i], y[i], z[i]);
+        }
+        return;
     }
+    for (i=0; i+SLACH_VLEN<=n; i+=SLACH_VLEN){
+        vfStore(d+i, vfFmadd(vfLoad(x+i), vfLoad(y+i), vfLoad(z+i)));
+    }
+    for (; i<n; i++){
+        d[i] = x[i]*y[i] + z[i];
+    }
+}
 
-    if ((col1 > 1 && row1>1) && (col2 == 1 && row2 > 1)){
-        m = createMatrix(row1, col1);
-        v = createVector(row2);
-        result = createVector(row1);
-        arrayToMatrix(arr1, m, row1, col1);
-        arrayToVector(arr2, v, row2);
-
-        for (i = 0; i<row1; i++){
-            sum = 0;
-            for (k = 0; k<row2; k++){
-                sum += m->mData[i][k]*v->vData[k];
+/** \brief tiles [t0, t1) of a binary job, thread pool body, private function
+ *
+ * \param arg: EwBinCtx*, t0, t1
+ * \return
+ *
+ */
+
+void _ewBinRange(void* arg, size_t t0, size_t t1){
+    EwBinCtx* c = (EwBinCtx*)arg;
+    float splat[3][EWB_CHUNK];
+    float sv[3];
+    size_t sn[3] = {0, 0, 0};
+    float* p[3];
+    size_t t, i, j, j1, n;
+    int k;
+    for (t=t0; t<t1; t++){
+        i = t/c->nb;
+        j = (t%c->nb)*EWB_BLOCK;
+        j1 = MIN(c->width, j+EWB_BLOCK);
+        for (; j<j1; j+=n){
+            n = MIN(EWB_CHUNK, j1-j);
+            for (k=0; k<c->nIn; k++){
+                p[k] = c->in[k]+i*c->rs[k]+j*c->cs[k];
+                //a value broadcast along the row is splatted once and reused while it does not change,
+                //bit for bit: -0.0 == +0.0 but 1/-0.0 != 1/+0.0
+                if (c->cs[k] == 0){
+                    if (sn[k] < n || memcmp(&sv[k], p[k], sizeof(float)) != 0){
+                        for (sn[k]=0; sn[k]<EWB_CHUNK; sn[k]++) splat[k][sn[k]] = *p[k];
+                        sv[k] = *p[k];
+                    }
+                    p[k] = splat[k];
+                }
+            }
+            if (c->op == EWB_FMA){
+                _ewFmaKernel(p[0], p[1], p[2], c->dest+i*c->width+j, n);
+            }
+            else{
+                _ewBinKernel(c->op, p[0], p[1], c->dest+i*c->width+j, n);
             }
-            result->vData[i] = sum;
         }
-        destroyMatrix(m); destroyVector(v);
-        return result;
     }
+}
 
-    else if ((col1 > 1 && row1 == 1) && (col2 >1 || row2 > 1)){
-        v = createVector(col1);
-        m = createMatrix(row2, col2);
-        result = createVector(col2);
-        arrayToVector(arr1, v, col2);
-        arrayToMatrix(arr2, m, row2, col2);
-
-        for (i = 0; i<row2; i++){
-            sum = 0;
-            for (k = 0; k<col2; k++){
-                sum += v->vData[i]*m->mData[i][k];
-            }
-            result->vData[i] = sum;
+/** \brief check shapes against the output and run a binary job, private function
+ *
+ * \param c: EwBinCtx* with op, nIn, in, dest filled in
+ * \param rows, cols: shapes of the operands
+ * \param height, width: shape of dest
+ * \return
+ *
+ */
+
+void _ewBinary(EwBinCtx* c, size_t* rows, size_t* cols, size_t height, size_t width){
+    size_t nt;
+    int k;
+    if (height == 0 || width == 0){
+        perr("In ewBinary(), col or row has problems!\n");
+    }
+    for (k=0; k<c->nIn; k++){
+        if ((rows[k] != height && rows[k] != 1) || (cols[k] != width && cols[k] != 1)){
+            perr("In ewBinary(), shapes cannot be broadcast to dest!\n");
         }
-        destroyVector(v); destroyMatrix(m);
-        return result;
+        c->rs[k] = rows[k] == 1 ? 0 : cols[k];
+        c->cs[k] = cols[k] == 1 ? 0 : 1;
+    }
+    c->height = height; c->width = width;
+    c->nb = (width+EWB_BLOCK-1)/EWB_BLOCK;
+    nt = height*c->nb;
+    if (height*width < EWB_PAR_MIN){
+        _ewBinRange(c, 0, nt);
     }
     else{
-        perr("In mvMul(), auguments are illegal!\n");
+        slach_parallel_for(nt, MAX(1, EWB_BLOCK/MIN(width, EWB_BLOCK)), _ewBinRange, c);
     }
 }
-/** \brief interface of matrix*vector OR vector*matrix
+
+/** \brief dest = op(arr1, arr2) with broadcasting: each dimension of an operand
+ *   either matches dest or is 1 (scalar 1x1, row vector 1 x width, column vector height x 1)
  *
- * \param 2-dim array, row, col OR 1-dim array, row, 1
- * \param 1-dim array, 1, col OR 2-dim array, row, col
- * \param 1-dim array to save result, len
+ * \param op: EW_ADD, EW_SUB, EW_MUL, EW_DIV, EW_MIN or EW_MAX
+ * \param 2-dim array, row, col
+ * \param 2-dim array, row, col
+ * \param 2-dim array to save result, row, col (may be an operand of the same shape)
  * \return
  *
  */
 
-void mvMul(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
-                                                        OUT float* dest, size_t len){
-
-    vectorToArray(_mvMul(arr1, row1, col1, arr2, row2, col2), dest, len);
+void ewBinary(EwBinOp op, INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+              OUT float* dest, size_t height, size_t width){
+    EwBinCtx c;
+    size_t rows[2], cols[2];
+    if ((int)op < EW_ADD || op > EW_MAX){
+        perr("In ewBinary(), unknown op!\n");
+    }
+    c.op = op; c.nIn = 2; c.in[0] = arr1; c.in[1] = arr2; c.dest = dest;
+    rows[0] = row1; cols[0] = col1; rows[1] = row2; cols[1] = col2;
+    _ewBinary(&c, rows, cols, height, width);
 }
 
-/** \brief matrix+matrix, private function
+/** \brief dest = op(arr, s) for a scalar s
  *
+ * \param op: EW_ADD, EW_SUB, EW_MUL, EW_DIV, EW_MIN or EW_MAX
  * \param 2-dim array, row, col
- * \param 2-dim array, row, col
- * \return Matrix*
+ * \param s
+ * \param 2-dim array to save result (may be arr), row, col
+ * \return
  *
  */
 
-Matrix* _mmAdd(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2){
-    Matrix* m1;
-    Matrix* m2;
-    Matrix* result;
-    size_t i,j;
-    if (row1 != row2 || col1 != col2){
-        perr("In mmAdd(), col or row is mismatched!\n");
-    }
-    m1 = createMatrix(row1, col1);
-    m2 = createMatrix(row2, col2);
-    result = createMatrix(row1, col1);
-    arrayToMatrix(arr1, m1, row1, col1);
-    arrayToMatrix(arr2, m2, row2, col2);
+void ewBinaryScalar(EwBinOp op, INOUT float* arr, size_t row, size_t col, float s,
+                    OUT float* dest, size_t height, size_t width){
+    ewBinary(op, arr, row, col, &s, 1, 1, dest, height, width);
+}
 
-    for (i=0; i<row1; i++){
-        for (j=0; j<col1; j++){
-            result->mData[i][j] = m1->mData[i][j]+m2->mData[i][j];
-        }
-    }
-    destroyMatrix(m1);destroyMatrix(m2);
-    return result;
+/** \brief dest = arr1*arr2 + arr3 with broadcasting, fused into one pass
+ *
+ * \param 2-dim array, row, col (three operands)
+ * \param 2-dim array to save result, row, col (may be an operand of the same shape)
+ * \return
+ *
+ */
+
+void ewFma(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
+           INOUT float* arr3, size_t row3, size_t col3, OUT float* dest, size_t height, size_t width){
+    EwBinCtx c;
+    size_t rows[3], cols[3];
+    c.op = EWB_FMA; c.nIn = 3; c.in[0] = arr1; c.in[1] = arr2; c.in[2] = arr3; c.dest = dest;
+    rows[0] = row1; cols[0] = col1; rows[1] = row2; cols[1] = col2; rows[2] = row3; cols[2] = col3;
+    _ewBinary(&c, rows, cols, height, width);
 }
+
 /** \brief interface of matrix+matrix
  *
  * \param 2-dim array, row, col
@@ -209,34 +347,13 @@ Matrix* _mmAdd(INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, s
  */
 void mmAdd (INOUT float* arr1, size_t row1, size_t col1, INOUT float* arr2, size_t row2, size_t col2,
                                                         OUT float* dest, size_t height, size_t width){
-    matrixToArray(_mmAdd(arr1, row1, col1, arr2, row2, col2), dest, height, width);
-}
-/** \brief vector+vector, private function
- *
- * \param 1-dim array, len
- * \param 1-dim array, len
- * \return Vector*
- *
- */
-
-Vector* _vvAdd(INOUT float* arr1, size_t len1, INOUT float* arr2, size_t len2){
-    Vector* v1;
-    Vector* v2;
-    Vector* result;
-    size_t i;
-    if (len1 != len2){
-        perr("len1 != len2\n");
+    if (row1 != row2 || col1 != col2){
+        perr("In mmAdd(), col or row is mismatched!\n");
     }
-    v1 = createVector(len1);
-    v2 = createVector(len2);
-    result = createVector(len1);
-    arrayToVector(arr1, v1, len1);
-    arrayToVector(arr2, v2, len2);
-    for (i=0; i<len1; i++){
-        result->vData[i] = v1->vData[i]+v2->vData[i];
+    if (height != row1 || width != col1){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyVector(v1); destroyVector(v2);
-    return result;
+    ewBinary(EW_ADD, arr1, row1, col1, arr2, row2, col2, dest, height, width);
 }
 /** \brief interface of vector+vector
  *
@@ -249,58 +366,227 @@ Vector* _vvAdd(INOUT float* arr1, size_t len1, INOUT float* arr2, size_t len2){
 
 void vvAdd (INOUT float* arr1, size_t len1, INOUT float* arr2, size_t len2,
                               OUT float* dest, size_t len){
-    vectorToArray(_vvAdd(arr1, len1, arr2, len2), dest, len);
+    if (len1 != len2){
+        perr("len1 != len2\n");
+    }
+    if (len != len1){
+        perr("The size of src and dest is mismatched! \n");
+    }
+    ewBinary(EW_ADD, arr1, 1, len1, arr2, 1, len2, dest, 1, len);
 }
-/** \brief interface of dot(vector, vector)
+/** \brief interface of dot(vector, vector), pairwise SIMD summation
  *
  * \param 1-dim array, len
  * \param 1-dim array, len
- * \param 1-dim array to save result, len
  * \return float
  *
  */
 float dot(INOUT float* arr1, size_t len1, INOUT float* arr2, size_t len2){
-    Vector* v1;
-    Vector* v2;
-    float sum;
-    size_t i;
     if (len1 != len2){
         perr("len1 != len2\n");
     }
-    v1 = createVector(len1);
-    v2 = createVector(len2);
-    arrayToVector(arr1, v1, len1);
-    arrayToVector(arr2, v2, len2);
-    sum = 0;
-
-    for (i=0; i<len1; i++){
-        sum += (v1->vData[i])*(v2->vData[i]);
-    }
-    destroyVector(v1); destroyVector(v2);
-    return sum;
+    return dotEx(arr1, arr2, len1, SUM_PAIRWISE);
 }
-/** \brief transpose(matrix), private function
+/*
+transpose: the out-of-place kernel splits the larger dimension recursively until a block
+fits in L1 (cache-oblivious), then moves 8x8 tiles through vector registers.
+*/
+#define TRANSPOSE_TILE 8
+#define TRANSPOSE_BLOCK (slach_tune()->transposeBlock) //tunable, see tune.h
+
+/** \brief transpose one 8x8 tile: dest(j,i) = src(i,j), private function
  *
- * \param 2-dim array, row, col
- * \return Matrix*
+ * \param src, lds
+ * \param dest, ldd
+ * \return
  *
  */
 
-Matrix* _mT (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(col, row);
+void _transposeTile(float* src, size_t lds, float* dest, size_t ldd){
+#if SLACH_VLEN == 8
+    __m256 r0, r1, r2, r3, r4, r5, r6, r7;
+    __m256 t0, t1, t2, t3, t4, t5, t6, t7;
+    r0 = _mm256_loadu_ps(src);       r1 = _mm256_loadu_ps(src+lds);
+    r2 = _mm256_loadu_ps(src+2*lds); r3 = _mm256_loadu_ps(src+3*lds);
+    r4 = _mm256_loadu_ps(src+4*lds); r5 = _mm256_loadu_ps(src+5*lds);
+    r6 = _mm256_loadu_ps(src+6*lds); r7 = _mm256_loadu_ps(src+7*lds);
+    t0 = _mm256_unpacklo_ps(r0, r1); t1 = _mm256_unpackhi_ps(r0, r1);
+    t2 = _mm256_unpacklo_ps(r2, r3); t3 = _mm256_unpackhi_ps(r2, r3);
+    t4 = _mm256_unpacklo_ps(r4, r5); t5 = _mm256_unpackhi_ps(r4, r5);
+    t6 = _mm256_unpacklo_ps(r6, r7); t7 = _mm256_unpackhi_ps(r6, r7);
+    r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1,0,1,0)); r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3,2,3,2));
+    r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1,0,1,0)); r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3,2,3,2));
+    r4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1,0,1,0)); r5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3,2,3,2));
+    r6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1,0,1,0)); r7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3,2,3,2));
+    _mm256_storeu_ps(dest,       _mm256_permute2f128_ps(r0, r4, 0x20));
+    _mm256_storeu_ps(dest+ldd,   _mm256_permute2f128_ps(r1, r5, 0x20));
+    _mm256_storeu_ps(dest+2*ldd, _mm256_permute2f128_ps(r2, r6, 0x20));
+    _mm256_storeu_ps(dest+3*ldd, _mm256_permute2f128_ps(r3, r7, 0x20));
+    _mm256_storeu_ps(dest+4*ldd, _mm256_permute2f128_ps(r0, r4, 0x31));
+    _mm256_storeu_ps(dest+5*ldd, _mm256_permute2f128_ps(r1, r5, 0x31));
+    _mm256_storeu_ps(dest+6*ldd, _mm256_permute2f128_ps(r2, r6, 0x31));
+    _mm256_storeu_ps(dest+7*ldd, _mm256_permute2f128_ps(r3, r7, 0x31));
+#elif SLACH_VLEN == 4
+    __m128 r0, r1, r2, r3;
+    size_t bi, bj;
+    for (bi=0; bi<8; bi+=4){
+        for (bj=0; bj<8; bj+=4){
+            r0 = _mm_loadu_ps(src+bi*lds+bj);     r1 = _mm_loadu_ps(src+(bi+1)*lds+bj);
+            r2 = _mm_loadu_ps(src+(bi+2)*lds+bj); r3 = _mm_loadu_ps(src+(bi+3)*lds+bj);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(dest+bj*ldd+bi, r0);     _mm_storeu_ps(dest+(bj+1)*ldd+bi, r1);
+            _mm_storeu_ps(dest+(bj+2)*ldd+bi, r2); _mm_storeu_ps(dest+(bj+3)*ldd+bi, r3);
+        }
+    }
+#else
     size_t i,j;
-    arrayToMatrix(arr, m, row, col);
+    for (i=0; i<8; i++){
+        for (j=0; j<8; j++){
+            dest[j*ldd+i] = src[i*lds+j];
+        }
+    }
+#endif
+}
+
+/** \brief transpose a block that fits in cache, tile by tile, private function
+ *
+ * \param row, col, src, lds, dest, ldd
+ * \return
+ *
+ */
 
-    for (i=0; i<row; i++){
+void _transposeBlock(size_t row, size_t col, float* src, size_t lds, float* dest, size_t ldd){
+    size_t i,j,ii,jj;
+    for (i=0; i+TRANSPOSE_TILE<=row; i+=TRANSPOSE_TILE){
+        for (j=0; j+TRANSPOSE_TILE<=col; j+=TRANSPOSE_TILE){
+            _transposeTile(src+i*lds+j, lds, dest+j*ldd+i, ldd);
+        }
+        for (ii=i; ii<i+TRANSPOSE_TILE; ii++){
+            for (jj=j; jj<col; jj++){
+                dest[jj*ldd+ii] = src[ii*lds+jj];
+            }
+        }
+    }
+    for (; i<row; i++){
         for (j=0; j<col; j++){
-            result->mData[j][i] = m->mData[i][j];
+            dest[j*ldd+i] = src[i*lds+j];
         }
     }
-    destroyMatrix(m);
-    return result;
 }
-/** \brief interface of transpose(matrix)
+
+/** \brief out-of-place transpose kernel: dest (col x row) = src (row x col)^T
+ *
+ * \param row, col
+ * \param src, lds: leading dimension of src
+ * \param dest, ldd: leading dimension of dest
+ * \return
+ *
+ */
+
+void transposeEx(size_t row, size_t col, IN float* src, size_t lds, OUT float* dest, size_t ldd){
+    size_t h;
+    if (row <= TRANSPOSE_BLOCK && col <= TRANSPOSE_BLOCK){
+        _transposeBlock(row, col, src, lds, dest, ldd);
+    }
+    else if (row >= col){
+        h = (row/2+TRANSPOSE_TILE-1)/TRANSPOSE_TILE*TRANSPOSE_TILE;
+        transposeEx(h, col, src, lds, dest, ldd);
+        transposeEx(row-h, col, src+h*lds, lds, dest+h, ldd);
+    }
+    else{
+        h = (col/2+TRANSPOSE_TILE-1)/TRANSPOSE_TILE*TRANSPOSE_TILE;
+        transposeEx(row, h, src, lds, dest, ldd);
+        transposeEx(row, col-h, src+h, lds, dest+h*ldd, ldd);
+    }
+}
+
+/** \brief in-place transpose of a square n x n matrix: tiles (i,j) and (j,i) are swapped, private function
+ *
+ * \param arr, n
+ * \return
+ *
+ */
+
+void _mTInplaceSquare(float* arr, size_t n){
+    float t1[TRANSPOSE_TILE*TRANSPOSE_TILE];
+    size_t i,j,ii,nt;
+    nt = n/TRANSPOSE_TILE*TRANSPOSE_TILE;
+    for (i=0; i<nt; i+=TRANSPOSE_TILE){
+        //diagonal tile
+        _transposeTile(arr+i*n+i, n, t1, TRANSPOSE_TILE);
+        for (ii=0; ii<TRANSPOSE_TILE; ii++){
+            memcpy(arr+(i+ii)*n+i, t1+ii*TRANSPOSE_TILE, TRANSPOSE_TILE*sizeof(float));
+        }
+        for (j=i+TRANSPOSE_TILE; j<nt; j+=TRANSPOSE_TILE){
+            _transposeTile(arr+i*n+j, n, t1, TRANSPOSE_TILE);
+            _transposeTile(arr+j*n+i, n, arr+i*n+j, n);
+            for (ii=0; ii<TRANSPOSE_TILE; ii++){
+                memcpy(arr+(j+ii)*n+i, t1+ii*TRANSPOSE_TILE, TRANSPOSE_TILE*sizeof(float));
+            }
+        }
+    }
+    //ragged border
+    for (i=0; i<n; i++){
+        for (j=MAX(i+1, nt); j<n; j++){
+            swap(&arr[i*n+j], &arr[j*n+i]);
+        }
+    }
+}
+
+/** \brief in-place transpose of a rectangular row x col matrix by cycle-following, private function.
+ *   Element p of the result comes from element (p%row)*col + p/row of the source; every cycle of
+ *   this permutation is rotated once, a bitset marks the visited positions.
+ *
+ * \param arr, row, col
+ * \return
+ *
+ */
+
+void _mTInplaceCycle(float* arr, size_t row, size_t col){
+    size_t len = row*col;
+    size_t words = (len+CHAR_BIT*sizeof(unsigned long)-1)/(CHAR_BIT*sizeof(unsigned long));
+    size_t bits = CHAR_BIT*sizeof(unsigned long);
+    unsigned long* seen = slach_malloc(unsigned long, words);
+    size_t s, p, q;
+    float tmp;
+    memset(seen, 0, words*sizeof(unsigned long));
+    //the first and last elements never move
+    for (s=1; s+1<len; s++){
+        if (seen[s/bits] & (1UL<<(s%bits))) continue;
+        tmp = arr[s];
+        p = s;
+        for (;;){
+            seen[p/bits] |= 1UL<<(p%bits);
+            q = (p%row)*col + p/row;
+            if (q == s) break;
+            arr[p] = arr[q];
+            p = q;
+        }
+        arr[p] = tmp;
+    }
+    slach_free(seen);
+}
+
+/** \brief in-place transpose: arr (row x col) becomes arr (col x row)
+ *
+ * \param 2-dim array, row, col
+ * \return
+ *
+ */
+
+void mTInplace(INOUT float* arr, size_t row, size_t col){
+    if (row == 0 || col == 0){
+        perr("In mTInplace(), col or row has problems!\n");
+    }
+    if (row == col){
+        _mTInplaceSquare(arr, row);
+    }
+    else if (row > 1 && col > 1){
+        _mTInplaceCycle(arr, row, col);
+    }
+}
+
+/** \brief interface of transpose(matrix), arr == dest transposes in place
  *
  * \param 2-dim array, row, col
  * \param 2-dim array, row, col
@@ -309,7 +595,14 @@ Matrix* _mT (INOUT float* arr, size_t row, size_t col){
  */
 
 void mT (INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_mT(arr, row, col), dest, height, width);
+    if (height != col || width != row){
+        perr("In mT(), dest must be col x row!\n");
+    }
+    if (arr == dest){
+        mTInplace(arr, row, col);
+        return;
+    }
+    transposeEx(row, col, arr, col, dest, row);
 }
 
 /** \brief slice of matrix to vector, private function
@@ -399,7 +692,7 @@ void slicem(INOUT float* arr, size_t row, size_t col, int startRow, int endRow,
    matrixToArray(_slicem(arr, row, col, startRow, endRow, startCol, endCol), dest, height, width);
 }
 
-/** \brief vector l-p norm
+/** \brief vector l-p norm, "1", "2" and "inf" take dedicated SIMD paths
  *
  * \param type: "inf" OR a number
  * \param 1-dim array, len
@@ -408,32 +701,16 @@ void slicem(INOUT float* arr, size_t row, size_t col, int startRow, int endRow,
  */
 
 float vNorm (char* type, float* arr, size_t len){
-    Vector* v;
-    size_t i;
-    float temp;
     int order;
     if (!strcmp(type, "0")) perr("type is not 0\n");
-    v = createVector(len);
-    arrayToVector(arr, v, len);
-    //inf norm
     if (!strcmp(type, "inf")){
-        temp = arr[0];
-        for (i=1; i<len; i++){
-            if (fabs((double)v->vData[i])>fabs(temp)){
-                temp = (float)fabs((double)v->vData[i]);
-            }
-        }
-        destroyVector(v);
-        return temp;
+        return amaxEx(arr, len);
     }
-    else{
-        temp = 0;
-        order = atoi(type);
-        for (i=0; i<len; i++){
-            temp += pow(fabs((double)v->vData[i]), (double)order);
-        }
-        destroyVector(v);
-        return (float)pow(temp, (double)1/order);
+    order = atoi(type);
+    switch (order){
+        case 1:  return asumEx(arr, len, SUM_PAIRWISE);
+        case 2:  return nrm2Ex(arr, len, SUM_PAIRWISE);
+        default: return pnormEx(arr, len, (double)order);
     }
 }
 
@@ -446,425 +723,258 @@ float vNorm (char* type, float* arr, size_t len){
  */
 
 float mNorm (char* type, float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    size_t i,j;
-    float sum;
-    arrayToMatrix(arr, m, row, col);
     if (strcmp(type, "F")){
         //PASS
         perr("this type is undefined in mNorm\n");
     }
-    else {
-        sum = 0;
-        for (i=0; i<row; i++){
-            for (j=0; j<col; j++){
-                sum += m->mData[i][j]*m->mData[i][j];
-            }
-        }
-        destroyMatrix(m);
-        return (float)pow(sum, 0.5);
-    }
+    //rows are contiguous, so the Frobenius norm is the 2-norm of the whole array
+    return nrm2Ex(arr, row*col, SUM_PAIRWISE);
 }
 
-/** \brief element-wise math functions of matrix or vector
+/** \brief apply one element-wise function given by its op code
  *
- * \param 1-dim array, len; 2-dim array, row, col
- * \param 1-dim array to save result, len; 2-dim array to save result, row, col
- * \return
+ * \param op: EW_* code
+ * \param x
+ * \param order: exponent, only used by EW_POW
+ * \return float
  *
  */
 
-Vector* _absv (INOUT float* arr, size_t len){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
+float ewScalar(EwOp op, float x, double order){
+    switch (op){
+        case EW_NONE: return x;
+        case EW_ABS:  return (float)fabs((double)x);
+        case EW_SIN:  return (float)sin((double)x);
+        case EW_COS:  return (float)cos((double)x);
+        case EW_TAN:  return (float)tan((double)x);
+        case EW_ASIN: return (float)asin((double)x);
+        case EW_ACOS: return (float)acos((double)x);
+        case EW_ATAN: return (float)atan((double)x);
+        case EW_EXP:  return (float)exp((double)x);
+        case EW_LOG:  return (float)log((double)x);
+        case EW_POW:  return (float)pow((double)x, order);
+        case EW_SQRT: return (float)sqrt((double)x);
+        default:
+            perr("In ewScalar(), unknown op!\n");
+            return x;
+    }
+}
+
+/** \brief op code and exponent of an element-wise function
+ *
+ * \param op: EW_* code, order: exponent for EW_POW
+ * \return
+ *
+ */
 
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)fabs((double)v->vData[i]);
-    }
-    destroyVector(v);
-    return result;
-}
+typedef struct _EwCtx_{
+    EwOp op;
+    double order;
+}EwCtx;
 
-void absv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
-    vectorToArray(_absv(arr, len), dest, lend);
-}
+/** \brief dest = op(x) on one block, map engine callback, private function
+ *
+ * \param x, dest (may be x), len
+ * \param ctx: EwCtx*
+ * \return
+ *
+ */
 
-Matrix* _absm (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    size_t i,j;
-    Matrix* result = createMatrix(row, col);
-    arrayToMatrix(arr, m, row, col);
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)fabs((double)m->mData[i][j]);
-        }
+void _ewBlock(float* x, float* dest, size_t len, void* ctx){
+    EwCtx* c = (EwCtx*)ctx;
+    size_t i = 0;
+    switch (c->op){
+        case EW_NONE:
+            if (dest != x) memmove(dest, x, len*sizeof(float));
+            return;
+        case EW_ABS:
+            for (; i+SLACH_VLEN<=len; i+=SLACH_VLEN){
+                vfStore(dest+i, vfAbs(vfLoad(x+i)));
+            }
+            break;
+        case EW_SQRT:
+            for (; i+SLACH_VLEN<=len; i+=SLACH_VLEN){
+                vfStore(dest+i, vfSqrt(vfLoad(x+i)));
+            }
+            break;
+        default:
+            break;
+    }
+    for (; i<len; i++){
+        dest[i] = ewScalar(c->op, x[i], c->order);
     }
-    destroyMatrix(m);
-    return result;
 }
 
-void absm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_absm(arr, row, col), dest, height, width);
+/** \brief apply an element-wise function in place, on the calling thread
+ *
+ * \param op: EW_* code, order: exponent for EW_POW
+ * \param 1-dim array, len
+ * \return
+ *
+ */
+
+void ewApply(EwOp op, double order, INOUT float* arr, size_t len){
+    EwCtx c;
+    c.op = op; c.order = order;
+    _ewBlock(arr, arr, len, &c);
 }
 
-//element-wise sin
-Vector* _sinv (INOUT float* arr, size_t len){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
+/** \brief dest = op(arr) through the map engine, private function
+ *
+ * \param op, order
+ * \param 1-dim array, len
+ * \param 1-dim array to save result, lend
+ * \return
+ *
+ */
 
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)sin((double)v->vData[i]);
+void _ewMap(EwOp op, double order, float* arr, size_t len, float* dest, size_t lend){
+    EwCtx c;
+    if (arr == NULL || dest == NULL){
+        perr("src or dest is NULL in copy!\n");
     }
-    destroyVector(v);
-    return result;
+    if (len != lend){
+        perr("The size of src and dest is mismatched! \n");
+    }
+    c.op = op; c.order = order;
+    slach_map_vec(arr, dest, len, _ewBlock, &c);
 }
 
-void sinv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
-    vectorToArray(_sinv(arr, len), dest, lend);
+/** \brief element-wise math functions of matrix or vector, run on the map engine
+ *
+ * \param 1-dim array, len; 2-dim array, row, col
+ * \param 1-dim array to save result, len; 2-dim array to save result, row, col
+ * \return
+ *
+ */
+
+void absv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
+    _ewMap(EW_ABS, 1, arr, len, dest, lend);
 }
 
-Matrix* _sinm (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(row, col);
-    arrayToMatrix(arr, m, row, col);
-    size_t i,j;
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)sin((double)m->mData[i][j]);
-        }
+void absm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyMatrix(m);
-    return result;
+    _ewMap(EW_ABS, 1, arr, row*col, dest, height*width);
 }
 
-void sinm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_sinm(arr, row, col), dest, height, width);
+//element-wise sin
+void sinv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
+    _ewMap(EW_SIN, 1, arr, len, dest, lend);
 }
 
-//element-wise cos
-Vector* _cosv (INOUT float* arr, size_t len){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
-
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)cos((double)v->vData[i]);
+void sinm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyVector(v);
-    return result;
+    _ewMap(EW_SIN, 1, arr, row*col, dest, height*width);
 }
 
+//element-wise cos
 void cosv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
-    vectorToArray(_cosv(arr, len), dest, lend);
-}
-
-Matrix* _cosm (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(row, col);
-    size_t i,j;
-    arrayToMatrix(arr, m, row, col);
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)cos((double)m->mData[i][j]);
-        }
-    }
-    destroyMatrix(m);
-    return result;
+    _ewMap(EW_COS, 1, arr, len, dest, lend);
 }
 
 void cosm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_cosm(arr, row, col), dest, height, width);
-}
-
-//element-wise tan
-Vector* _tanv (INOUT float* arr, size_t len){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
-
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)tan((double)v->vData[i]);
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyVector(v);
-    return result;
+    _ewMap(EW_COS, 1, arr, row*col, dest, height*width);
 }
 
+//element-wise tan
 void tanv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
-    vectorToArray(_tanv(arr, len), dest, lend);
-}
-
-Matrix* _tanm (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(row, col);
-    size_t i,j;
-    arrayToMatrix(arr, m, row, col);
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)tan((double)m->mData[i][j]);
-        }
-    }
-    destroyMatrix(m);
-    return result;
+    _ewMap(EW_TAN, 1, arr, len, dest, lend);
 }
 
 void tanm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_tanm(arr, row, col), dest, height, width);
-}
-
-//element-wise asin
-Vector* _asinv (INOUT float* arr, size_t len){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
-
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)asin((double)v->vData[i]);
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyVector(v);
-    return result;
+    _ewMap(EW_TAN, 1, arr, row*col, dest, height*width);
 }
 
+//element-wise asin
 void asinv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
-    vectorToArray(_asinv(arr, len), dest, lend);
-}
-
-Matrix* _asinm (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(row, col);
-    size_t i,j;
-    arrayToMatrix(arr, m, row, col);
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)asin((double)m->mData[i][j]);
-        }
-    }
-    destroyMatrix(m);
-    return result;
+    _ewMap(EW_ASIN, 1, arr, len, dest, lend);
 }
 
 void asinm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_asinm(arr, row, col), dest, height, width);
-}
-
-//element-wise acos
-Vector* _acosv (INOUT float* arr, size_t len){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
-
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)acos((double)v->vData[i]);
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyVector(v);
-    return result;
+    _ewMap(EW_ASIN, 1, arr, row*col, dest, height*width);
 }
 
+//element-wise acos
 void acosv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
-    vectorToArray(_acosv(arr, len), dest, lend);
-}
-
-Matrix* _acosm (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(row, col);
-    size_t i,j;
-    arrayToMatrix(arr, m, row, col);
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)acos((double)m->mData[i][j]);
-        }
-    }
-    destroyMatrix(m);
-    return result;
+    _ewMap(EW_ACOS, 1, arr, len, dest, lend);
 }
 
 void acosm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_acosm(arr, row, col), dest, height, width);
-}
-
-//element-wise atan
-Vector* _atanv (INOUT float* arr, size_t len){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
-
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)atan((double)v->vData[i]);
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyVector(v);
-    return result;
+    _ewMap(EW_ACOS, 1, arr, row*col, dest, height*width);
 }
 
+//element-wise atan
 void atanv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
-    vectorToArray(_atanv(arr, len), dest, lend);
-}
-
-Matrix* _atanm (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(row, col);
-    size_t i,j;
-    arrayToMatrix(arr, m, row, col);
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)atan((double)m->mData[i][j]);
-        }
-    }
-    destroyMatrix(m);
-    return result;
+    _ewMap(EW_ATAN, 1, arr, len, dest, lend);
 }
 
 void atanm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_atanm(arr, row, col), dest, height, width);
-}
-
-//element-wise exp
-Vector* _expv (INOUT float* arr, size_t len){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
-
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)exp((double)v->vData[i]);
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyVector(v);
-    return result;
+    _ewMap(EW_ATAN, 1, arr, row*col, dest, height*width);
 }
 
+//element-wise exp
 void expv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
-    vectorToArray(_expv(arr, len), dest, lend);
-}
-
-Matrix* _expm (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(row, col);
-    size_t i,j;
-    arrayToMatrix(arr, m, row, col);
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)exp((double)m->mData[i][j]);
-        }
-    }
-    destroyMatrix(m);
-    return result;
+    _ewMap(EW_EXP, 1, arr, len, dest, lend);
 }
 
 void expm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_expm(arr, row, col), dest, height, width);
-}
-
-//element-wise log
-Vector* _logv (INOUT float* arr, size_t len){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
-
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)log((double)v->vData[i]);
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyVector(v);
-    return result;
+    _ewMap(EW_EXP, 1, arr, row*col, dest, height*width);
 }
 
+//element-wise log
 void logv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
-    vectorToArray(_logv(arr, len), dest, lend);
-}
-
-Matrix* _logm (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(row, col);
-    size_t i,j;
-    arrayToMatrix(arr, m, row, col);
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)log((double)m->mData[i][j]);
-        }
-    }
-    destroyMatrix(m);
-    return result;
+    _ewMap(EW_LOG, 1, arr, len, dest, lend);
 }
 
 void logm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_logm(arr, row, col), dest, height, width);
-}
-
-//element-wise pow
-Vector* _powv (INOUT float* arr, size_t len, double order){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
-
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)pow((double)v->vData[i], order);
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyVector(v);
-    return result;
+    _ewMap(EW_LOG, 1, arr, row*col, dest, height*width);
 }
 
+//element-wise pow
 void powv(INOUT float* arr, size_t len, double order, OUT float* dest, size_t lend){
-    vectorToArray(_powv(arr, len, order), dest, lend);
-}
-
-Matrix* _powm (INOUT float* arr, size_t row, size_t col, double order){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(row, col);
-    size_t i,j;
-    arrayToMatrix(arr, m, row, col);
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)pow((double)m->mData[i][j], order);
-        }
-    }
-    destroyMatrix(m);
-    return result;
+    _ewMap(EW_POW, order, arr, len, dest, lend);
 }
 
 void powm(INOUT float* arr, size_t row, size_t col, double order, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_powm(arr, row, col, order), dest, height, width);
-}
-
-//element-wise sqrt
-Vector* _sqrtv (INOUT float* arr, size_t len){
-    Vector* v = createVector(len);
-    Vector* result = createVector(len);
-    size_t i;
-    arrayToVector(arr, v, len);
-
-    for (i=0; i<len; i++){
-        result->vData[i] = (float)sqrt((double)v->vData[i]);
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
     }
-    destroyVector(v);
-    return result;
+    _ewMap(EW_POW, order, arr, row*col, dest, height*width);
 }
 
+//element-wise sqrt
 void sqrtv(INOUT float* arr, size_t len, OUT float* dest, size_t lend){
-    vectorToArray(_sqrtv(arr, len), dest, lend);
-}
-
-Matrix* _sqrtm (INOUT float* arr, size_t row, size_t col){
-    Matrix* m = createMatrix(row, col);
-    Matrix* result = createMatrix(row, col);
-    size_t i,j;
-    arrayToMatrix(arr, m, row, col);
-    for (i=0; i<row; i++){
-        for (j=0; j<col; j++){
-            result->mData[i][j] = (float)sqrt((double)m->mData[i][j]);
-        }
-    }
-    destroyMatrix(m);
-    return result;
+    _ewMap(EW_SQRT, 1, arr, len, dest, lend);
 }
 
 void sqrtm(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
-    matrixToArray(_sqrtm(arr, row, col), dest, height, width);
+    if (row != height || col != width){
+        perr("The size of src and dest is mismatched! \n");
+    }
+    _ewMap(EW_SQRT, 1, arr, row*col, dest, height*width);
 }
@@ -0,0 +1,702 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#define _GNU_SOURCE //pthread_setaffinity_np
+#include "../include/parallel.h"
+#include <stdatomic.h>
+#ifndef SLACH_NO_THREADS
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+/*
+Work-stealing runtime. Every worker owns a deque of loop chunks; a thread outside the pool
+uses the shared injection deque instead. slach_parallel_for splits its range in halves on
+grain boundaries: one half is pushed for thieves, the other is split again, so a loop of
+n/grain chunks spreads over the pool in log2(n/grain) steps. The owner pops its deque LIFO
+(cache-hot, depth first), thieves take the oldest and therefore largest piece. A thread
+waiting for its loop keeps running chunks (its own or stolen ones) until the loop is done,
+which makes nested loops safe and parallel. Idle workers spin for a while, then park on a
+condition variable until new work is pushed.
+*/
+#define PARALLEL_MAX_THREADS 256
+#define PARALLEL_DEQUE 256 //a full deque runs the rest of the range inline
+#define PARALLEL_SPIN 64   //empty steal rounds before a worker parks
+
+static atomic_int nThreads = 0; //0 means the pool has not been initialized yet
+static int reproducible = 0;
+static int reproFromEnv = 1; //SLACH_REPRODUCIBLE is read once, on first use
+
+#ifndef SLACH_NO_THREADS
+/** \brief outstanding iterations of one slach_parallel_for call, lives on the caller's stack
+ *
+ * \param left: iterations not finished yet, the caller returns when it reaches 0
+ * \return
+ *
+ */
+
+typedef struct _ParallelGroup_{
+    atomic_size_t left;
+}ParallelGroup;
+
+/** \brief a range of a loop
+ *
+ * \param fn, ctx: loop body
+ * \param begin, end: range, begin is a multiple of grain
+ * \param grain: chunk size of the loop
+ * \param grp: loop the range belongs to
+ * \param task: detached task (_parallelSubmit) run as task(ctx) instead of a range, or NULL
+ * \return
+ *
+ */
+
+typedef struct _ParallelTask_{
+    parallelFn fn;
+    void* ctx;
+    size_t begin;
+    size_t end;
+    size_t grain;
+    ParallelGroup* grp;
+    slachTaskFn task;
+}ParallelTask;
+
+/** \brief bounded deque of tasks: the owner works at tail, thieves take at head
+ *
+ * \param lock, head, tail, task
+ * \return
+ *
+ */
+
+typedef struct _ParallelDeque_{
+    pthread_mutex_t lock;
+    size_t head;
+    size_t tail;
+    ParallelTask task[PARALLEL_DEQUE];
+}ParallelDeque;
+
+/** \brief one slach_parallel_for call on a caller-supplied executor, freed by its last user
+ *
+ * \param fn, ctx, n, grain: the loop
+ * \param next: first iteration not yet claimed
+ * \param left: iterations not finished yet
+ * \param refs: the caller plus the runners not finished yet
+ * \return
+ *
+ */
+
+typedef struct _ParallelExecJob_{
+    parallelFn fn;
+    void* ctx;
+    size_t n;
+    size_t grain;
+    atomic_size_t next;
+    atomic_size_t left;
+    atomic_int refs;
+}ParallelExecJob;
+
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER; //worker creation and parking
+static pthread_cond_t poolWake = PTHREAD_COND_INITIALIZER;
+static pthread_t workers[PARALLEL_MAX_THREADS];
+static ParallelDeque* deques[PARALLEL_MAX_THREADS];
+static ParallelDeque inject = {.lock = PTHREAD_MUTEX_INITIALIZER};
+static atomic_int nWorkers = 0;
+static atomic_ulong epoch = 0;   //bumped on every push, parked workers wait for a change
+static atomic_int sleepers = 0;
+static atomic_int affinity = -1; //-1: not read from SLACH_AFFINITY yet
+static SlachExecutor executor;
+static atomic_int useExecutor = 0;
+static __thread int self = -1;   //worker index of the calling thread, -1 outside the pool
+static pthread_once_t initOnce = PTHREAD_ONCE_INIT; //_parallelOnce
+
+/** \brief push a task at the owner end, private function
+ *
+ * \param d, t
+ * \return int, 0 when the deque is full
+ *
+ */
+
+int _dequePush(ParallelDeque* d, ParallelTask* t){
+    int ok = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail-d->head < PARALLEL_DEQUE){
+        d->task[d->tail%PARALLEL_DEQUE] = *t;
+        d->tail++;
+        ok = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+/** \brief take a task: the newest one (owner) or the oldest one (thief), private function
+ *
+ * \param d, t
+ * \param steal: 1 for a thief
+ * \return int, 0 when the deque is empty
+ *
+ */
+
+int _dequeTake(ParallelDeque* d, ParallelTask* t, int steal){
+    int ok = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail > d->head){
+        if (steal){
+            *t = d->task[d->head%PARALLEL_DEQUE];
+            d->head++;
+        }
+        else{
+            d->tail--;
+            *t = d->task[d->tail%PARALLEL_DEQUE];
+        }
+        ok = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+/** \brief pin a thread to one CPU, or release it to all CPUs, private function
+ *
+ * \param th: thread
+ * \param cpu: CPU index, -1 for all
+ * \return
+ *
+ */
+
+void _parallelPin(pthread_t th, int cpu){
+#ifdef __linux__
+    cpu_set_t set;
+    long i, ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    CPU_ZERO(&set);
+    for (i=0; i<MAX(ncpu, 1); i++){
+        if (cpu < 0 || i == cpu%MAX(ncpu, 1)) CPU_SET(i, &set);
+    }
+    pthread_setaffinity_np(th, sizeof(set), &set);
+#else
+    (void)th; (void)cpu;
+#endif
+}
+
+/** \brief wake parked workers after a push, private function
+ *
+ * \param empty
+ * \return
+ *
+ */
+
+void _parallelNotify(){
+    atomic_fetch_add(&epoch, 1);
+    if (atomic_load(&sleepers) > 0){
+        pthread_mutex_lock(&poolLock);
+        pthread_cond_broadcast(&poolWake);
+        pthread_mutex_unlock(&poolLock);
+    }
+}
+
+/** \brief run a task: push halves for thieves down to one chunk, then run it, private function
+ *
+ * \param t
+ * \return
+ *
+ */
+
+void _parallelRun(ParallelTask* t){
+    ParallelDeque* own = self >= 0 ? deques[self] : &inject;
+    ParallelTask r = *t;
+    size_t chunks, b, e;
+    if (t->task != NULL){
+        t->task(t->ctx);
+        return;
+    }
+    for (;;){
+        chunks = (t->end-t->begin+t->grain-1)/t->grain;
+        if (chunks < 2) break;
+        r.begin = t->begin+chunks/2*t->grain;
+        r.end = t->end;
+        if (!_dequePush(own, &r)) break;
+        t->end = r.begin;
+        _parallelNotify();
+    }
+    //one chunk, or several when the deque was full: fn only ever sees grain-aligned chunks
+    for (b=t->begin; b<t->end; b=e){
+        e = MIN(t->end, b+t->grain);
+        t->fn(t->ctx, b, e);
+        atomic_fetch_sub(&t->grp->left, e-b);
+    }
+}
+
+/** \brief find a task: own deque first, then steal, private function
+ *
+ * \param t
+ * \return int, 0 when there is no work anywhere
+ *
+ */
+
+int _parallelFind(ParallelTask* t){
+    ParallelDeque* own = self >= 0 ? deques[self] : &inject;
+    int n = atomic_load(&nWorkers), i;
+    if (_dequeTake(own, t, 0)) return 1;
+    //workers beyond the current thread count only finish what they own
+    if (self+1 >= atomic_load(&nThreads) && self >= 0) return 0;
+    for (i=1; i<=n; i++){
+        ParallelDeque* d = deques[(self+i+n)%n];
+        if (d != own && _dequeTake(d, t, 1)) return 1;
+    }
+    return own != &inject && _dequeTake(&inject, t, 1);
+}
+
+/** \brief worker thread main loop, private function
+ *
+ * \param arg: worker index
+ * \return
+ *
+ */
+
+void* _parallelWorker(void* arg){
+    ParallelTask t;
+    unsigned long seen;
+    int spin = 0;
+    self = (int)(size_t)arg;
+    for (;;){
+        seen = atomic_load(&epoch);
+        if (_parallelFind(&t)){
+            _parallelRun(&t);
+            spin = 0;
+            continue;
+        }
+        if (++spin < PARALLEL_SPIN){
+            sched_yield();
+            continue;
+        }
+        spin = 0;
+        pthread_mutex_lock(&poolLock);
+        atomic_fetch_add(&sleepers, 1);
+        while (atomic_load(&epoch) == seen){
+            pthread_cond_wait(&poolWake, &poolLock);
+        }
+        atomic_fetch_sub(&sleepers, 1);
+        pthread_mutex_unlock(&poolLock);
+    }
+    return NULL;
+}
+
+/** \brief start workers up to the current thread count, private function
+ *
+ * \param empty
+ * \return
+ *
+ */
+
+void _parallelSpawn(){
+    int i;
+    if (atomic_load(&nWorkers) >= atomic_load(&nThreads)-1) return;
+    pthread_mutex_lock(&poolLock);
+    for (i=atomic_load(&nWorkers); i<atomic_load(&nThreads)-1; i++){
+        if (deques[i] == NULL){
+            deques[i] = slach_malloc(ParallelDeque, 1);
+            pthread_mutex_init(&deques[i]->lock, NULL);
+        }
+        if (pthread_create(&workers[i], NULL, _parallelWorker, (void*)(size_t)i) != 0){
+            break;
+        }
+        pthread_detach(workers[i]);
+        if (atomic_load(&affinity) == 1) _parallelPin(workers[i], i+1);
+        atomic_store(&nWorkers, i+1);
+    }
+    pthread_mutex_unlock(&poolLock);
+}
+
+/** \brief run chunks of an executor job until none is left, private function
+ *
+ * \param j
+ * \return
+ *
+ */
+
+void _parallelExecDrain(ParallelExecJob* j){
+    size_t b, e;
+    while ((b = atomic_fetch_add(&j->next, j->grain)) < j->n){
+        e = MIN(j->n, b+j->grain);
+        j->fn(j->ctx, b, e);
+        atomic_fetch_sub(&j->left, e-b);
+    }
+}
+
+/** \brief drop one reference to an executor job, private function
+ *
+ * \param j
+ * \return
+ *
+ */
+
+void _parallelExecRelease(ParallelExecJob* j){
+    if (atomic_fetch_sub(&j->refs, 1) == 1){
+        slach_free(j);
+    }
+}
+
+/** \brief task submitted to the executor: help with the loop, private function
+ *
+ * \param arg: ParallelExecJob*
+ * \return
+ *
+ */
+
+void _parallelExecRunner(void* arg){
+    ParallelExecJob* j = (ParallelExecJob*)arg;
+    _parallelExecDrain(j);
+    _parallelExecRelease(j);
+}
+
+/** \brief slach_parallel_for on the caller-supplied executor, private function.
+ *   The caller drains the loop itself, so runners that start late (or never) cost nothing.
+ *
+ * \param n, grain, fn, ctx
+ * \return
+ *
+ */
+
+void _parallelForExec(size_t n, size_t grain, parallelFn fn, void* ctx){
+    ParallelExecJob* j = slach_malloc(ParallelExecJob, 1);
+    size_t chunks = (n+grain-1)/grain;
+    int r, runners = (int)MIN(chunks-1, (size_t)MAX(executor.concurrency-1, 0));
+    j->fn = fn; j->ctx = ctx; j->n = n; j->grain = grain;
+    atomic_init(&j->next, 0);
+    atomic_init(&j->left, n);
+    atomic_init(&j->refs, runners+1);
+    for (r=0; r<runners; r++){
+        executor.submit(executor.pool, _parallelExecRunner, j);
+    }
+    _parallelExecDrain(j);
+    while (atomic_load(&j->left) > 0){
+        sched_yield();
+    }
+    _parallelExecRelease(j);
+}
+
+/** \brief pthread_atfork child handler, private function: only the forking thread survives a
+ *   fork, so the child forgets the workers, drops their queued chunks, re-creates the locks
+ *   (another thread may have held one) and runs serially until slach_set_num_threads
+ *
+ * \param empty
+ * \return
+ *
+ */
+
+void _parallelForkChild(){
+    int i;
+    pthread_mutex_init(&poolLock, NULL);
+    pthread_cond_init(&poolWake, NULL);
+    pthread_mutex_init(&inject.lock, NULL);
+    inject.head = inject.tail = 0;
+    for (i=0; i<PARALLEL_MAX_THREADS; i++){
+        if (deques[i] != NULL){
+            pthread_mutex_init(&deques[i]->lock, NULL);
+            deques[i]->head = deques[i]->tail = 0;
+        }
+    }
+    atomic_store(&nWorkers, 0);
+    atomic_store(&sleepers, 0);
+    self = -1;
+    atomic_store(&nThreads, 1);
+}
+
+/** \brief one-time setup every entry point runs, however the thread count was set, private
+ *   function: registers _parallelForkChild and reads SLACH_AFFINITY
+ *
+ * \param empty
+ * \return
+ *
+ */
+
+void _parallelOnce(){
+    char* env;
+    pthread_atfork(NULL, NULL, _parallelForkChild);
+    if (atomic_load(&affinity) < 0){
+        env = getenv("SLACH_AFFINITY");
+        atomic_store(&affinity, env != NULL && atoi(env) != 0);
+    }
+}
+#endif
+
+/** \brief read the thread count, the affinity and the reproducible mode from the environment,
+ *   private function
+ *
+ * \param empty
+ * \return
+ *
+ */
+
+void _parallelInit(){
+    char* env;
+#ifndef SLACH_NO_THREADS
+    int n = 0;
+    pthread_mutex_lock(&poolLock);
+#endif
+    if (reproFromEnv){
+        env = getenv("SLACH_REPRODUCIBLE");
+        reproducible = env != NULL && atoi(env) != 0;
+        reproFromEnv = 0;
+    }
+#ifdef SLACH_NO_THREADS
+    atomic_store(&nThreads, 1);
+#else
+    pthread_once(&initOnce, _parallelOnce);
+    if (atomic_load(&nThreads) == 0){
+        env = getenv("SLACH_NUM_THREADS");
+        if (env != NULL){
+            n = atoi(env);
+        }
+        if (n <= 0){
+            n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        }
+        atomic_store(&nThreads, MAX(1, MIN(n, PARALLEL_MAX_THREADS)));
+    }
+    pthread_mutex_unlock(&poolLock);
+#endif
+}
+
+/** \brief set the number of threads used by slach kernels
+ *
+ * \param n: thread count, <= 0 restores the default
+ * \return
+ *
+ */
+
+void slach_set_num_threads(int n){
+#ifndef SLACH_NO_THREADS
+    if (n <= 0){
+        atomic_store(&nThreads, 0);
+        _parallelInit();
+        return;
+    }
+    pthread_once(&initOnce, _parallelOnce);
+    atomic_store(&nThreads, MIN(n, PARALLEL_MAX_THREADS));
+#else
+    (void)n;
+#endif
+}
+
+/** \brief number of threads used by slach kernels (the executor's concurrency when one is set)
+ *
+ * \param empty
+ * \return int
+ *
+ */
+
+int slach_get_num_threads(void){
+    if (atomic_load(&nThreads) == 0) _parallelInit();
+#ifndef SLACH_NO_THREADS
+    if (atomic_load(&useExecutor)) return MAX(executor.concurrency, 1);
+#endif
+    return atomic_load(&nThreads);
+}
+
+/** \brief pin the pool workers to CPUs (worker i to CPU i+1, the caller keeps CPU 0's share)
+ *
+ * \param on: 1 to pin, 0 to let the OS place them (default, or SLACH_AFFINITY=1 in the environment)
+ * \return
+ *
+ */
+
+void slach_set_affinity(int on){
+#ifndef SLACH_NO_THREADS
+    int i;
+    if (atomic_load(&nThreads) == 0) _parallelInit();
+    pthread_mutex_lock(&poolLock);
+    atomic_store(&affinity, on != 0);
+    for (i=0; i<atomic_load(&nWorkers); i++){
+        _parallelPin(workers[i], on ? i+1 : -1);
+    }
+    pthread_mutex_unlock(&poolLock);
+#else
+    (void)on;
+#endif
+}
+
+/** \brief run every slach loop on a caller-supplied executor instead of the internal pool
+ *
+ * \param ex: submit(pool, fn, arg) must eventually run fn(arg) on some thread;
+ *   concurrency is the number of threads worth using. NULL restores the internal pool.
+ * \return
+ *
+ */
+
+void slach_set_executor(IN const SlachExecutor* ex){
+#ifndef SLACH_NO_THREADS
+    if (ex != NULL && ex->submit == NULL){
+        perr("In slach_set_executor(), submit is NULL!\n");
+    }
+    atomic_store(&useExecutor, 0);
+    if (ex != NULL){
+        executor = *ex;
+        atomic_store(&useExecutor, 1);
+    }
+#else
+    (void)ex;
+#endif
+}
+
+/** \brief switch the reproducible mode: reductions, GEMM and GEMV give bit-identical
+ *   results for any thread count and any dispatched instruction set
+ *
+ * \param on: 1 to enable, 0 for the fast mode (default, or SLACH_REPRODUCIBLE=1 in the environment)
+ * \return
+ *
+ */
+
+void slach_set_reproducible(int on){
+    if (reproFromEnv) _parallelInit();
+    reproducible = on != 0;
+}
+
+/** \brief whether the reproducible mode is on
+ *
+ * \param empty
+ * \return int
+ *
+ */
+
+int slach_get_reproducible(void){
+    if (reproFromEnv) _parallelInit();
+    return reproducible;
+}
+
+/** \brief parallel loop: fn(ctx, begin, end) over [0, n), the caller takes part.
+ *   fn sees either the whole range or chunks [i*grain, (i+1)*grain) (the last one shorter).
+ *   Nested calls are parallel too.
+ *
+ * \param n: iterations
+ * \param grain: chunk size
+ * \param fn, ctx: loop body
+ * \return
+ *
+ */
+
+void slach_parallel_for(size_t n, size_t grain, parallelFn fn, void* ctx){
+#ifndef SLACH_NO_THREADS
+    ParallelGroup grp;
+    ParallelTask t;
+#endif
+    if (n == 0) return;
+    if (grain == 0) grain = 1;
+    if (atomic_load(&nThreads) == 0) _parallelInit();
+#ifdef SLACH_NO_THREADS
+    fn(ctx, 0, n);
+#else
+    if (n <= grain){
+        fn(ctx, 0, n);
+        return;
+    }
+    if (atomic_load(&useExecutor)){
+        if (executor.concurrency <= 1) fn(ctx, 0, n);
+        else _parallelForExec(n, grain, fn, ctx);
+        return;
+    }
+    if (atomic_load(&nThreads) <= 1){
+        fn(ctx, 0, n);
+        return;
+    }
+    _parallelSpawn();
+    atomic_init(&grp.left, n);
+    t.fn = fn; t.ctx = ctx; t.begin = 0; t.end = n; t.grain = grain; t.grp = &grp; t.task = NULL;
+    _parallelRun(&t);
+    //help until every chunk of this loop is done; chunks of other loops are fair game
+    while (atomic_load(&grp.left) > 0){
+        if (_parallelFind(&t)) _parallelRun(&t);
+        else sched_yield();
+    }
+#endif
+}
+
+/** \brief run fn(arg) asynchronously: on the executor when one is set, else queued for the
+ *   workers. Without workers, or when the queue is full, the caller runs it. Private function
+ *   of the async front end (async.h)
+ *
+ * \param fn, arg
+ * \return
+ *
+ */
+
+void _parallelSubmit(slachTaskFn fn, void* arg){
+#ifndef SLACH_NO_THREADS
+    ParallelTask t;
+#endif
+    if (atomic_load(&nThreads) == 0) _parallelInit();
+#ifdef SLACH_NO_THREADS
+    fn(arg);
+#else
+    if (atomic_load(&useExecutor)){
+        executor.submit(executor.pool, fn, arg);
+        return;
+    }
+    if (atomic_load(&nThreads) <= 1){
+        fn(arg);
+        return;
+    }
+    _parallelSpawn();
+    memset(&t, 0, sizeof(t));
+    t.task = fn; t.ctx = arg;
+    if (!_dequePush(self >= 0 ? deques[self] : &inject, &t)){
+        fn(arg);
+        return;
+    }
+    _parallelNotify();
+#endif
+}
+
+/** \brief run one pending chunk or task of the pool on the calling thread, private function
+ *   of the async front end: a thread waiting for a submission helps instead of idling
+ *
+ * \param empty
+ * \return int, 0 when there was nothing to run
+ *
+ */
+
+int _parallelHelp(){
+#ifndef SLACH_NO_THREADS
+    ParallelTask t;
+    if (atomic_load(&useExecutor) || atomic_load(&nWorkers) == 0) return 0;
+    if (_parallelFind(&t)){
+        _parallelRun(&t);
+        return 1;
+    }
+#endif
+    return 0;
+}
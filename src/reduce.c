@@ -0,0 +1,872 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/reduce.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+#include "simd.h"
+
+/*
+One kernel serves every reduction: the term of element j is x_j*y_j (dot), |x_j| (asum),
+(s*x_j)^2 (sum of squares with scale s) or x_j (sum). REDUCE_BLOCK is the leaf size of the
+pairwise tree: small enough that the leaf error stays tiny, large enough to amortize the calls.
+*/
+#define REDUCE_BLOCK 512
+#define REDUCE_UNROLL (4*SLACH_VLEN)
+
+enum{
+    RED_SUM = 0,
+    RED_DOT,
+    RED_ASUM,
+    RED_SSQ
+};
+
+/** \brief vector term of element j, private function
+ *
+ * \param kind: RED_* code
+ * \param x, y, sv: scale for RED_SSQ
+ * \return vfloat
+ *
+ */
+
+static SLACH_INLINE vfloat _reduceTermV(int kind, float* x, float* y, vfloat sv){
+    vfloat t;
+    switch (kind){
+        case RED_DOT:  return vfMul(vfLoad(x), vfLoad(y));
+        case RED_ASUM: return vfAbs(vfLoad(x));
+        case RED_SSQ:  t = vfMul(vfLoad(x), sv); return vfMul(t, t);
+        default:       return vfLoad(x);
+    }
+}
+
+/** \brief scalar term of element j, private function
+ *
+ * \param kind: RED_* code
+ * \param x, y, s: scale for RED_SSQ
+ * \return float
+ *
+ */
+
+static SLACH_INLINE float _reduceTerm(int kind, float* x, float* y, float s){
+    switch (kind){
+        case RED_DOT:  return (*x)*(*y);
+        case RED_ASUM: return (float)fabs((double)*x);
+        case RED_SSQ:  return (s*(*x))*(s*(*x));
+        default:       return *x;
+    }
+}
+
+/** \brief sum of terms with four independent vector accumulators, private function.
+ *   kind is a constant in every caller, so each instance compiles to a straight loop.
+ *
+ * \param kind, x, y, len, s
+ * \return float
+ *
+ */
+
+static SLACH_INLINE float _reduceFastKind(int kind, float* x, float* y, size_t len, float s){
+    vfloat a0 = vfZero(), a1 = vfZero(), a2 = vfZero(), a3 = vfZero();
+    vfloat sv = vfSet1(s);
+    float r;
+    size_t j;
+    for (j=0; j+REDUCE_UNROLL<=len; j+=REDUCE_UNROLL){
+        a0 = vfAdd(a0, _reduceTermV(kind, x+j, y+j, sv));
+        a1 = vfAdd(a1, _reduceTermV(kind, x+j+SLACH_VLEN, y+j+SLACH_VLEN, sv));
+        a2 = vfAdd(a2, _reduceTermV(kind, x+j+2*SLACH_VLEN, y+j+2*SLACH_VLEN, sv));
+        a3 = vfAdd(a3, _reduceTermV(kind, x+j+3*SLACH_VLEN, y+j+3*SLACH_VLEN, sv));
+    }
+    for (; j+SLACH_VLEN<=len; j+=SLACH_VLEN){
+        a0 = vfAdd(a0, _reduceTermV(kind, x+j, y+j, sv));
+    }
+    r = vfHsum(vfAdd(vfAdd(a0, a1), vfAdd(a2, a3)));
+    for (; j<len; j++){
+        r += _reduceTerm(kind, x+j, y+j, s);
+    }
+    return r;
+}
+
+/** \brief SUM_FAST kernel, private function
+ *
+ * \param kind, x, y (may be NULL unless kind is RED_DOT), len, s
+ * \return float
+ *
+ */
+
+float _reduceFast(int kind, float* x, float* y, size_t len, float s){
+    if (y == NULL) y = x;
+    switch (kind){
+        case RED_DOT:  return _reduceFastKind(RED_DOT, x, y, len, s);
+        case RED_ASUM: return _reduceFastKind(RED_ASUM, x, y, len, s);
+        case RED_SSQ:  return _reduceFastKind(RED_SSQ, x, y, len, s);
+        default:       return _reduceFastKind(RED_SUM, x, y, len, s);
+    }
+}
+
+/** \brief SUM_PAIRWISE kernel: split in halves down to REDUCE_BLOCK, private function
+ *
+ * \param kind, x, y, len, s
+ * \return float
+ *
+ */
+
+float _reducePairwise(int kind, float* x, float* y, size_t len, float s){
+    size_t h;
+    if (len <= REDUCE_BLOCK){
+        return _reduceFast(kind, x, y, len, s);
+    }
+    //split on a multiple of the unroll so both halves stay on the vector path
+    h = len/2/REDUCE_UNROLL*REDUCE_UNROLL;
+    return _reducePairwise(kind, x, y, h, s) +
+           _reducePairwise(kind, x+h, y == NULL ? NULL : y+h, len-h, s);
+}
+
+/** \brief one compensated (Kahan) step per lane, private function
+ *
+ * \param sum, c: running sum and compensation
+ * \param t: term
+ * \return
+ *
+ */
+
+static SLACH_INLINE void _kahanStep(vfloat* sum, vfloat* c, vfloat t){
+    vfloat yv = vfSub(t, *c);
+    vfloat tv = vfAdd(*sum, yv);
+    *c = vfSub(vfSub(tv, *sum), yv);
+    *sum = tv;
+}
+
+/** \brief SUM_KAHAN kernel of one kind, two independent compensated lanes, private function
+ *
+ * \param kind, x, y, len, s
+ * \return float
+ *
+ */
+
+static SLACH_INLINE float _reduceKahanKind(int kind, float* x, float* y, size_t len, float s){
+    vfloat s0 = vfZero(), c0 = vfZero(), s1 = vfZero(), c1 = vfZero();
+    vfloat sv = vfSet1(s);
+    float lane[2*SLACH_VLEN];
+    float sum = 0, c = 0, yy, tt;
+    size_t j;
+    for (j=0; j+2*SLACH_VLEN<=len; j+=2*SLACH_VLEN){
+        _kahanStep(&s0, &c0, _reduceTermV(kind, x+j, y+j, sv));
+        _kahanStep(&s1, &c1, _reduceTermV(kind, x+j+SLACH_VLEN, y+j+SLACH_VLEN, sv));
+    }
+    //fold the lanes with their compensations, then the tail, in compensated scalar arithmetic
+    vfStore(lane, vfSub(s0, c0));
+    vfStore(lane+SLACH_VLEN, vfSub(s1, c1));
+    for (; j<len; j++){
+        yy = _reduceTerm(kind, x+j, y+j, s) - c;
+        tt = sum + yy;
+        c = (tt - sum) - yy;
+        sum = tt;
+    }
+    for (j=0; j<2*SLACH_VLEN; j++){
+        yy = lane[j] - c;
+        tt = sum + yy;
+        c = (tt - sum) - yy;
+        sum = tt;
+    }
+    return sum;
+}
+
+/** \brief SUM_KAHAN kernel, private function
+ *
+ * \param kind, x, y, len, s
+ * \return float
+ *
+ */
+
+float _reduceKahan(int kind, float* x, float* y, size_t len, float s){
+    if (y == NULL) y = x;
+    switch (kind){
+        case RED_DOT:  return _reduceKahanKind(RED_DOT, x, y, len, s);
+        case RED_ASUM: return _reduceKahanKind(RED_ASUM, x, y, len, s);
+        case RED_SSQ:  return _reduceKahanKind(RED_SSQ, x, y, len, s);
+        default:       return _reduceKahanKind(RED_SUM, x, y, len, s);
+    }
+}
+
+/*
+reproducible mode (slach_set_reproducible): every term is formed exactly in double (a product
+of two floats fits in the 53-bit mantissa) and added into REPRO_LANES double lanes in a fixed
+order, blocks of REPRO_BLOCK elements are combined left to right. Nothing depends on the
+vector width or the thread count, so the result is the same bit pattern on every build.
+*/
+#define REPRO_LANES 8
+#define REPRO_BLOCK (1<<14)
+#define REPRO_GROUP 64
+#define REPRO_PAR_MIN (1<<17)
+
+typedef struct _ReproCtx_{
+    int kind;
+    float* x;
+    float* y;
+    size_t len;
+    size_t first; //first block of the group
+    double* part; //one partial per block of the group
+}ReproCtx;
+
+/** \brief exact double term of element j, private function
+ *
+ * \param kind, x, y
+ * \return double
+ *
+ */
+
+static SLACH_INLINE double _reproTerm(int kind, float* x, float* y){
+    switch (kind){
+        case RED_DOT:  return (double)(*x)*(double)(*y);
+        case RED_ASUM: return fabs((double)*x);
+        case RED_SSQ:  return (double)(*x)*(double)(*x);
+        default:       return (double)*x;
+    }
+}
+
+/** \brief sum of one block in REPRO_LANES fixed lanes, private function
+ *
+ * \param kind, x, y, len
+ * \return double
+ *
+ */
+
+static SLACH_INLINE double _reproBlockKind(int kind, float* x, float* y, size_t len){
+    double acc[REPRO_LANES] = {0};
+    size_t j, l;
+    for (j=0; j+REPRO_LANES<=len; j+=REPRO_LANES){
+        for (l=0; l<REPRO_LANES; l++){
+            acc[l] += _reproTerm(kind, x+j+l, y+j+l);
+        }
+    }
+    for (l=0; j<len; j++, l++){
+        acc[l] += _reproTerm(kind, x+j, y+j);
+    }
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+/** \brief reproducible sum of one block, private function
+ *
+ * \param kind, x, y, len
+ * \return double
+ *
+ */
+
+double _reproBlock(int kind, float* x, float* y, size_t len){
+    switch (kind){
+        case RED_DOT:  return _reproBlockKind(RED_DOT, x, y, len);
+        case RED_ASUM: return _reproBlockKind(RED_ASUM, x, y, len);
+        case RED_SSQ:  return _reproBlockKind(RED_SSQ, x, y, len);
+        default:       return _reproBlockKind(RED_SUM, x, y, len);
+    }
+}
+
+/** \brief partials of blocks [b0, b1) of a group, private function
+ *
+ * \param arg: ReproCtx*
+ * \param b0, b1: block range relative to the first block of the group
+ * \return
+ *
+ */
+
+void _reproRange(void* arg, size_t b0, size_t b1){
+    ReproCtx* c = (ReproCtx*)arg;
+    size_t b, off, n;
+    for (b=b0; b<b1; b++){
+        off = (c->first+b)*REPRO_BLOCK;
+        n = MIN(REPRO_BLOCK, c->len-off);
+        c->part[b] = _reproBlock(c->kind, c->x+off, c->y+off, n);
+    }
+}
+
+/** \brief reproducible reduction, private function
+ *
+ * \param kind, x, y (may be NULL unless kind is RED_DOT), len
+ * \return double
+ *
+ */
+
+double _reduceRepro(int kind, float* x, float* y, size_t len){
+    double part[REPRO_GROUP];
+    double r = 0;
+    size_t nb, b, g;
+    ReproCtx c;
+    if (y == NULL) y = x;
+    nb = (len+REPRO_BLOCK-1)/REPRO_BLOCK;
+    c.kind = kind;
+    c.x = x;
+    c.y = y;
+    c.len = len;
+    c.part = part;
+    for (c.first=0; c.first<nb; c.first+=REPRO_GROUP){
+        g = MIN(REPRO_GROUP, nb-c.first);
+        if (len >= REPRO_PAR_MIN){
+            slach_parallel_for(g, 1, _reproRange, &c);
+        }
+        else{
+            _reproRange(&c, 0, g);
+        }
+        for (b=0; b<g; b++){
+            r += part[b];
+        }
+    }
+    return r;
+}
+
+/** \brief dispatch on the summation mode, private function
+ *
+ * \param kind, x, y, len, s, mode
+ * \return float
+ *
+ */
+
+float _reduce(int kind, float* x, float* y, size_t len, float s, SumMode mode){
+    if (slach_get_reproducible()){
+        return (float)((double)s*(double)s*_reduceRepro(kind, x, y, len));
+    }
+    switch (mode){
+        case SUM_FAST:     return _reduceFast(kind, x, y, len, s);
+        case SUM_PAIRWISE: return _reducePairwise(kind, x, y, len, s);
+        case SUM_KAHAN:    return _reduceKahan(kind, x, y, len, s);
+        default:
+            perr("In reduce, unknown summation mode!\n");
+            return 0;
+    }
+}
+
+/** \brief sum of a vector
+ *
+ * \param 1-dim array, len
+ * \param mode: SUM_FAST, SUM_PAIRWISE or SUM_KAHAN
+ * \return float
+ *
+ */
+
+float sumEx(IN float* x, size_t len, SumMode mode){
+    return _reduce(RED_SUM, x, NULL, len, 1, mode);
+}
+
+/** \brief inner product of two vectors
+ *
+ * \param 1-dim array, 1-dim array, len
+ * \param mode: SUM_FAST, SUM_PAIRWISE or SUM_KAHAN
+ * \return float
+ *
+ */
+
+float dotEx(IN float* x, IN float* y, size_t len, SumMode mode){
+    return _reduce(RED_DOT, x, y, len, 1, mode);
+}
+
+/** \brief sum of absolute values (1-norm)
+ *
+ * \param 1-dim array, len
+ * \param mode: SUM_FAST, SUM_PAIRWISE or SUM_KAHAN
+ * \return float
+ *
+ */
+
+float asumEx(IN float* x, size_t len, SumMode mode){
+    return _reduce(RED_ASUM, x, NULL, len, 1, mode);
+}
+
+/** \brief largest absolute value (inf-norm)
+ *
+ * \param 1-dim array, len
+ * \return float
+ *
+ */
+
+float amaxEx(IN float* x, size_t len){
+    vfloat m0 = vfZero(), m1 = vfZero();
+    float r;
+    size_t j;
+    for (j=0; j+2*SLACH_VLEN<=len; j+=2*SLACH_VLEN){
+        m0 = vfMax(m0, vfAbs(vfLoad(x+j)));
+        m1 = vfMax(m1, vfAbs(vfLoad(x+j+SLACH_VLEN)));
+    }
+    r = vfHmax(vfMax(m0, m1));
+    for (; j<len; j++){
+        r = MAX(r, (float)fabs((double)x[j]));
+    }
+    return r;
+}
+
+/** \brief power of two close to 1/amax, so that scaling is exact, private function
+ *
+ * \param amax > 0
+ * \return float
+ *
+ */
+
+float _reduceScale(float amax){
+    int e;
+    frexp((double)amax, &e);
+    return (float)ldexp(1.0, -e);
+}
+
+/** \brief Euclidean norm without overflow or underflow.
+ *   One pass of plain squares in the common case; only when the sum of squares
+ *   overflows or drops into the denormal range is it redone scaled by a power of two near 1/max|x_i|.
+ *
+ * \param 1-dim array, len
+ * \param mode: SUM_FAST, SUM_PAIRWISE or SUM_KAHAN
+ * \return float
+ *
+ */
+
+float nrm2Ex(IN float* x, size_t len, SumMode mode){
+    float ssq, amax, s;
+    if (slach_get_reproducible()){
+        return (float)sqrt(_reduceRepro(RED_SSQ, x, NULL, len)); //no scaling needed in double
+    }
+    ssq = _reduce(RED_SSQ, x, NULL, len, 1, mode);
+    if (ssq <= FLT_MAX && ssq >= FLT_MIN/FLT_EPSILON){
+        return (float)sqrt((double)ssq);
+    }
+    amax = amaxEx(x, len);
+    if (amax == 0 || amax != amax){
+        return amax;
+    }
+    if (amax > FLT_MAX){
+        return amax; //inf
+    }
+    s = _reduceScale(amax);
+    ssq = _reduce(RED_SSQ, x, NULL, len, s, mode);
+    return (float)(sqrt((double)ssq)/(double)s);
+}
+
+/** \brief general l-p norm, scaled like nrm2Ex
+ *
+ * \param 1-dim array, len
+ * \param p > 0
+ * \return float
+ *
+ */
+
+float pnormEx(IN float* x, size_t len, double p){
+    double sum = 0, s;
+    float amax;
+    size_t j;
+    if (p <= 0){
+        perr("In pnormEx(), p must be positive!\n");
+    }
+    amax = amaxEx(x, len);
+    if (amax == 0 || amax > FLT_MAX || amax != amax){
+        return amax;
+    }
+    s = (double)_reduceScale(amax);
+    for (j=0; j<len; j++){
+        sum += pow(fabs((double)x[j])*s, p);
+    }
+    return (float)(pow(sum, 1/p)/s);
+}
+
+/*
+axis reductions. Column results (axis 0) are computed on panels of AXIS_PANEL columns:
+every row contributes one contiguous segment, and the panel's accumulators stay in L1.
+Sums over the rows are blocked by REDUCE_BLOCK rows, a two-level pairwise scheme.
+Panels (axis 0) or row ranges (axis 1) are spread over the thread pool when the matrix
+has at least AXIS_PAR_MIN elements.
+*/
+#define AXIS_PANEL 256
+#define AXIS_PAR_MIN (slach_tune()->parMin) //tunable, see tune.h
+
+//private op codes after the public AxisOp values
+enum{
+    AXIS_ARGMIN = AXIS_VAR+1,
+    AXIS_ARGMAX,
+    AXIS_SCAN,
+    AXIS_XSCAN
+};
+
+/** \brief arguments of an axis job
+ *
+ * \param op: AxisOp or private code
+ * \param arr, row, col
+ * \param dest: float results or scan output, idx: arg results
+ * \return
+ *
+ */
+
+typedef struct _AxisCtx_{
+    int op;
+    float* arr;
+    size_t row;
+    size_t col;
+    float* dest;
+    size_t* idx;
+}AxisCtx;
+
+/** \brief acc[0, w) += x[0, w), private function
+ *
+ * \param acc, x, w
+ * \return
+ *
+ */
+
+static SLACH_INLINE void _axisAdd(float* acc, float* x, size_t w){
+    size_t j;
+    for (j=0; j+SLACH_VLEN<=w; j+=SLACH_VLEN){
+        vfStore(acc+j, vfAdd(vfLoad(acc+j), vfLoad(x+j)));
+    }
+    for (; j<w; j++){
+        acc[j] += x[j];
+    }
+}
+
+/** \brief column sums of a row x w panel, blocked over the rows, private function
+ *
+ * \param a, lda, row, w
+ * \param tot: w sums
+ * \return
+ *
+ */
+
+void _axisPanelSum(float* a, size_t lda, size_t row, size_t w, float* tot){
+    float blk[AXIS_PANEL];
+    size_t i, i0;
+    memset(tot, 0, w*sizeof(float));
+    for (i0=0; i0<row; i0+=REDUCE_BLOCK){
+        memset(blk, 0, w*sizeof(float));
+        for (i=i0; i<MIN(row, i0+REDUCE_BLOCK); i++){
+            _axisAdd(blk, a+i*lda, w);
+        }
+        _axisAdd(tot, blk, w);
+    }
+}
+
+/** \brief one panel of an axis-0 job, private function
+ *
+ * \param c: AxisCtx*, j0: first column, w: width
+ * \return
+ *
+ */
+
+void _axisPanel(AxisCtx* c, size_t j0, size_t w){
+    float buf[AXIS_PANEL];
+    float* a = c->arr+j0;
+    float* d = c->dest+j0;
+    size_t lda = c->col, i, j;
+    vfloat m, t;
+    float x;
+    switch (c->op){
+        case AXIS_SUM:
+        case AXIS_MEAN:
+            _axisPanelSum(a, lda, c->row, w, d);
+            if (c->op == AXIS_MEAN){
+                for (j=0; j<w; j++) d[j] /= (float)c->row;
+            }
+            break;
+        case AXIS_VAR:
+            _axisPanelSum(a, lda, c->row, w, buf);
+            for (j=0; j<w; j++){
+                buf[j] /= (float)c->row;
+                d[j] = 0;
+            }
+            for (i=0; i<c->row; i++){
+                for (j=0; j+SLACH_VLEN<=w; j+=SLACH_VLEN){
+                    t = vfSub(vfLoad(a+i*lda+j), vfLoad(buf+j));
+                    vfStore(d+j, vfFmadd(t, t, vfLoad(d+j)));
+                }
+                for (; j<w; j++){
+                    x = a[i*lda+j]-buf[j];
+                    d[j] += x*x;
+                }
+            }
+            for (j=0; j<w; j++) d[j] /= (float)c->row;
+            break;
+        case AXIS_MIN:
+        case AXIS_MAX:
+            memcpy(d, a, w*sizeof(float));
+            for (i=1; i<c->row; i++){
+                for (j=0; j+SLACH_VLEN<=w; j+=SLACH_VLEN){
+                    m = vfLoad(d+j);
+                    t = vfLoad(a+i*lda+j);
+                    vfStore(d+j, c->op == AXIS_MIN ? vfMin(m, t) : vfMax(m, t));
+                }
+                for (; j<w; j++){
+                    x = a[i*lda+j];
+                    d[j] = c->op == AXIS_MIN ? MIN(d[j], x) : MAX(d[j], x);
+                }
+            }
+            break;
+        case AXIS_ARGMIN:
+        case AXIS_ARGMAX:
+            memcpy(buf, a, w*sizeof(float));
+            for (j=0; j<w; j++) c->idx[j0+j] = 0;
+            for (i=1; i<c->row; i++){
+                for (j=0; j<w; j++){
+                    x = a[i*lda+j];
+                    if (c->op == AXIS_ARGMIN ? x < buf[j] : x > buf[j]){
+                        buf[j] = x;
+                        c->idx[j0+j] = i;
+                    }
+                }
+            }
+            break;
+        default:
+            //prefix sums down the columns, the running sums make in-place scans safe
+            memset(buf, 0, w*sizeof(float));
+            d = c->dest+j0;
+            for (i=0; i<c->row; i++){
+                for (j=0; j<w; j++){
+                    x = a[i*lda+j];
+                    if (c->op == AXIS_SCAN){
+                        buf[j] += x;
+                        d[i*lda+j] = buf[j];
+                    }
+                    else{
+                        d[i*lda+j] = buf[j];
+                        buf[j] += x;
+                    }
+                }
+            }
+            break;
+    }
+}
+
+/** \brief axis-0 job over panels [p0, p1), thread pool body, private function
+ *
+ * \param arg: AxisCtx*, p0, p1
+ * \return
+ *
+ */
+
+void _axisColRange(void* arg, size_t p0, size_t p1){
+    AxisCtx* c = (AxisCtx*)arg;
+    size_t p;
+    for (p=p0; p<p1; p++){
+        _axisPanel(c, p*AXIS_PANEL, MIN(AXIS_PANEL, c->col-p*AXIS_PANEL));
+    }
+}
+
+/** \brief min or max of a contiguous row and the first index holding it, private function
+ *
+ * \param x, len, isMax
+ * \param at: index of the extremum (may be NULL)
+ * \return float
+ *
+ */
+
+float _axisExtremum(float* x, size_t len, int isMax, size_t* at){
+    float lane[SLACH_VLEN];
+    float r = x[0];
+    vfloat m, t;
+    size_t j = 0, l;
+    if (len >= SLACH_VLEN){
+        m = vfLoad(x);
+        for (j=SLACH_VLEN; j+SLACH_VLEN<=len; j+=SLACH_VLEN){
+            t = vfLoad(x+j);
+            m = isMax ? vfMax(m, t) : vfMin(m, t);
+        }
+        vfStore(lane, m);
+        for (l=0; l<SLACH_VLEN; l++){
+            r = isMax ? MAX(r, lane[l]) : MIN(r, lane[l]);
+        }
+    }
+    for (; j<len; j++){
+        r = isMax ? MAX(r, x[j]) : MIN(r, x[j]);
+    }
+    if (at != NULL){
+        //second pass over a row that is still in cache
+        for (j=0; j<len && x[j] != r; j++);
+        *at = j < len ? j : 0;
+    }
+    return r;
+}
+
+/** \brief axis-1 job over rows [r0, r1), thread pool body, private function
+ *
+ * \param arg: AxisCtx*, r0, r1
+ * \return
+ *
+ */
+
+void _axisRowRange(void* arg, size_t r0, size_t r1){
+    AxisCtx* c = (AxisCtx*)arg;
+    size_t n = c->col, i, j;
+    float* a;
+    float* d;
+    float mean, s, x, run;
+    for (i=r0; i<r1; i++){
+        a = c->arr+i*n;
+        switch (c->op){
+            case AXIS_SUM:
+                c->dest[i] = sumEx(a, n, SUM_PAIRWISE);
+                break;
+            case AXIS_MEAN:
+                c->dest[i] = sumEx(a, n, SUM_PAIRWISE)/(float)n;
+                break;
+            case AXIS_VAR:
+                mean = sumEx(a, n, SUM_PAIRWISE)/(float)n;
+                s = 0;
+                for (j=0; j<n; j++){
+                    x = a[j]-mean;
+                    s += x*x;
+                }
+                c->dest[i] = s/(float)n;
+                break;
+            case AXIS_MIN:
+            case AXIS_MAX:
+                c->dest[i] = _axisExtremum(a, n, c->op == AXIS_MAX, NULL);
+                break;
+            case AXIS_ARGMIN:
+            case AXIS_ARGMAX:
+                _axisExtremum(a, n, c->op == AXIS_ARGMAX, c->idx+i);
+                break;
+            default:
+                d = c->dest+i*n;
+                run = 0;
+                for (j=0; j<n; j++){
+                    x = a[j];
+                    d[j] = c->op == AXIS_SCAN ? run+x : run;
+                    run += x;
+                }
+                break;
+        }
+    }
+}
+
+/** \brief run an axis job, private function
+ *
+ * \param c: AxisCtx*, axis
+ * \return
+ *
+ */
+
+void _axis(AxisCtx* c, int axis){
+    size_t np, grain;
+    int par = c->row*c->col >= AXIS_PAR_MIN;
+    if (c->row == 0 || c->col == 0){
+        perr("In axis reductions, col or row has problems!\n");
+    }
+    if (axis == 0){
+        np = (c->col+AXIS_PANEL-1)/AXIS_PANEL;
+        if (par) slach_parallel_for(np, 1, _axisColRange, c);
+        else _axisColRange(c, 0, np);
+    }
+    else if (axis == 1){
+        grain = MAX(1, AXIS_PAR_MIN/4/c->col);
+        if (par) slach_parallel_for(c->row, grain, _axisRowRange, c);
+        else _axisRowRange(c, 0, c->row);
+    }
+    else{
+        perr("In axis reductions, axis must be 0 or 1!\n");
+    }
+}
+
+/** \brief reduction along one axis of a matrix
+ *
+ * \param op: AXIS_SUM, AXIS_MEAN, AXIS_MIN, AXIS_MAX or AXIS_VAR
+ * \param axis: 0 for one result per column, 1 for one result per row
+ * \param 2-dim array, row, col
+ * \param 1-dim array to save result, len
+ * \return
+ *
+ */
+
+void reduceAxis(AxisOp op, int axis, IN float* arr, size_t row, size_t col, OUT float* dest, size_t len){
+    AxisCtx c;
+    if ((int)op < AXIS_SUM || op > AXIS_VAR){
+        perr("In reduceAxis(), unknown op!\n");
+    }
+    if (len != (axis == 0 ? col : row)){
+        perr("The size of src and dest is mismatched! \n");
+    }
+    c.op = op; c.arr = arr; c.row = row; c.col = col; c.dest = dest; c.idx = NULL;
+    _axis(&c, axis);
+}
+
+/** \brief index of the minimum along one axis
+ *
+ * \param axis: 0 for one index per column (a row number), 1 for one per row (a column number)
+ * \param 2-dim array, row, col
+ * \param 1-dim array to save result, len
+ * \return
+ *
+ */
+
+void argminAxis(int axis, IN float* arr, size_t row, size_t col, OUT size_t* dest, size_t len){
+    AxisCtx c;
+    if (len != (axis == 0 ? col : row)){
+        perr("The size of src and dest is mismatched! \n");
+    }
+    c.op = AXIS_ARGMIN; c.arr = arr; c.row = row; c.col = col; c.dest = NULL; c.idx = dest;
+    _axis(&c, axis);
+}
+
+/** \brief index of the maximum along one axis
+ *
+ * \param axis: 0 for one index per column (a row number), 1 for one per row (a column number)
+ * \param 2-dim array, row, col
+ * \param 1-dim array to save result, len
+ * \return
+ *
+ */
+
+void argmaxAxis(int axis, IN float* arr, size_t row, size_t col, OUT size_t* dest, size_t len){
+    AxisCtx c;
+    if (len != (axis == 0 ? col : row)){
+        perr("The size of src and dest is mismatched! \n");
+    }
+    c.op = AXIS_ARGMAX; c.arr = arr; c.row = row; c.col = col; c.dest = NULL; c.idx = dest;
+    _axis(&c, axis);
+}
+
+/** \brief prefix sums along one axis
+ *
+ * \param axis: 0 down each column, 1 along each row
+ * \param exclusive: 0 for inclusive, 1 for exclusive scans
+ * \param 2-dim array, row, col
+ * \param 2-dim array to save result (may be arr), row, col
+ * \return
+ *
+ */
+
+void cumsumAxis(int axis, int exclusive, IN float* arr, size_t row, size_t col,
+                OUT float* dest, size_t height, size_t width){
+    AxisCtx c;
+    if (height != row || width != col){
+        perr("The size of src and dest is mismatched! \n");
+    }
+    c.op = exclusive ? AXIS_XSCAN : AXIS_SCAN;
+    c.arr = arr; c.row = row; c.col = col; c.dest = dest; c.idx = NULL;
+    _axis(&c, axis);
+}
@@ -0,0 +1,414 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/shard.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHARD_MAGIC 0x534c4348u  //"SLCH", set by rank 0 once the header is ready
+#define SHARD_READY 0x534c4352u  //"SLCR", set by rank 0 once every rank joined and the name is gone
+#define SHARD_DEAD 0x534c4344u   //"SLCD", set by rank 0 on a segment left by an earlier job
+#define SHARD_HEADER 4096        //header page, the data starts page aligned
+#define SHARD_TIMEOUT 30000      //ms a rank waits for the others to create or join
+#define SHARD_SPIN 1024          //yields in a barrier before sleeping between polls
+#define SHARD_PAR_MIN (slach_tune()->parMin) //tunable, see tune.h
+
+/*
+first page of the segment. The atomics are lock-free, hence usable from every process that
+maps the page.
+*/
+typedef struct _ShardHeader_{
+    atomic_uint magic;
+    atomic_int joined;     //ranks attached so far
+    atomic_int arrived;    //ranks in the current barrier
+    atomic_uint phase;     //barrier generation
+    int nprocs;
+    size_t bytes;
+}ShardHeader;
+
+struct _SlachShard_{
+    ShardHeader* hdr;
+    char* base;
+    size_t mapped;
+    int rank;
+    int nprocs;
+};
+
+/** \brief sleep for us microseconds, private function
+ *
+ * \param us
+ * \return
+ *
+ */
+
+void _shardSleep(long us){
+    struct timespec ts;
+    ts.tv_sec = us/1000000;
+    ts.tv_nsec = (us%1000000)*1000;
+    nanosleep(&ts, NULL);
+}
+
+/** \brief marks a segment left under name by an earlier job dead and unlinks it, private
+ *   function: ranks that attached to it by mistake see SHARD_DEAD and open the name again
+ *
+ * \param name
+ * \return
+ *
+ */
+
+void _shardReplace(const char* name){
+    struct stat st;
+    ShardHeader* hdr;
+    int fd = shm_open(name, O_RDWR, 0600);
+    if (fd >= 0){
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= SHARD_HEADER){
+            hdr = (ShardHeader*)mmap(NULL, SHARD_HEADER, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (hdr != MAP_FAILED){
+                atomic_store(&hdr->magic, SHARD_DEAD);
+                munmap(hdr, SHARD_HEADER);
+            }
+        }
+        close(fd);
+    }
+    shm_unlink(name);
+}
+
+/** \brief attach a rank other than 0 to the named segment and join, private function
+ *
+ * \param sh
+ * \param name
+ * \param bytes
+ * \param waited: ms spent so far, shared by the attempts
+ * \return 1 when joined, 0 when the segment was stale and the name must be opened again
+ *
+ */
+
+int _shardJoin(SlachShard* sh, const char* name, size_t bytes, long* waited){
+    struct stat st;
+    unsigned int m;
+    int fd;
+    //rank 0 may not have created or sized it yet
+    while ((fd = shm_open(name, O_RDWR, 0600)) < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sh->mapped){
+        if (fd >= 0) close(fd);
+        if (*waited >= SHARD_TIMEOUT) perr("In slach_shard_open(), timed out waiting for rank 0!\n");
+        _shardSleep(1000);
+        (*waited)++;
+    }
+    sh->base = mmap(NULL, sh->mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (sh->base == MAP_FAILED) perr("In slach_shard_open(), mmap failed!\n");
+    sh->hdr = (ShardHeader*)sh->base;
+    //a stale segment may carry SHARD_MAGIC too, so the join only counts once the live rank 0
+    //sets SHARD_READY; a segment already ready belongs to a job that has all its ranks
+    while ((m = atomic_load(&sh->hdr->magic)) != SHARD_MAGIC){
+        if (m == SHARD_DEAD || m == SHARD_READY){
+            munmap(sh->base, sh->mapped);
+            return 0;
+        }
+        if (*waited >= SHARD_TIMEOUT) perr("In slach_shard_open(), timed out waiting for rank 0!\n");
+        _shardSleep(1000);
+        (*waited)++;
+    }
+    if (sh->hdr->nprocs != sh->nprocs || sh->hdr->bytes != bytes)
+        perr("In slach_shard_open(), nprocs or bytes differ from rank 0!\n");
+    atomic_fetch_add(&sh->hdr->joined, 1);
+    while ((m = atomic_load(&sh->hdr->magic)) != SHARD_READY){
+        if (m == SHARD_DEAD){
+            munmap(sh->base, sh->mapped);
+            return 0;
+        }
+        if (*waited >= SHARD_TIMEOUT) perr("In slach_shard_open(), timed out waiting for the other ranks!\n");
+        _shardSleep(1000);
+        (*waited)++;
+    }
+    return 1;
+}
+
+/** \brief open, or create on rank 0, the named segment and wait until every rank is attached
+ *
+ *   Rank 0 unlinks the name before it marks the segment SHARD_READY, so a ready segment can't
+ *   be opened by a later job, and the other ranks return only on SHARD_READY: a rank that
+ *   attached to a segment left by a dead job never joins it and retries when rank 0 replaces it.
+ *
+ * \param name: POSIX shared memory name, "/something"
+ * \param nprocs: cooperating processes
+ * \param rank: this process, 0 creates the segment
+ * \param bytes: data bytes, the same on every rank
+ * \return SlachShard*
+ *
+ */
+
+SlachShard* slach_shard_open(const char* name, int nprocs, int rank, size_t bytes){
+    SlachShard* sh;
+    int fd;
+    long waited = 0;
+    if (name == NULL || nprocs <= 0 || rank < 0 || rank >= nprocs)
+        perr("In slach_shard_open(), needs a name and 0 <= rank < nprocs!\n");
+    sh = slach_malloc(SlachShard, 1);
+    sh->rank = rank; sh->nprocs = nprocs;
+    sh->mapped = SHARD_HEADER + bytes;
+    if (rank != 0){
+        while (!_shardJoin(sh, name, bytes, &waited));
+        return sh;
+    }
+    //a segment left by a job that died during setup is replaced
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST){
+        _shardReplace(name);
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0 || ftruncate(fd, (off_t)sh->mapped) != 0) perr("In slach_shard_open(), can't create the segment!\n");
+    sh->base = mmap(NULL, sh->mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (sh->base == MAP_FAILED) perr("In slach_shard_open(), mmap failed!\n");
+    sh->hdr = (ShardHeader*)sh->base;
+    sh->hdr->nprocs = nprocs;
+    sh->hdr->bytes = bytes;
+    atomic_store(&sh->hdr->joined, 1);
+    atomic_store(&sh->hdr->arrived, 0);
+    atomic_store(&sh->hdr->phase, 0);
+    atomic_store(&sh->hdr->magic, SHARD_MAGIC);
+    for (; atomic_load(&sh->hdr->joined) < nprocs; waited++){
+        if (waited >= SHARD_TIMEOUT) perr("In slach_shard_open(), timed out waiting for the other ranks!\n");
+        _shardSleep(1000);
+    }
+    shm_unlink(name);
+    atomic_store(&sh->hdr->magic, SHARD_READY);
+    return sh;
+}
+
+/** \brief leave the group after a last barrier and unmap the segment
+ *
+ * \param sh
+ * \return
+ *
+ */
+
+void slach_shard_close(SlachShard* sh){
+    if (sh == NULL) return;
+    slach_shard_barrier(sh);
+    munmap(sh->base, sh->mapped);
+    slach_free(sh);
+}
+
+/** \brief start of the data area, page aligned
+ *
+ * \param sh
+ * \return void*
+ *
+ */
+
+void* slach_shard_data(SlachShard* sh){
+    return sh->base + SHARD_HEADER;
+}
+
+/** \brief wait until every rank has reached the barrier
+ *
+ *   Sense by generation: the last rank to arrive resets the count and bumps the phase the
+ *   others poll, yielding first and then sleeping so a long wait costs no core.
+ *
+ * \param sh
+ * \return
+ *
+ */
+
+void slach_shard_barrier(SlachShard* sh){
+    unsigned int ph = atomic_load(&sh->hdr->phase);
+    int spin = 0;
+    if (atomic_fetch_add(&sh->hdr->arrived, 1) == sh->nprocs - 1){
+        atomic_store(&sh->hdr->arrived, 0);
+        atomic_fetch_add(&sh->hdr->phase, 1);
+        return;
+    }
+    while (atomic_load(&sh->hdr->phase) == ph){
+        if (++spin < SHARD_SPIN) sched_yield();
+        else _shardSleep(50);
+    }
+}
+
+/** \brief the slice of n items owned by this rank, balanced to within one item
+ *
+ * \param sh, n
+ * \param begin, end: [begin, end)
+ * \return
+ *
+ */
+
+void slach_shard_range(SlachShard* sh, size_t n, size_t* begin, size_t* end){
+    *begin = n*sh->rank/sh->nprocs;
+    *end = n*(sh->rank+1)/sh->nprocs;
+}
+
+/** \brief C = epilogue(alpha*op(A)*op(B) + beta*C), every rank computing its block of C
+ *
+ *   Each rank only writes its own rows (or columns) of C, so with first touch its pages stay
+ *   on its node, and reads the part of A (or B) it needs.
+ *
+ * \param sh
+ * \param transA, transB, m, n, k, A, lda, B, ldb, C, ldc, ep: as in gemmEx
+ * \return
+ *
+ */
+
+void slach_shard_gemmEx(SlachShard* sh, int transA, int transB, size_t m, size_t n, size_t k,
+                        IN float* A, size_t lda, IN float* B, size_t ldb, INOUT float* C, size_t ldc,
+                        IN const GemmEpilogue* ep){
+    GemmEpilogue e;
+    size_t b, f;
+    if (ep != NULL) e = *ep;
+    else gemmEpilogueInit(&e);
+    if (m >= n){
+        slach_shard_range(sh, m, &b, &f);
+        if (e.colBias != NULL) e.colBias += b;
+        if (f > b) gemmEx(transA, transB, f-b, n, k, transA ? A + b : A + b*lda, lda, B, ldb, C + b*ldc, ldc, &e);
+    }
+    else{
+        slach_shard_range(sh, n, &b, &f);
+        if (e.rowBias != NULL) e.rowBias += b;
+        if (f > b) gemmEx(transA, transB, m, f-b, k, A, lda, transB ? B + b*ldb : B + b, ldb, C + b, ldc, &e);
+    }
+    slach_shard_barrier(sh);
+}
+
+typedef struct _ShardFftCtx_{
+    int phase;          //0: column transforms, 1: row transforms, 2: transpose out
+    int N, N1, N2;
+    size_t first;       //first item of this rank's slice
+    complex* input;
+    complex* work;
+    complex* output;
+}ShardFftCtx;
+
+/** \brief DFT of len points in place, radix-2 when len is a power of two, private function
+ *
+ * \param x, len
+ * \return
+ *
+ */
+
+void _shardDft(complex* x, int len){
+    complex* X;
+    if ((len & (len-1)) == 0){
+        fftRadix2(x, len, 0);
+        return;
+    }
+    X = DFT_naive(x, len);
+    memcpy(x, X, len*sizeof(complex));
+    slach_free(X);
+}
+
+/** \brief slach_shard_fft body for items [i0, i1) of this rank's slice, private function
+ *
+ *   phase 0: column k1 (input[N1*k2 + k1] over k2) is transformed, twiddled and stored
+ *            contiguously as output[k1*N2 + k2]
+ *   phase 1: row k2 (output[k1*N2 + k2] over k1) is transformed into work[k2*N1 + k1]
+ *   phase 2: output[N2*k1 + k2] = work[k2*N1 + k1] for the rank's k1
+ *   so every rank writes contiguous memory of its own in every phase.
+ *
+ * \param arg: ShardFftCtx
+ * \param i0, i1: offsets in the slice
+ * \return
+ *
+ */
+
+void _shardFftRange(void* arg, size_t i0, size_t i1){
+    ShardFftCtx* c = (ShardFftCtx*)arg;
+    complex* x = slach_malloc(complex, MAX(c->N1, c->N2));
+    complex t;
+    size_t i;
+    int k1, k2;
+    double ang;
+    for (i=c->first+i0; i<c->first+i1; i++){
+        if (c->phase == 0){
+            k1 = (int)i;
+            for (k2=0; k2<c->N2; k2++) x[k2] = c->input[c->N1*k2 + k1];
+            _shardDft(x, c->N2);
+            for (k2=0; k2<c->N2; k2++){
+                ang = -2.0*PI*k1*k2/c->N;
+                t.re = (float)(x[k2].re*cos(ang) - x[k2].im*sin(ang));
+                t.im = (float)(x[k2].re*sin(ang) + x[k2].im*cos(ang));
+                c->output[(size_t)k1*c->N2 + k2] = t;
+            }
+        }
+        else if (c->phase == 1){
+            k2 = (int)i;
+            for (k1=0; k1<c->N1; k1++) x[k1] = c->output[(size_t)k1*c->N2 + k2];
+            _shardDft(x, c->N1);
+            memcpy(c->work + (size_t)k2*c->N1, x, c->N1*sizeof(complex));
+        }
+        else{
+            k1 = (int)i;
+            for (k2=0; k2<c->N2; k2++) c->output[(size_t)c->N2*k1 + k2] = c->work[(size_t)k2*c->N1 + k1];
+        }
+    }
+    slach_free(x);
+}
+
+/** \brief the Cooley-Tukey FFT of FFT_CooleyTukey, sharded over ranks and their threads
+ *
+ * \param sh
+ * \param input: N points
+ * \param N = N1*N2
+ * \param work: N points of scratch in the segment
+ * \param output: N points in the segment, must not overlap input
+ * \return
+ *
+ */
+
+void slach_shard_fft(SlachShard* sh, IN complex* input, int N, int N1, int N2, complex* work, OUT complex* output){
+    ShardFftCtx c;
+    size_t b, f;
+    if (N <= 0 || N1 <= 0 || N2 <= 0 || N != N1*N2) perr("In slach_shard_fft(), N must be N1*N2!\n");
+    c.N = N; c.N1 = N1; c.N2 = N2;
+    c.input = input; c.work = work; c.output = output;
+    for (c.phase=0; c.phase<3; c.phase++){
+        slach_shard_range(sh, c.phase == 1 ? N2 : N1, &b, &f);
+        c.first = b;
+        slach_parallel_for(f-b, MAX((size_t)1, SHARD_PAR_MIN/((size_t)N1 + N2)/MAX(N1, N2)), _shardFftRange, &c);
+        slach_shard_barrier(sh);
+    }
+}
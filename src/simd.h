@@ -0,0 +1,144 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+/*
+Private header: a thin SIMD layer shared by the kernels in src/. The vector
+width is chosen at compile time from the target flags (AVX, SSE2 or plain
+scalar), so building with -march=native picks the widest supported path.
+This header is not installed; user code should only include the headers in include/.
+*/
+
+#ifndef SIMD_H_
+#define SIMD_H_
+
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define SLACH_INLINE __inline
+#else
+#define SLACH_INLINE
+#endif
+
+#if defined(__AVX__) && !defined(SLACH_NO_SIMD)
+#include <immintrin.h>
+#define SLACH_VLEN 8
+#define SLACH_ISA "avx"
+typedef __m256 vfloat;
+#define vfZero()        _mm256_setzero_ps()
+#define vfSet1(x)       _mm256_set1_ps(x)
+#define vfLoad(p)       _mm256_loadu_ps(p)
+#define vfStore(p, v)   _mm256_storeu_ps((p), (v))
+#define vfAdd(a, b)     _mm256_add_ps((a), (b))
+#define vfSub(a, b)     _mm256_sub_ps((a), (b))
+#define vfMul(a, b)     _mm256_mul_ps((a), (b))
+#define vfDiv(a, b)     _mm256_div_ps((a), (b))
+#define vfMin(a, b)     _mm256_min_ps((a), (b))
+#define vfMax(a, b)     _mm256_max_ps((a), (b))
+#define vfSqrt(a)       _mm256_sqrt_ps(a)
+#define vfAbs(a)        _mm256_andnot_ps(_mm256_set1_ps(-0.0f), (a))
+#if defined(__FMA__)
+#define vfFmadd(a, b, c) _mm256_fmadd_ps((a), (b), (c))
+#else
+#define vfFmadd(a, b, c) _mm256_add_ps(_mm256_mul_ps((a), (b)), (c))
+#endif
+static SLACH_INLINE float vfHsum(vfloat v){
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+    return _mm_cvtss_f32(lo);
+}
+static SLACH_INLINE float vfHmax(vfloat v){
+    __m128 lo = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    lo = _mm_max_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_max_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+    return _mm_cvtss_f32(lo);
+}
+
+#elif defined(__SSE2__) && !defined(SLACH_NO_SIMD)
+#include <emmintrin.h>
+#define SLACH_VLEN 4
+#define SLACH_ISA "sse2"
+typedef __m128 vfloat;
+#define vfZero()        _mm_setzero_ps()
+#define vfSet1(x)       _mm_set1_ps(x)
+#define vfLoad(p)       _mm_loadu_ps(p)
+#define vfStore(p, v)   _mm_storeu_ps((p), (v))
+#define vfAdd(a, b)     _mm_add_ps((a), (b))
+#define vfSub(a, b)     _mm_sub_ps((a), (b))
+#define vfMul(a, b)     _mm_mul_ps((a), (b))
+#define vfDiv(a, b)     _mm_div_ps((a), (b))
+#define vfMin(a, b)     _mm_min_ps((a), (b))
+#define vfMax(a, b)     _mm_max_ps((a), (b))
+#define vfSqrt(a)       _mm_sqrt_ps(a)
+#define vfAbs(a)        _mm_andnot_ps(_mm_set1_ps(-0.0f), (a))
+#define vfFmadd(a, b, c) _mm_add_ps(_mm_mul_ps((a), (b)), (c))
+static SLACH_INLINE float vfHsum(vfloat v){
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+static SLACH_INLINE float vfHmax(vfloat v){
+    v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+#else
+#define SLACH_VLEN 1
+#define SLACH_ISA "scalar"
+typedef float vfloat;
+#define vfZero()        0.0f
+#define vfSet1(x)       ((float)(x))
+#define vfLoad(p)       (*(p))
+#define vfStore(p, v)   (*(p) = (v))
+#define vfAdd(a, b)     ((a)+(b))
+#define vfSub(a, b)     ((a)-(b))
+#define vfMul(a, b)     ((a)*(b))
+#define vfDiv(a, b)     ((a)/(b))
+#define vfMin(a, b)     MIN((a), (b))
+#define vfMax(a, b)     MAX((a), (b))
+#define vfSqrt(a)       ((float)sqrt((double)(a)))
+#define vfAbs(a)        ((float)fabs((double)(a)))
+#define vfFmadd(a, b, c) ((a)*(b)+(c))
+#define vfHsum(v)       (v)
+#define vfHmax(v)       (v)
+#endif
+
+#endif
@@ -0,0 +1,402 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/sketch.h"
+#include "../include/GEMM.h"
+#include "../include/QRD.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+#include "simd.h"
+
+#define SKETCH_PAR_MIN (slach_tune()->parMin) //tunable, see tune.h
+#define FWHT_BLOCK 8192         //floats of a row block whose first stages run while it is in L1
+#define SKETCH_SRHT_BLOCK (1<<20) //floats of the padded copy one SRHT column block transforms
+#define SKETCH_SPARSE_NNZ 4     //default nonzeros per column of a sparse JL sketch
+
+struct _SlachSketch_{
+    SketchType type;
+    size_t s, n, nnz;
+    size_t np2;      //SRHT: n padded to a power of two
+    size_t* rows;    //SRHT: the s sampled rows of H; sparse: nnz rows of SA for every row of A
+    float* vals;     //SRHT: the signs D; sparse: signed weights; Gaussian: S itself
+};
+
+typedef struct _FwhtCtx_{
+    float* X;
+    size_t n, d, ld, h, B;
+}FwhtCtx;
+
+/** \brief a, b = a + b, a - b over len floats, private function
+ *
+ * \param a, b, len
+ * \return
+ *
+ */
+
+void _fwhtRows(float* a, float* b, size_t len){
+    size_t j;
+    vfloat va, vb;
+    float x, y;
+    for (j=0; j+SLACH_VLEN<=len; j+=SLACH_VLEN){
+        va = vfLoad(a+j); vb = vfLoad(b+j);
+        vfStore(a+j, vfAdd(va, vb));
+        vfStore(b+j, vfSub(va, vb));
+    }
+    for (; j<len; j++){
+        x = a[j]; y = b[j];
+        a[j] = x + y; b[j] = x - y;
+    }
+}
+
+/** \brief butterflies [p0, p1) of the stage with half width h, private function
+ *
+ *   Pair p joins row (p/h)*2h + p%h with the row h below it. Runs of pairs are contiguous,
+ *   and so are their rows when ld == d, so they go to _fwhtRows as one span.
+ *
+ * \param X, d, ld: the matrix
+ * \param h: half width
+ * \param p0, p1: pairs
+ * \return
+ *
+ */
+
+void _fwhtStage(float* X, size_t d, size_t ld, size_t h, size_t p0, size_t p1){
+    size_t p, j, len, r;
+    for (p=p0; p<p1; p+=len){
+        j = (p/h)*2*h + p%h;
+        len = MIN(p1 - p, h - p%h);
+        if (ld == d) _fwhtRows(X + j*d, X + (j+h)*d, len*d);
+        else{
+            for (r=0; r<len; r++) _fwhtRows(X + (j+r)*ld, X + (j+r+h)*ld, d);
+        }
+    }
+}
+
+/** \brief fwhtEx task: every stage below B on row blocks [b0, b1), private function
+ *
+ * \param ctx: FwhtCtx
+ * \param b0, b1: blocks of B rows
+ * \return
+ *
+ */
+
+void _fwhtBlockRange(void* ctx, size_t b0, size_t b1){
+    FwhtCtx* c = (FwhtCtx*)ctx;
+    size_t b, h;
+    for (b=b0; b<b1; b++){
+        for (h=1; h<c->B; h<<=1) _fwhtStage(c->X + b*c->B*c->ld, c->d, c->ld, h, 0, c->B/2);
+    }
+}
+
+/** \brief fwhtEx task: pairs [p0, p1) of stage c->h, private function
+ *
+ * \param ctx: FwhtCtx
+ * \param p0, p1: pairs
+ * \return
+ *
+ */
+
+void _fwhtPairRange(void* ctx, size_t p0, size_t p1){
+    FwhtCtx* c = (FwhtCtx*)ctx;
+    _fwhtStage(c->X, c->d, c->ld, c->h, p0, p1);
+}
+
+/** \brief in-place unnormalized Walsh-Hadamard transform of every column of a matrix
+ *
+ *   The stages narrower than a cache-sized block of rows all run on one block before the
+ *   next, the wider ones sweep the whole matrix split over the thread pool.
+ *
+ * \param n: rows, a power of two
+ * \param d: columns
+ * \param X, ld: row-major matrix
+ * \return
+ *
+ */
+
+void fwhtEx(size_t n, size_t d, INOUT float* X, size_t ld){
+    FwhtCtx c;
+    size_t grain;
+    if (n == 0 || (n & (n-1)) != 0) perr("In fwhtEx(), n must be a power of two!\n");
+    if (X == NULL || ld < d) perr("In fwhtEx(), X is NULL or ld < d!\n");
+    if (n == 1 || d == 0) return;
+    c.X = X; c.n = n; c.d = d; c.ld = ld;
+    for (c.B=2; c.B<n && 2*c.B*d<=FWHT_BLOCK; c.B<<=1);
+    grain = MAX((size_t)1, SKETCH_PAR_MIN/d);
+    slach_parallel_for(n/c.B, MAX((size_t)1, grain/c.B), _fwhtBlockRange, &c);
+    for (c.h=c.B; c.h<n; c.h<<=1) slach_parallel_for(n/2, grain, _fwhtPairRange, &c);
+}
+
+/** \brief in-place unnormalized Walsh-Hadamard transform of a vector
+ *
+ * \param x: n floats
+ * \param n: a power of two
+ * \return
+ *
+ */
+
+void fwht(INOUT float* x, size_t n){
+    fwhtEx(n, 1, x, 1);
+}
+
+/** \brief random integer in [0, n) from the slach RNG, private function
+ *
+ * \param n: <= INT_MAX
+ * \return size_t
+ *
+ */
+
+size_t _sketchRandIdx(size_t n){
+    return (size_t)slach_rand_int_range_1(0, (int)n);
+}
+
+/** \brief draws a sketch
+ *
+ * \param type: SKETCH_SRHT, SKETCH_COUNT, SKETCH_SPARSE_JL or SKETCH_GAUSSIAN
+ * \param s: rows of the sketch, at most n for SKETCH_SRHT after padding
+ * \param n: rows of the matrices it applies to
+ * \param nnz: SKETCH_SPARSE_JL only, in [1, s], 0 for the default
+ * \return SlachSketch*: free with sketchDestroy
+ *
+ */
+
+SlachSketch* sketchCreate(SketchType type, size_t s, size_t n, size_t nnz){
+    SlachSketch* S;
+    size_t i, j, p, t;
+    size_t* perm;
+    float w;
+    if (s == 0 || n == 0) perr("In sketchCreate(), s and n must be positive!\n");
+    if (n > INT_MAX || s > INT_MAX) perr("In sketchCreate(), n and s must fit the RNG range!\n");
+    S = slach_malloc(struct _SlachSketch_, 1);
+    S->type = type; S->s = s; S->n = n;
+    if (type == SKETCH_SRHT){
+        for (S->np2=1; S->np2<n; S->np2<<=1);
+        if (s > S->np2) perr("In sketchCreate(), an SRHT can't have more rows than its padded size!\n");
+        if (S->np2 > INT_MAX) perr("In sketchCreate(), n must fit the RNG range!\n");
+        S->vals = slach_malloc(float, n);
+        for (i=0; i<n; i++) S->vals[i] = slach_rand_int_range_1(0, 2) ? 1.0f : -1.0f;
+        //partial Fisher-Yates: the first s entries become the sample
+        perm = slach_malloc(size_t, S->np2);
+        for (i=0; i<S->np2; i++) perm[i] = i;
+        for (i=0; i<s; i++){
+            j = i + _sketchRandIdx(S->np2 - i);
+            t = perm[i]; perm[i] = perm[j]; perm[j] = t;
+        }
+        S->rows = slach_malloc(size_t, s);
+        memcpy(S->rows, perm, s*sizeof(size_t));
+        slach_free(perm);
+    }
+    else if (type == SKETCH_COUNT || type == SKETCH_SPARSE_JL){
+        S->nnz = type == SKETCH_COUNT ? 1 : (nnz == 0 ? MIN(s, (size_t)SKETCH_SPARSE_NNZ) : nnz);
+        if (S->nnz > s) perr("In sketchCreate(), nnz can't exceed s!\n");
+        w = (float)(1/sqrt((double)S->nnz));
+        S->rows = slach_malloc(size_t, n*S->nnz);
+        S->vals = slach_malloc(float, n*S->nnz);
+        for (i=0; i<n; i++){
+            for (p=0; p<S->nnz; p++){
+                //distinct rows, nnz is small so redrawing is cheap
+                do{
+                    S->rows[i*S->nnz+p] = _sketchRandIdx(s);
+                    for (j=0; j<p && S->rows[i*S->nnz+j] != S->rows[i*S->nnz+p]; j++);
+                }while (j < p);
+                S->vals[i*S->nnz+p] = slach_rand_int_range_1(0, 2) ? w : -w;
+            }
+        }
+    }
+    else if (type == SKETCH_GAUSSIAN){
+        w = (float)(1/sqrt((double)s));
+        S->vals = slach_malloc(float, s*n);
+        for (i=0; i<s*n; i++) S->vals[i] = gaussRand(0, w);
+    }
+    else perr("In sketchCreate(), unknown sketch type!\n");
+    return S;
+}
+
+/** \brief frees a sketch
+ *
+ * \param S
+ * \return
+ *
+ */
+
+void sketchDestroy(SlachSketch* S){
+    if (S == NULL) return;
+    if (S->rows != NULL) slach_free(S->rows);
+    if (S->vals != NULL) slach_free(S->vals);
+    slach_free(S);
+}
+
+typedef struct _SketchCtx_{
+    const SlachSketch* S;
+    size_t d, lda, ldsa, w;
+    float* A;
+    float* SA;
+}SketchCtx;
+
+/** \brief sketchApply task for SRHT: column blocks [b0, b1), private function
+ *
+ *   A block of columns is copied with the signs D into a zero padded np2 x w buffer,
+ *   transformed with fwhtEx and the sampled rows are scaled into SA.
+ *
+ * \param ctx: SketchCtx
+ * \param b0, b1: blocks of w columns
+ * \return
+ *
+ */
+
+void _sketchSrhtRange(void* ctx, size_t b0, size_t b1){
+    SketchCtx* c = (SketchCtx*)ctx;
+    const SlachSketch* S = c->S;
+    float* buf = slach_malloc(float, S->np2*c->w);
+    float scale = (float)(1/sqrt((double)S->s));
+    size_t b, j0, w, i, j;
+    float* src;
+    float* dst;
+    for (b=b0; b<b1; b++){
+        j0 = b*c->w;
+        w = MIN(c->w, c->d - j0);
+        for (i=0; i<S->n; i++){
+            src = c->A + i*c->lda + j0;
+            for (j=0; j<w; j++) buf[i*w+j] = S->vals[i]*src[j];
+        }
+        memset(buf + S->n*w, 0, (S->np2 - S->n)*w*sizeof(float));
+        fwhtEx(S->np2, w, buf, w);
+        for (i=0; i<S->s; i++){
+            src = buf + S->rows[i]*w;
+            dst = c->SA + i*c->ldsa + j0;
+            for (j=0; j<w; j++) dst[j] = scale*src[j];
+        }
+    }
+    slach_free(buf);
+}
+
+/** \brief sketchApply task for the sparse sketches: column blocks [b0, b1), private function
+ *
+ *   Blocks own their columns of SA, so the scattered adds of different tasks never meet.
+ *
+ * \param ctx: SketchCtx
+ * \param b0, b1: blocks of w columns
+ * \return
+ *
+ */
+
+void _sketchSparseRange(void* ctx, size_t b0, size_t b1){
+    SketchCtx* c = (SketchCtx*)ctx;
+    const SlachSketch* S = c->S;
+    size_t b, j0, w, i, p, j;
+    float* src;
+    float* dst;
+    float v;
+    vfloat vv;
+    for (b=b0; b<b1; b++){
+        j0 = b*c->w;
+        w = MIN(c->w, c->d - j0);
+        for (i=0; i<S->s; i++) memset(c->SA + i*c->ldsa + j0, 0, w*sizeof(float));
+        for (i=0; i<S->n; i++){
+            src = c->A + i*c->lda + j0;
+            for (p=0; p<S->nnz; p++){
+                dst = c->SA + S->rows[i*S->nnz+p]*c->ldsa + j0;
+                v = S->vals[i*S->nnz+p];
+                vv = vfSet1(v);
+                for (j=0; j+SLACH_VLEN<=w; j+=SLACH_VLEN) vfStore(dst+j, vfFmadd(vv, vfLoad(src+j), vfLoad(dst+j)));
+                for (; j<w; j++) dst[j] += v*src[j];
+            }
+        }
+    }
+}
+
+/** \brief SA = S*A
+ *
+ * \param S: s x n sketch
+ * \param d: columns of A
+ * \param A, lda: n x d row-major
+ * \param SA, ldsa: s x d row-major, must not overlap A
+ * \return
+ *
+ */
+
+void sketchApply(const SlachSketch* S, size_t d, IN float* A, size_t lda, OUT float* SA, size_t ldsa){
+    SketchCtx c;
+    if (S == NULL || A == NULL || SA == NULL) perr("In sketchApply(), S, A and SA can't be NULL!\n");
+    if (lda < d || ldsa < d) perr("In sketchApply(), leading dimension is too small!\n");
+    if (d == 0) return;
+    c.S = S; c.d = d; c.A = A; c.lda = lda; c.SA = SA; c.ldsa = ldsa;
+    if (S->type == SKETCH_GAUSSIAN){
+        gemmEx(0, 0, S->s, d, S->n, S->vals, S->n, A, lda, SA, ldsa, NULL);
+    }
+    else if (S->type == SKETCH_SRHT){
+        c.w = MIN(d, MAX((size_t)SLACH_VLEN, SKETCH_SRHT_BLOCK/S->np2));
+        slach_parallel_for((d + c.w - 1)/c.w, 1, _sketchSrhtRange, &c);
+    }
+    else{
+        //column blocks of 64 keep whole cache lines per task, a narrow A runs as one block
+        c.w = 64;
+        slach_parallel_for((d + c.w - 1)/c.w, 1, _sketchSparseRange, &c);
+    }
+}
+
+/** \brief sketch-and-solve least squares: min |SAX - SB| for the X of min |AX - B|
+ *
+ * \param type: sketch, see sketchCreate
+ * \param s: sketch rows, col1 <= s
+ * \param arr1, row1, col1: A, row1 >= col1
+ * \param arr2, row2, col2: B, row2 == row1
+ * \param dest, height, width: X, col1 x col2
+ * \return
+ *
+ */
+
+void sketchSolve(SketchType type, size_t s, INOUT float* arr1, size_t row1, size_t col1,
+                 INOUT float* arr2, size_t row2, size_t col2, OUT float* dest, size_t height, size_t width){
+    SlachSketch* S;
+    float* SA;
+    float* SB;
+    if (row2 != row1) perr("In sketchSolve(), row2 != row1\n");
+    if (height != col1 || width != col2) perr("The size of src and dest is mismatched! \n");
+    if (s < col1) perr("In sketchSolve(), the sketch needs at least col1 rows!\n");
+    S = sketchCreate(type, s, row1, 0);
+    SA = slach_malloc(float, s*col1);
+    SB = slach_malloc(float, s*col2);
+    sketchApply(S, col1, arr1, col1, SA, col1);
+    sketchApply(S, col2, arr2, col2, SB, col2);
+    QRsolvem(SA, s, col1, SB, s, col2, dest, height, width);
+    slach_free(SA);
+    slach_free(SB);
+    sketchDestroy(S);
+}
@@ -0,0 +1,296 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/GEMM.h"
+#include "../include/parallel.h"
+#include "../include/tune.h"
+#include "simd.h"
+
+/*
+Strassen-Winograd on top of the GEMM engine: 7 half-size products and 15 block additions
+per level, scheduled as in Boyer, Dumas, Pernet and Zhou (ISSAC 2009) so that one level
+only needs two temporaries X (max(m/2*k/2, m/2*n/2)) and Y (k/2*n/2) besides the four
+quadrants of C. The recursion stops when a dimension drops to STRASSEN_CUTOFF, where
+the classical engine runs at full speed; odd dimensions are peeled off and fixed up
+with thin classical products.
+
+Workspace: one block is allocated per call, sized for every level of the recursion,
+    sum over levels of (X+Y) <= (m*k + m*n + k*n)/3 floats
+plus m*n floats when the epilogue reads C (beta != 0).
+
+Error bound (Higham, Accuracy and Stability of Numerical Algorithms, 2nd ed., 23.2.2),
+for n x n operands, recursion stopping at n0 and unit roundoff u = FLT_EPSILON/2:
+    max|C - fl(C)| <= [ (n/n0)^log2(18) * (n0^2 + 6*n0) - 6*n ] * u * max|A| * max|B|
+This bound is normwise, unlike the componentwise |C - fl(C)| <= k*u*|A|*|B| of the
+classical product, so small entries of C can lose relative accuracy. Every level
+deeper multiplies the growth by about 18/4; keep the cutoff large.
+*/
+#define STRASSEN_CUTOFF (slach_tune()->strassenCutoff)   //tunable, see tune.h
+#define STRASSEN_AUTO_MIN (slach_tune()->strassenAutoMin)
+
+static GemmAlgo gemmAlgo = GEMM_ALGO_AUTO;
+
+/** \brief choose the algorithm used by mmMul and mmMulEx
+ *
+ * \param algo: GEMM_ALGO_AUTO (Strassen for very large products), GEMM_ALGO_CLASSIC or GEMM_ALGO_STRASSEN
+ * \return
+ *
+ */
+
+void gemmSetAlgo(GemmAlgo algo){
+    gemmAlgo = algo;
+}
+
+/** \brief algorithm used by mmMul and mmMulEx
+ *
+ * \param empty
+ * \return GemmAlgo
+ *
+ */
+
+GemmAlgo gemmGetAlgo(void){
+    return gemmAlgo;
+}
+
+/** \brief whether the current algorithm setting picks Strassen for a m x n x k product
+ *
+ * \param m, n, k
+ * \return 0/1
+ *
+ */
+
+int gemmUseStrassen(size_t m, size_t n, size_t k){
+    switch (gemmAlgo){
+        case GEMM_ALGO_STRASSEN: return 1;
+        case GEMM_ALGO_CLASSIC:  return 0;
+        default:                 return MIN(m, MIN(n, k)) >= STRASSEN_AUTO_MIN && !slach_get_reproducible();
+    }
+}
+
+/** \brief pointer to block (i, j) of op(X), private function
+ *
+ * \param X, ld, trans, i, j
+ * \return float*
+ *
+ */
+
+float* _strassenAt(float* X, size_t ld, int trans, size_t i, size_t j){
+    return trans ? X+j*ld+i : X+i*ld+j;
+}
+
+/** \brief Z = X + sign*Y on r x c blocks of op(.) stored with the same trans, private function
+ *
+ * \param trans, r, c
+ * \param X, ldx, Y, ldy, sign: 1 or -1
+ * \param Z, ldz: may alias X or Y
+ * \return
+ *
+ */
+
+void _strassenAdd(int trans, size_t r, size_t c, float* X, size_t ldx, float* Y, size_t ldy,
+                  float sign, float* Z, size_t ldz){
+    size_t i, j, t;
+    if (trans){
+        t = r; r = c; c = t;
+    }
+    for (i=0; i<r; i++){
+        if (sign > 0){
+            for (j=0; j+SLACH_VLEN<=c; j+=SLACH_VLEN){
+                vfStore(Z+i*ldz+j, vfAdd(vfLoad(X+i*ldx+j), vfLoad(Y+i*ldy+j)));
+            }
+        }
+        else{
+            for (j=0; j+SLACH_VLEN<=c; j+=SLACH_VLEN){
+                vfStore(Z+i*ldz+j, vfSub(vfLoad(X+i*ldx+j), vfLoad(Y+i*ldy+j)));
+            }
+        }
+        for (; j<c; j++){
+            Z[i*ldz+j] = X[i*ldx+j] + sign*Y[i*ldy+j];
+        }
+    }
+}
+
+/** \brief workspace of a recursion on m x n x k, private function
+ *
+ * \param m, n, k
+ * \return size_t: floats
+ *
+ */
+
+size_t _strassenWork(size_t m, size_t n, size_t k){
+    size_t m2 = m/2, n2 = n/2, k2 = k/2;
+    if (MIN(m, MIN(n, k)) <= STRASSEN_CUTOFF){
+        return 0;
+    }
+    return MAX(m2*k2, m2*n2) + k2*n2 + _strassenWork(m2, n2, k2);
+}
+
+/** \brief C = op(A)*op(B), recursive Strassen-Winograd step, private function
+ *
+ * \param tA, tB, m, n, k, A, lda, B, ldb, C, ldc: as in gemmEx
+ * \param work: _strassenWork(m, n, k) floats
+ * \return
+ *
+ */
+
+void _strassen(int tA, int tB, size_t m, size_t n, size_t k, float* A, size_t lda,
+               float* B, size_t ldb, float* C, size_t ldc, float* work){
+    size_t m2 = m/2, n2 = n/2, k2 = k/2;
+    float *A11, *A12, *A21, *A22, *B11, *B12, *B21, *B22, *C11, *C12, *C21, *C22;
+    float* X; float* Y; float* sub;
+    size_t ldx, ldy;
+    GemmEpilogue acc;
+    if (MIN(m, MIN(n, k)) <= STRASSEN_CUTOFF){
+        gemmEx(tA, tB, m, n, k, A, lda, B, ldb, C, ldc, NULL);
+        return;
+    }
+    A11 = A; A12 = _strassenAt(A, lda, tA, 0, k2);
+    A21 = _strassenAt(A, lda, tA, m2, 0); A22 = _strassenAt(A, lda, tA, m2, k2);
+    B11 = B; B12 = _strassenAt(B, ldb, tB, 0, n2);
+    B21 = _strassenAt(B, ldb, tB, k2, 0); B22 = _strassenAt(B, ldb, tB, k2, n2);
+    C11 = C; C12 = C+n2; C21 = C+m2*ldc; C22 = C21+n2;
+    //X holds the S_i (stored like A) and later P1 (m2 x n2), Y holds the T_i (stored like B)
+    X = work; Y = X+MAX(m2*k2, m2*n2); sub = Y+k2*n2;
+    ldx = tA ? m2 : k2; ldy = tB ? k2 : n2;
+
+    _strassenAdd(tA, m2, k2, A11, lda, A21, lda, -1, X, ldx);         //S3 = A11 - A21
+    _strassenAdd(tB, k2, n2, B22, ldb, B12, ldb, -1, Y, ldy);         //T3 = B22 - B12
+    _strassen(tA, tB, m2, n2, k2, X, ldx, Y, ldy, C21, ldc, sub);     //P7 = S3*T3 -> C21
+    _strassenAdd(tA, m2, k2, A21, lda, A22, lda, 1, X, ldx);          //S1 = A21 + A22
+    _strassenAdd(tB, k2, n2, B12, ldb, B11, ldb, -1, Y, ldy);         //T1 = B12 - B11
+    _strassen(tA, tB, m2, n2, k2, X, ldx, Y, ldy, C22, ldc, sub);     //P5 = S1*T1 -> C22
+    _strassenAdd(tA, m2, k2, X, ldx, A11, lda, -1, X, ldx);           //S2 = S1 - A11
+    _strassenAdd(tB, k2, n2, B22, ldb, Y, ldy, -1, Y, ldy);           //T2 = B22 - T1
+    _strassen(tA, tB, m2, n2, k2, X, ldx, Y, ldy, C12, ldc, sub);     //P6 = S2*T2 -> C12
+    _strassenAdd(tA, m2, k2, A12, lda, X, ldx, -1, X, ldx);           //S4 = A12 - S2
+    _strassen(tA, tB, m2, n2, k2, X, ldx, B22, ldb, C11, ldc, sub);   //P3 = S4*B22 -> C11
+    _strassen(tA, tB, m2, n2, k2, A11, lda, B11, ldb, X, n2, sub);    //P1 = A11*B11 -> X
+    _strassenAdd(0, m2, n2, C12, ldc, X, n2, 1, C12, ldc);            //U2 = P1 + P6
+    _strassenAdd(0, m2, n2, C21, ldc, C12, ldc, 1, C21, ldc);         //U3 = U2 + P7
+    _strassenAdd(0, m2, n2, C12, ldc, C22, ldc, 1, C12, ldc);         //U4 = U2 + P5
+    _strassenAdd(0, m2, n2, C21, ldc, C22, ldc, 1, C22, ldc);         //U7 = U3 + P5 = C22
+    _strassenAdd(0, m2, n2, C12, ldc, C11, ldc, 1, C12, ldc);         //U5 = U4 + P3 = C12
+    _strassenAdd(tB, k2, n2, Y, ldy, B21, ldb, -1, Y, ldy);           //T4 = T2 - B21
+    _strassen(tA, tB, m2, n2, k2, A22, lda, Y, ldy, C11, ldc, sub);   //P4 = A22*T4 -> C11
+    _strassenAdd(0, m2, n2, C21, ldc, C11, ldc, -1, C21, ldc);        //U6 = U3 - P4 = C21
+    _strassen(tA, tB, m2, n2, k2, A12, lda, B21, ldb, C11, ldc, sub); //P2 = A12*B21 -> C11
+    _strassenAdd(0, m2, n2, C11, ldc, X, n2, 1, C11, ldc);            //U1 = P1 + P2 = C11
+
+    //peel odd dimensions with thin classical products
+    gemmEpilogueInit(&acc);
+    acc.beta = 1;
+    if (k > 2*k2){
+        gemmEx(tA, tB, 2*m2, 2*n2, 1, _strassenAt(A, lda, tA, 0, 2*k2), lda,
+               _strassenAt(B, ldb, tB, 2*k2, 0), ldb, C, ldc, &acc);
+    }
+    if (n > 2*n2){
+        gemmEx(tA, tB, m, 1, k, A, lda, _strassenAt(B, ldb, tB, 0, 2*n2), ldb, C+2*n2, ldc, NULL);
+    }
+    if (m > 2*m2){
+        gemmEx(tA, tB, 1, 2*n2, k, _strassenAt(A, lda, tA, 2*m2, 0), lda, B, ldb, C+2*m2*ldc, ldc, NULL);
+    }
+}
+
+/** \brief C = epilogue(T), T holds op(A)*op(B), private function
+ *
+ * \param m, n, T, ldt, C, ldc (T may equal C when beta == 0), ep
+ * \return
+ *
+ */
+
+void _strassenEpilogue(size_t m, size_t n, float* T, size_t ldt, float* C, size_t ldc, GemmEpilogue* ep){
+    size_t i, j;
+    float x;
+    for (i=0; i<m; i++){
+        for (j=0; j<n; j++){
+            x = ep->alpha*T[i*ldt+j];
+            if (ep->beta != 0) x += ep->beta*C[i*ldc+j];
+            if (ep->colBias != NULL) x += ep->colBias[i];
+            if (ep->rowBias != NULL) x += ep->rowBias[j];
+            C[i*ldc+j] = x;
+        }
+        ewApply(ep->op, ep->order, C+i*ldc, n);
+    }
+}
+
+/** \brief Strassen-Winograd GEMM, same contract as gemmEx.
+ *   Products whose smallest dimension is at most the cutoff run on the classical engine.
+ *
+ * \param transA, transB: 0/1
+ * \param m, n, k: C is m x n, op(A) is m x k, op(B) is k x n
+ * \param A, lda, B, ldb, C, ldc: row-major arrays and their leading dimensions
+ * \param ep: epilogue, NULL means C = op(A)*op(B)
+ * \return
+ *
+ */
+
+void gemmStrassen(int transA, int transB, size_t m, size_t n, size_t k,
+                  IN float* A, size_t lda, IN float* B, size_t ldb,
+                  INOUT float* C, size_t ldc, IN GemmEpilogue* ep){
+    size_t nw;
+    float* work;
+    float* T = C;
+    size_t ldt = ldc;
+    int plain;
+    if (MIN(m, MIN(n, k)) <= STRASSEN_CUTOFF){
+        gemmEx(transA, transB, m, n, k, A, lda, B, ldb, C, ldc, ep);
+        return;
+    }
+    if (ldc < n || lda < (transA ? m : k) || ldb < (transB ? k : n)){
+        perr("In gemmStrassen(), leading dimension is too small!\n");
+    }
+    plain = ep == NULL || (ep->alpha == 1 && ep->beta == 0 && ep->colBias == NULL &&
+                           ep->rowBias == NULL && ep->op == EW_NONE);
+    nw = _strassenWork(m, n, k);
+    //C is read by the epilogue, so the product goes to a separate block
+    if (!plain && ep->beta != 0){
+        nw += m*n;
+    }
+    work = slach_malloc(float, nw);
+    if (!plain && ep->beta != 0){
+        T = work+nw-m*n;
+        ldt = n;
+    }
+    _strassen(transA, transB, m, n, k, A, lda, B, ldb, T, ldt, work);
+    if (!plain){
+        _strassenEpilogue(m, n, T, ldt, C, ldc, ep);
+    }
+    slach_free(work);
+}
@@ -0,0 +1,136 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/GEMM.h"
+#include "../include/tune.h"
+
+/*
+SYRK on top of the GEMM engine. C is cut into row panels of SYRK_BLOCK rows; the part of
+a panel strictly inside the triangle is one rectangular gemmEx straight into C, and the
+diagonal block is computed into a scratch tile whose triangle is then merged into C, so
+the other triangle of C is never written unless it is mirrored at the end. That computes
+n*(n+SYRK_BLOCK)/2 entries instead of n*n, and every gemmEx is threaded as usual.
+*/
+#define SYRK_BLOCK (slach_tune()->syrkBlock) //tunable, see tune.h
+
+/** \brief symmetric rank-k update, one triangle of C(n x n):
+ *   trans == 0: C = alpha*A*A^T + beta*C, A is n x k
+ *   trans == 1: C = alpha*A^T*A + beta*C, A is k x n
+ *
+ * \param uplo: SLACH_UPPER or SLACH_LOWER, the triangle of C that is computed
+ * \param trans, n, k, alpha
+ * \param A, lda
+ * \param beta
+ * \param C, ldc: when beta == 0, C is never read
+ * \param mirror: 1 copies the computed triangle to the other one
+ * \return
+ *
+ */
+
+void syrkEx(int uplo, int trans, size_t n, size_t k, float alpha, IN float* A, size_t lda,
+            float beta, INOUT float* C, size_t ldc, int mirror){
+    GemmEpilogue ep, epd;
+    float* D;
+    size_t i0, i1, nb, i, j, bs = SYRK_BLOCK;
+    int lower = uplo == SLACH_LOWER;
+    if (n == 0) return;
+    if (A == NULL || C == NULL){
+        perr("In syrkEx(), A or C is NULL!\n");
+    }
+    if (ldc < n || (k > 0 && lda < (trans ? n : k))){
+        perr("In syrkEx(), leading dimension is too small!\n");
+    }
+    if (alpha == 0) k = 0; //only scales C, gemmEx does that for an empty k
+    gemmEpilogueInit(&ep);
+    ep.alpha = alpha; ep.beta = beta;
+    gemmEpilogueInit(&epd);
+    epd.alpha = alpha;
+    D = slach_malloc(float, bs*bs);
+    //rows i0..i1 of op(A) start at A + i0 (trans) or A + i0*lda; op(A)^T is read through the opposite flag
+#define SYRK_OPA(r) (trans ? A + (r) : A + (r)*lda)
+    for (i0=0; i0<n; i0+=bs){
+        i1 = MIN(n, i0+bs);
+        nb = i1-i0;
+        if (lower && i0 > 0){
+            gemmEx(trans, !trans, nb, i0, k, SYRK_OPA(i0), lda, SYRK_OPA(0), lda, C+i0*ldc, ldc, &ep);
+        }
+        if (!lower && i1 < n){
+            gemmEx(trans, !trans, nb, n-i1, k, SYRK_OPA(i0), lda, SYRK_OPA(i1), lda, C+i0*ldc+i1, ldc, &ep);
+        }
+        gemmEx(trans, !trans, nb, nb, k, SYRK_OPA(i0), lda, SYRK_OPA(i0), lda, D, nb, &epd);
+        for (i=0; i<nb; i++){
+            for (j=(lower ? 0 : i); j<=(lower ? i : nb-1); j++){
+                //fmaf: one rounding on every build, so the reproducible mode holds here too
+                C[(i0+i)*ldc+i0+j] = beta == 0 ? D[i*nb+j] : fmaf(beta, C[(i0+i)*ldc+i0+j], D[i*nb+j]);
+            }
+        }
+    }
+#undef SYRK_OPA
+    slach_free(D);
+    if (mirror){
+        for (i0=0; i0<n; i0+=bs){
+            i1 = MIN(n, i0+bs);
+            //off-diagonal blocks of the panel go through the tiled transpose
+            if (lower && i0 > 0) transposeEx(i1-i0, i0, C+i0*ldc, ldc, C+i0, ldc);
+            if (!lower && i1 < n) transposeEx(i1-i0, n-i1, C+i0*ldc+i1, ldc, C+i1*ldc+i0, ldc);
+            for (i=i0; i<i1; i++){
+                for (j=i0; j<i; j++){
+                    if (lower) C[j*ldc+i] = C[i*ldc+j];
+                    else C[i*ldc+j] = C[j*ldc+i];
+                }
+            }
+        }
+    }
+}
+
+/** \brief interface of Gram matrix: dest = arr^T*arr, e.g. the scatter matrix of centered data
+ *
+ * \param 2-dim array, row, col
+ * \param 2-dim array to save result, col, col
+ * \return
+ *
+ */
+
+void mGram(INOUT float* arr, size_t row, size_t col, OUT float* dest, size_t height, size_t width){
+    if (height != col || width != col){
+        perr("The size of src and dest is mismatched! \n");
+    }
+    syrkEx(SLACH_LOWER, 1, col, row, 1, arr, col, 0, dest, width, 1);
+}
@@ -0,0 +1,604 @@
+/*
+=======================================================================
+Simple Linear Algebra Header (SLACH)
+The library provides some useful linear algebra algorithms implementations
+for ANSI C:
+Matrix and Vector
+Element-wise math functions
+Matrix multiplication, add, transpose, inverse, vector dot, norm, slice
+Random functions: uniform distr., Gaussian distri., Exp distri., random numbers
+                   generation seed settings, integer interval random numbers generation
+Matrix decomposition: LU decomposition, QR decomposition, SVD decomposition and eigenvalue
+                      decomposition
+                      solve linear equations use LUD or QRD
+Fast Fourier Transform
+Some utilities: floor, ceil, round, divide, perr, printv, printvArr, printm, printmArr, MAX, MIN,
+                swap, safe malloc, safe free
+
+
+Author: cltian
+Email: tianchunlin123@gmail.com
+Version: 0.1
+========================================================================
+
+
+Copyright cltian
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "../include/tune.h"
+#include "../include/GEMM.h"
+#include "../include/LUD.h"
+#include "../include/map.h"
+#include "../include/parallel.h"
+#include <stddef.h>
+#ifndef SLACH_NO_THREADS
+#include <pthread.h>
+#endif
+
+#define TUNE_LINE 512
+#define TUNE_MODEL 256
+#define TUNE_REPEAT 3
+
+static SlachTune cur;
+#ifdef SLACH_NO_THREADS
+static int tuneReady = 0;
+#else
+static pthread_once_t tuneOnce = PTHREAD_ONCE_INIT;
+#endif
+
+/*
+keys of the tuning file, in the order they are written
+*/
+static const struct{
+    const char* key;
+    size_t off;
+}tuneKeys[] = {
+    {"gemm_mc", offsetof(SlachTune, gemmMC)},
+    {"gemm_kc", offsetof(SlachTune, gemmKC)},
+    {"gemm_nc", offsetof(SlachTune, gemmNC)},
+    {"transpose_block", offsetof(SlachTune, transposeBlock)},
+    {"strassen_cutoff", offsetof(SlachTune, strassenCutoff)},
+    {"strassen_auto_min", offsetof(SlachTune, strassenAutoMin)},
+    {"syrk_block", offsetof(SlachTune, syrkBlock)},
+    {"trsm_block", offsetof(SlachTune, trsmBlock)},
+    {"lu_block", offsetof(SlachTune, luBlock)},
+    {"par_min", offsetof(SlachTune, parMin)},
+    {"map_par_min", offsetof(SlachTune, mapParMin)}
+};
+#define TUNE_NKEYS (sizeof(tuneKeys)/sizeof(tuneKeys[0]))
+#define TUNE_FIELD(t, i) ((size_t*)((char*)(t)+tuneKeys[i].off))
+
+/** \brief built-in parameters
+ *
+ * \param SlachTune* t
+ * \return
+ *
+ */
+
+void slach_tune_default(OUT SlachTune* t){
+    if (t == NULL){
+        perr("In slach_tune_default(), t is NULL!\n");
+    }
+    t->gemmMC = 96;
+    t->gemmKC = 256;
+    t->gemmNC = 2048;
+    t->transposeBlock = 64;
+    t->strassenCutoff = 1024;
+    t->strassenAutoMin = 4096;
+    t->syrkBlock = 256;
+    t->trsmBlock = 128;
+    t->luBlock = 64;
+    t->parMin = 1<<16;
+    t->mapParMin = 1<<14;
+}
+
+/** \brief check a parameter set and make it current, private function
+ *
+ * \param SlachTune* t
+ * \return
+ *
+ */
+
+void _tuneApply(const SlachTune* t){
+    size_t i;
+    for (i=0; i<TUNE_NKEYS; i++){
+        if (*TUNE_FIELD(t, i) == 0){
+            perr("In slach_tune_set(), every parameter must be positive!\n");
+        }
+    }
+    cur = *t;
+    //the packed A block is cut into whole micro-kernel slivers
+    cur.gemmMC = (cur.gemmMC+5)/6*6;
+}
+
+/** \brief CPU model name, "unknown" when it cannot be read
+ *
+ * \param buf, len
+ * \return
+ *
+ */
+
+void slach_cpu_model(OUT char* buf, size_t len){
+    char line[TUNE_LINE];
+    char* p;
+    FILE* f;
+    size_t n;
+    if (len == 0) return;
+    snprintf(buf, len, "unknown");
+    f = fopen("/proc/cpuinfo", "r");
+    if (f == NULL) return;
+    while (fgets(line, sizeof(line), f) != NULL){
+        if (strncmp(line, "model name", 10) == 0 && (p = strchr(line, ':')) != NULL){
+            p++;
+            while (*p == ' ' || *p == '\t') p++;
+            n = strcspn(p, "]\r\n");
+            p[n] = '\0';
+            snprintf(buf, len, "%s", p);
+            break;
+        }
+    }
+    fclose(f);
+}
+
+/** \brief resolve the tuning file name, private function
+ *
+ * \param path: NULL for the default
+ * \param buf, len
+ * \return const char*, NULL when there is no file to use
+ *
+ */
+
+const char* _tunePath(const char* path, char* buf, size_t len){
+    const char* env;
+    if (path != NULL) return path;
+    env = getenv("SLACH_TUNE_FILE");
+    if (env != NULL) return env[0] == '\0' ? NULL : env;
+    env = getenv("HOME");
+    if (env == NULL) return NULL;
+    snprintf(buf, len, "%s/.slach_tune", env);
+    return buf;
+}
+
+/** \brief section name of a line, private function
+ *
+ * \param line: "[name]"
+ * \param name: buffer of TUNE_MODEL characters
+ * \return int, 1 when the line opens a section
+ *
+ */
+
+int _tuneSection(const char* line, char* name){
+    const char* end;
+    if (line[0] != '[' || (end = strrchr(line, ']')) == NULL) return 0;
+    snprintf(name, TUNE_MODEL, "%.*s", (int)(end-line-1), line+1);
+    return 1;
+}
+
+/** \brief read the section of this CPU on top of t, private function
+ *
+ * \param path, t
+ * \return int, 0 when the section was found
+ *
+ */
+
+int _tuneLoad(const char* path, SlachTune* t){
+    char buf[TUNE_LINE], line[TUNE_LINE], key[64], model[TUNE_MODEL], name[TUNE_MODEL];
+    size_t v, i;
+    int in = 0, found = -1;
+    FILE* f;
+    path = _tunePath(path, buf, sizeof(buf));
+    if (path == NULL || (f = fopen(path, "r")) == NULL) return -1;
+    slach_cpu_model(model, sizeof(model));
+    while (fgets(line, sizeof(line), f) != NULL){
+        if (_tuneSection(line, name)){
+            in = strcmp(name, model) == 0;
+            if (in) found = 0;
+            continue;
+        }
+        if (!in || sscanf(line, " %63[a-z_] = %zu", key, &v) != 2 || v == 0) continue;
+        for (i=0; i<TUNE_NKEYS; i++){
+            if (strcmp(key, tuneKeys[i].key) == 0) *TUNE_FIELD(t, i) = v;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+/** \brief first use: defaults, then the tuning file, private function
+ *
+ * \param empty
+ * \return
+ *
+ */
+
+void _tuneInit(void){
+    SlachTune t;
+    slach_tune_default(&t);
+    _tuneLoad(NULL, &t);
+    _tuneApply(&t);
+}
+
+/** \brief current parameters
+ *
+ * \param empty
+ * \return const SlachTune*
+ *
+ */
+
+const SlachTune* slach_tune(void){
+#ifdef SLACH_NO_THREADS
+    if (!tuneReady){
+        tuneReady = 1;
+        _tuneInit();
+    }
+#else
+    pthread_once(&tuneOnce, _tuneInit);
+#endif
+    return &cur;
+}
+
+/** \brief replace the current parameters
+ *
+ * \param SlachTune* t: every field positive, gemmMC is rounded up to a multiple of 6
+ * \return
+ *
+ */
+
+void slach_tune_set(IN const SlachTune* t){
+    if (t == NULL){
+        perr("In slach_tune_set(), t is NULL!\n");
+    }
+    slach_tune(); //a later first use must not overwrite t
+    _tuneApply(t);
+}
+
+/** \brief load the section of this CPU from a tuning file
+ *
+ * \param path: NULL for the default file
+ * \return int, 0 on success, -1 when the file or the section is missing
+ *
+ */
+
+int slach_tune_load(const char* path){
+    SlachTune t;
+    slach_tune_default(&t);
+    if (_tuneLoad(path, &t) != 0) return -1;
+    slach_tune_set(&t);
+    return 0;
+}
+
+/** \brief write t as the section of this CPU, other sections are kept
+ *
+ * \param path: NULL for the default file
+ * \param SlachTune* t
+ * \return int, 0 on success, -1 when the file cannot be written
+ *
+ */
+
+int slach_tune_save(const char* path, IN const SlachTune* t){
+    char buf[TUNE_LINE], tmp[TUNE_LINE+8], line[TUNE_LINE], model[TUNE_MODEL], name[TUNE_MODEL];
+    FILE* in;
+    FILE* out;
+    size_t i;
+    int skip = 0;
+    path = _tunePath(path, buf, sizeof(buf));
+    if (path == NULL || t == NULL) return -1;
+    slach_cpu_model(model, sizeof(model));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    if ((out = fopen(tmp, "w")) == NULL) return -1;
+    if ((in = fopen(path, "r")) != NULL){
+        while (fgets(line, sizeof(line), in) != NULL){
+            if (_tuneSection(line, name)) skip = strcmp(name, model) == 0;
+            if (!skip) fputs(line, out);
+        }
+        fclose(in);
+    }
+    fprintf(out, "[%s]\n", model);
+    for (i=0; i<TUNE_NKEYS; i++){
+        fprintf(out, "%s = %zu\n", tuneKeys[i].key, *TUNE_FIELD(t, i));
+    }
+    if (fclose(out) != 0 || rename(tmp, path) != 0){
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+autotuning: each parameter is searched over its candidates with the others fixed, in an order
+where the later benchmarks already run on the tuned GEMM. A candidate is timed as the best of
+TUNE_REPEAT runs after a warm-up run.
+*/
+typedef void (*tuneBench)(void* ctx);
+
+typedef struct _TuneCtx_{
+    size_t n;
+    float* A;
+    float* B;
+    float* C;
+    float* D;
+}TuneCtx;
+
+/** \brief monotonic clock in seconds, private function
+ *
+ * \param empty
+ * \return double
+ *
+ */
+
+double _tuneNow(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9*(double)ts.tv_nsec;
+}
+
+/** \brief best time of a benchmark, private function
+ *
+ * \param fn, ctx
+ * \return double: seconds
+ *
+ */
+
+double _tuneTime(tuneBench fn, void* ctx){
+    double best = 1e300, t;
+    int r;
+    fn(ctx);
+    for (r=0; r<TUNE_REPEAT; r++){
+        t = _tuneNow();
+        fn(ctx);
+        best = MIN(best, _tuneNow()-t);
+    }
+    return best;
+}
+
+/** \brief try every candidate for one field of w, keep the fastest, private function
+ *
+ * \param w: working set, applied for each run
+ * \param field: member of w
+ * \param cand, ncand
+ * \param fn, ctx: benchmark
+ * \return
+ *
+ */
+
+void _tuneSearch(SlachTune* w, size_t* field, const size_t* cand, size_t ncand, tuneBench fn, void* ctx){
+    double best = 1e300, t;
+    size_t i, pick = *field;
+    for (i=0; i<ncand; i++){
+        *field = cand[i];
+        _tuneApply(w);
+        t = _tuneTime(fn, ctx);
+        if (t < best){
+            best = t;
+            pick = cand[i];
+        }
+    }
+    *field = pick;
+    _tuneApply(w);
+}
+
+/** \brief benchmark: GEMM of order n, private function
+ *
+ * \param arg: TuneCtx*
+ * \return
+ *
+ */
+
+void _benchGemm(void* arg){
+    TuneCtx* c = (TuneCtx*)arg;
+    gemmEx(0, 0, c->n, c->n, c->n, c->A, c->n, c->B, c->n, c->C, c->n, NULL);
+}
+
+/** \brief benchmark: Strassen GEMM of order n, private function
+ *
+ * \param arg: TuneCtx*
+ * \return
+ *
+ */
+
+void _benchStrassen(void* arg){
+    TuneCtx* c = (TuneCtx*)arg;
+    gemmStrassen(0, 0, c->n, c->n, c->n, c->A, c->n, c->B, c->n, c->C, c->n, NULL);
+}
+
+/** \brief benchmark: n x n transpose, private function
+ *
+ * \param arg: TuneCtx*
+ * \return
+ *
+ */
+
+void _benchTranspose(void* arg){
+    TuneCtx* c = (TuneCtx*)arg;
+    transposeEx(c->n, c->n, c->A, c->n, c->C, c->n);
+}
+
+/** \brief benchmark: SYRK of order n and depth n, private function
+ *
+ * \param arg: TuneCtx*
+ * \return
+ *
+ */
+
+void _benchSyrk(void* arg){
+    TuneCtx* c = (TuneCtx*)arg;
+    syrkEx(SLACH_LOWER, 0, c->n, c->n, 1, c->A, c->n, 0, c->C, c->n, 0);
+}
+
+/** \brief benchmark: lower triangular solve with n right-hand sides, B is restored first, private function
+ *
+ * \param arg: TuneCtx*
+ * \return
+ *
+ */
+
+void _benchTrsm(void* arg){
+    TuneCtx* c = (TuneCtx*)arg;
+    memcpy(c->C, c->B, c->n*c->n*sizeof(float));
+    trsmEx(SLACH_LEFT, SLACH_LOWER, 0, SLACH_NON_UNIT, c->n, c->n, 1, c->D, c->n, c->C, c->n);
+}
+
+/** \brief benchmark: LU solve of order n, private function
+ *
+ * \param arg: TuneCtx*
+ * \return
+ *
+ */
+
+void _benchLU(void* arg){
+    TuneCtx* c = (TuneCtx*)arg;
+    LUsolvem(c->D, c->n, c->n, c->B, c->n, 1, c->C, c->n, 1);
+}
+
+/** \brief benchmark: element-wise add of length n, private function
+ *
+ * \param arg: TuneCtx*
+ * \return
+ *
+ */
+
+void _benchAdd(void* arg){
+    TuneCtx* c = (TuneCtx*)arg;
+    ewBinary(EW_ADD, c->A, 1, c->n, c->B, 1, c->n, c->C, 1, c->n);
+}
+
+/** \brief benchmark: cheap scalar function for the map benchmark, private function
+ *
+ * \param x, ctx: unused
+ * \return float
+ *
+ */
+
+float _benchMapFn(float x, void* ctx){
+    (void)ctx;
+    return x*x+1;
+}
+
+/** \brief benchmark: map of length n, private function
+ *
+ * \param arg: TuneCtx*
+ * \return
+ *
+ */
+
+void _benchMap(void* arg){
+    TuneCtx* c = (TuneCtx*)arg;
+    slach_map(c->A, c->C, c->n, _benchMapFn, NULL);
+}
+
+/** \brief smallest size from which the parallel run of a benchmark beats the serial one, private function
+ *
+ * \param w, field: parallel cutoff being tuned
+ * \param c: n is set for each size
+ * \param fn
+ * \param nmax: largest size tried
+ * \return
+ *
+ */
+
+void _tuneCutoff(SlachTune* w, size_t* field, TuneCtx* c, tuneBench fn, size_t nmax){
+    double tp, ts;
+    size_t s;
+    for (s=(size_t)1<<10; s<=nmax; s*=4){
+        c->n = s;
+        *field = 1;
+        _tuneApply(w);
+        tp = _tuneTime(fn, c);
+        *field = (size_t)-1;
+        _tuneApply(w);
+        ts = _tuneTime(fn, c);
+        if (tp < ts) break;
+    }
+    *field = s;
+    _tuneApply(w);
+}
+
+/** \brief benchmark the tunable parameters on this machine and save the winners
+ *
+ * \param path: tuning file, NULL for the default
+ * \param quick: smaller problems
+ * \return int, 0 when the result was saved
+ *
+ */
+
+int slach_autotune(const char* path, int quick){
+    static const size_t kc[] = {128, 192, 256, 384, 512};
+    static const size_t mc[] = {48, 72, 96, 144, 192, 288};
+    static const size_t nc[] = {512, 1024, 2048, 4096};
+    static const size_t tb[] = {16, 32, 64, 128, 256};
+    static const size_t sb[] = {64, 128, 256, 512};
+    static const size_t trb[] = {32, 64, 128, 256};
+    static const size_t lb[] = {16, 32, 64, 128};
+    static const size_t cut[] = {256, 512, 1024};
+    SlachTune w, def;
+    TuneCtx c;
+    size_t nmax = quick ? 1024 : 2048, i;
+    double tc, ts;
+    slach_tune_default(&def);
+    w = *slach_tune();
+    c.A = slach_malloc(float, nmax*nmax);
+    c.B = slach_malloc(float, nmax*nmax);
+    c.C = slach_malloc(float, nmax*nmax);
+    c.D = slach_malloc(float, nmax*nmax);
+    for (i=0; i<nmax*nmax; i++){
+        c.A[i] = uRand(-1, 1);
+        c.B[i] = uRand(-1, 1);
+    }
+
+    c.n = quick ? 512 : 1536;
+    _tuneSearch(&w, &w.gemmKC, kc, sizeof(kc)/sizeof(kc[0]), _benchGemm, &c);
+    _tuneSearch(&w, &w.gemmMC, mc, sizeof(mc)/sizeof(mc[0]), _benchGemm, &c);
+    _tuneSearch(&w, &w.gemmNC, nc, sizeof(nc)/sizeof(nc[0]), _benchGemm, &c);
+
+    c.n = nmax;
+    _tuneSearch(&w, &w.transposeBlock, tb, sizeof(tb)/sizeof(tb[0]), _benchTranspose, &c);
+
+    //one Strassen level on 2*cutoff against the classical product: the first clear win sets both cutoffs
+    w.strassenCutoff = def.strassenCutoff;
+    w.strassenAutoMin = def.strassenAutoMin;
+    for (i=0; i<sizeof(cut)/sizeof(cut[0]) && 2*cut[i]<=nmax; i++){
+        c.n = 2*cut[i];
+        w.strassenCutoff = cut[i];
+        _tuneApply(&w);
+        tc = _tuneTime(_benchGemm, &c);
+        ts = _tuneTime(_benchStrassen, &c);
+        //Strassen costs accuracy (see strassen.c), so it has to win clearly
+        if (ts < 0.9*tc){
+            w.strassenAutoMin = c.n;
+            break;
+        }
+        w.strassenCutoff = def.strassenCutoff;
+    }
+    _tuneApply(&w);
+
+    c.n = nmax/2;
+    _tuneSearch(&w, &w.syrkBlock, sb, sizeof(sb)/sizeof(sb[0]), _benchSyrk, &c);
+    //diagonally dominant lower triangle for TRSM and LU
+    for (i=0; i<c.n*c.n; i++){
+        c.D[i] = i/c.n == i%c.n ? (float)c.n : (i/c.n > i%c.n ? uRand(-1, 1) : 0);
+    }
+    _tuneSearch(&w, &w.trsmBlock, trb, sizeof(trb)/sizeof(trb[0]), _benchTrsm, &c);
+    _tuneSearch(&w, &w.luBlock, lb, sizeof(lb)/sizeof(lb[0]), _benchLU, &c);
+
+    //with one thread the cutoffs do not matter, keep the current ones
+    if (slach_get_num_threads() > 1){
+        _tuneCutoff(&w, &w.parMin, &c, _benchAdd, nmax*nmax);
+        _tuneCutoff(&w, &w.mapParMin, &c, _benchMap, nmax*nmax);
+    }
+
+    slach_free(c.A); slach_free(c.B); slach_free(c.C); slach_free(c.D);
+    return slach_tune_save(path, &w);
+}
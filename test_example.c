@@ -4,11 +4,128 @@
 #include "./include/QRD.h"
 #include "./include/SVD.h"
 #include "./include/FFT.h"
+#include "./include/GEMM.h"
+#include "./include/batch.h"
+#include "./include/parallel.h"
+#include "./include/GEMV.h"
+#include "./include/reduce.h"
+#include "./include/blas.h"
+#include "./include/map.h"
+#include "./include/TRSM.h"
+#include "./include/tune.h"
+#include "./include/async.h"
+#include "./include/graph.h"
+#include "./include/mfunc.h"
+#include "./include/distance.h"
+#include "./include/conv.h"
+#include "./include/sketch.h"
+#include "./include/shard.h"
+#include "./include/ooc.h"
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 
 /*
 This is an example, and test only whether it can run or not. The validity can be verified by Matlab-like software.
  */
 
+/*
+naive reference product used to check the optimized kernels: C = op(A)*op(B)
+ */
+void naiveMul(int transA, int transB, size_t m, size_t n, size_t k, float* A, float* B, float* C){
+    size_t i,j,p;
+    double sum;
+    for (i=0; i<m; i++){
+        for (j=0; j<n; j++){
+            sum = 0;
+            for (p=0; p<k; p++){
+                sum += (transA ? A[p*m+i] : A[i*k+p])*(transB ? B[j*k+p] : B[p*n+j]);
+            }
+            C[i*n+j] = (float)sum;
+        }
+    }
+}
+
+//callbacks of the map engine tests
+float clampFn(float x, void* ctx){
+    float b = *(float*)ctx;
+    return MAX(-b, MIN(b, x));
+}
+
+void blendFn(float* x, float* y, float* dest, size_t len, void* ctx){
+    float w = *(float*)ctx;
+    size_t i;
+    for (i=0; i<len; i++){
+        dest[i] = (1-w)*x[i] + w*y[i];
+    }
+}
+
+//callbacks of the thread pool tests: a loop nested in a loop, and an executor that only
+//queues the tasks it gets so that they run after the loop has returned
+void addOneFn(void* ctx, size_t begin, size_t end){
+    int* v = (int*)ctx;
+    size_t i;
+    for (i=begin; i<end; i++) v[i]++;
+}
+
+void nestedFn(void* ctx, size_t begin, size_t end){
+    size_t i;
+    for (i=begin; i<end; i++) slach_parallel_for(1000, 16, addOneFn, (int*)ctx+i*1000);
+}
+
+typedef struct{
+    slachTaskFn fn[64];
+    void* arg[64];
+    int n;
+}TaskQueue;
+
+void queueSubmit(void* pool, slachTaskFn fn, void* arg){
+    TaskQueue* q = (TaskQueue*)pool;
+    assert(q->n < 64);
+    q->fn[q->n] = fn; q->arg[q->n] = arg; q->n++;
+}
+
+//completion callback of the async tests
+void countFn(void* arg){
+    (*(int*)arg)++;
+}
+
+/*
+naive reference convolution, same layout as conv2dEx
+ */
+void naiveConv(int flip, size_t C, size_t H, size_t W, float* in, size_t K, size_t kh, size_t kw, float* w,
+               float* bias, size_t stride, size_t pad, float* out){
+    size_t OH = conv2dOutSize(H, kh, stride, pad), OW = conv2dOutSize(W, kw, stride, pad);
+    size_t k, c, oy, ox, u, v;
+    long iy, ix;
+    double sum;
+    for (k=0; k<K; k++){
+        for (oy=0; oy<OH; oy++){
+            for (ox=0; ox<OW; ox++){
+                sum = bias != NULL ? bias[k] : 0;
+                for (c=0; c<C; c++){
+                    for (u=0; u<kh; u++){
+                        for (v=0; v<kw; v++){
+                            iy = (long)(oy*stride + u) - (long)pad;
+                            ix = (long)(ox*stride + v) - (long)pad;
+                            if (iy < 0 || ix < 0 || iy >= (long)H || ix >= (long)W) continue;
+                            sum += in[(c*H + iy)*W + ix]*w[((k*C + c)*kh + (flip ? kh-1-u : u))*kw + (flip ? kw-1-v : v)];
+                        }
+                    }
+                }
+                out[(k*OH + oy)*OW + ox] = (float)sum;
+            }
+        }
+    }
+}
+
+//qsort order of the kNN reference
+int floatCmp(const void* a, const void* b){
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
 int main(){
     float a1[3][3];
     Matrix* m1;Vector* v1;
@@ -26,6 +143,43 @@ int main(){
     float a11[8][3];
     float a12[16] = {1,2,3,4,56,3,4,5,6,23,2,4,1,2,8,9};
     float a13[16];
+    GemmEpilogue ep;
+    float bias[3] = {1,2,3};
+    float* g1; float* g2; float* g3; float* g4; float* g5; float* g6;
+    int t;
+    int side, up, tr, un;
+    size_t mb, nbr, na;
+    int info[11];
+    float* bp[13]; float* bq[13];
+    SlachTune tn;
+    TaskQueue tq = {{0}, {0}, 0};
+    SlachExecutor ex = {queueSubmit, &tq, 4};
+    int* iv;
+    complex* complexArr; complex* complexOut;
+    SlachTask* tk[4];
+    SlachGraph* gr;
+    int nd[12];
+    FILE* tf;
+    char line[64];
+    size_t* ix;
+    SlachSketch* sk;
+    SlachShard* sh;
+    SlachLU* lu;
+    pid_t pid;
+    //a thread count set before any kernel still registers the fork handler, so the child of
+    //a process that ran a parallel loop starts serially
+    iv = slach_malloc(int, 64*1000);
+    slach_set_num_threads(4);
+    slach_parallel_for(64*1000, 100, addOneFn, iv);
+    pid = fork();
+    assert(pid >= 0);
+    if (pid == 0){
+        slach_parallel_for(64*1000, 100, addOneFn, iv);
+        _exit(slach_get_num_threads() == 1 && iv[0] == 2 && iv[64*1000-1] == 2 ? 0 : 1);
+    }
+    assert(waitpid(pid, &t, 0) == pid && WIFEXITED(t) && WEXITSTATUS(t) == 0);
+    slach_free(iv);
+    slach_set_num_threads(0);
 	/*
 	Test base
 	 */
@@ -106,24 +260,250 @@ int main(){
     printmArr(a5,3,3);
     sqrtm(a1,3,3,a5,3,3);
     printmArr(a5,3,3);
+    //map engine: scalar clamp in place, vectorized blend of two arrays, both spread over the pool
+    slach_set_num_threads(4);
+    g1 = slach_malloc(float, 50001); g2 = slach_malloc(float, 50001); g3 = slach_malloc(float, 50001);
+    for (i=0; i<50001; i++){
+        g1[i] = g3[i] = uRand(-2,2);
+        g2[i] = uRand(-2,2);
+    }
+    f = 1;
+    slach_map(g1, g1, 50001, clampFn, &f);
+    for (i=0; i<50001; i++) assert(g1[i] == MAX(-1, MIN(1, g3[i])));
+    f = 0.25;
+    slach_map2_vec(g1, g2, g3, 50001, blendFn, &f);
+    for (i=0; i<50001; i++) assert(fabs(g3[i]-(0.75*g1[i]+0.25*g2[i])) < 1e-6);
+    slach_free(g1); slach_free(g2); slach_free(g3);
 
     //norm
     vn = vNorm("2",a2,3);
     printf("vnorm: %f\n",vn);
     mn = mNorm("F",a1,3,3);
     printf("mnorm: %f\n",mn);
+    //norm fast paths, scaled 2-norm at both ends of the float range, summation modes
+    a3[0] = -4; a3[1] = 3; a3[2] = 0;
+    assert(FLOAT_EQUY(vNorm("inf",a3,3), 4));
+    assert(FLOAT_EQUY(vNorm("1",a3,3), 7));
+    assert(FLOAT_EQUY(vNorm("2",a3,3), 5));
+    assert(fabs(vNorm("3",a3,3)-pow(91,1.0/3)) < 1e-5);
+    a3[0] = 3e30f; a3[1] = 4e30f;
+    assert(fabs(nrm2Ex(a3,3,SUM_FAST)/5e30f-1) < 1e-6);
+    a3[0] = 3e-30f; a3[1] = 4e-30f;
+    assert(fabs(nrm2Ex(a3,3,SUM_KAHAN)/5e-30f-1) < 1e-6);
+    g1 = slach_malloc(float, 1000003);
+    for (i=0; i<1000003; i++) g1[i] = 0.1f;
+    for (t=SUM_PAIRWISE; t<=SUM_KAHAN; t++){
+        assert(fabs(sumEx(g1,1000003,(SumMode)t)/(1000003*(double)0.1f)-1) < 1e-6);
+        assert(fabs(dotEx(g1,g1,1000003,(SumMode)t)/(1000003*(double)0.1f*0.1f)-1) < 1e-6);
+    }
+    slach_free(g1);
+    //axis reductions and scans on a 300 x 517 matrix, both axes against plain loops
+    g1 = slach_malloc(float, 300*517); g2 = slach_malloc(float, 300*517);
+    g3 = slach_malloc(float, 517); ix = slach_malloc(size_t, 517);
+    for (i=0; i<300*517; i++) g1[i] = uRand(-1,1) + (i%517 == 7 ? 3 : 0);
+    for (t=0; t<2; t++){
+        size_t nOut = t == 0 ? 517 : 300, nIn = t == 0 ? 300 : 517, o, p;
+        float* x;
+        reduceAxis(AXIS_SUM, t, g1, 300, 517, g3, nOut);
+        for (o=0; o<nOut; o++){
+            double s1 = 0, sa = 0;
+            for (p=0; p<nIn; p++){
+                s1 += t == 0 ? g1[p*517+o] : g1[o*517+p];
+                sa += fabs(t == 0 ? g1[p*517+o] : g1[o*517+p]);
+            }
+            assert(fabs(g3[o]-s1) < 1e-6*(1+sa)); //float rounding grows with sum |x|, not |sum x|
+        }
+        reduceAxis(AXIS_VAR, t, g1, 300, 517, g2, nOut);
+        reduceAxis(AXIS_MEAN, t, g1, 300, 517, g3, nOut);
+        for (o=0; o<nOut; o++){
+            double v = 0;
+            for (p=0; p<nIn; p++){
+                f = (t == 0 ? g1[p*517+o] : g1[o*517+p]) - g3[o];
+                v += f*f;
+            }
+            assert(fabs(g2[o]-v/nIn) < 1e-5);
+        }
+        reduceAxis(AXIS_MAX, t, g1, 300, 517, g3, nOut);
+        argmaxAxis(t, g1, 300, 517, ix, nOut);
+        for (o=0; o<nOut; o++){
+            x = t == 0 ? &g1[ix[o]*517+o] : &g1[o*517+ix[o]];
+            assert(*x == g3[o]);
+            for (p=0; p<nIn; p++) assert((t == 0 ? g1[p*517+o] : g1[o*517+p]) <= g3[o]);
+        }
+        reduceAxis(AXIS_MIN, t, g1, 300, 517, g3, nOut);
+        argminAxis(t, g1, 300, 517, ix, nOut);
+        for (o=0; o<nOut; o++){
+            x = t == 0 ? &g1[ix[o]*517+o] : &g1[o*517+ix[o]];
+            assert(*x == g3[o]);
+        }
+        //exclusive scan in place after an inclusive one: the difference is the element itself
+        cumsumAxis(t, 0, g1, 300, 517, g2, 300, 517);
+        memcpy(g3, g1, 517*sizeof(float));
+        cumsumAxis(t, 1, g1, 300, 517, g1, 300, 517);
+        assert(FLOAT_EQUY(g1[0], 0));
+        for (i=0; i<300*517; i++){
+            g1[i] = g2[i] - g1[i];
+        }
+        assert(fabs(g1[516]-g3[516]) < 1e-5);
+    }
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(ix);
 
+    //broadcasting binary ops: center columns, scale rows, outer product, fma, in place
+    g1 = slach_malloc(float, 300*301); g2 = slach_malloc(float, 300*301);
+    g3 = slach_malloc(float, 301); g4 = slach_malloc(float, 300);
+    for (i=0; i<300*301; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<300; i++) g4[i] = uRand(1,2);
+    reduceAxis(AXIS_MEAN, 0, g1, 300, 301, g3, 301);
+    ewBinary(EW_SUB, g1, 300, 301, g3, 1, 301, g2, 300, 301);
+    assert(fabs(g2[5*301+7] - (g1[5*301+7]-g3[7])) < 1e-6);
+    ewBinary(EW_MUL, g2, 300, 301, g4, 300, 1, g2, 300, 301);
+    assert(fabs(g2[299*301+300] - (g1[299*301+300]-g3[300])*g4[299]) < 1e-5);
+    ewBinary(EW_MUL, g4, 300, 1, g3, 1, 301, g2, 300, 301);
+    assert(g2[17*301+9] == g4[17]*g3[9]);
+    //a broadcast -0.0 after +0.0 keeps its sign
+    for (i=0; i<16; i++) a12[i] = 1;
+    a13[0] = 0; a13[1] = -0.0f;
+    ewBinary(EW_DIV, a12, 1, 16, a13, 2, 1, g2, 2, 16);
+    assert(isinf(g2[15]) && g2[15] > 0 && isinf(g2[16]) && g2[16] < 0);
+    ewFma(g1, 300, 301, g4, 300, 1, g3, 1, 301, g2, 300, 301);
+    assert(fabs(g2[42*301+200] - (g1[42*301+200]*g4[42]+g3[200])) < 1e-5);
+    ewBinaryScalar(EW_MAX, g1, 300, 301, 0, g1, 300, 301);
+    ewBinaryScalar(EW_DIV, g1, 300, 301, 2, g1, 300, 301);
+    for (i=0; i<300*301; i++) assert(g1[i] >= 0 && g1[i] <= 0.5);
+    mmAdd(g1, 300, 301, g1, 300, 301, g1, 300, 301);
+    for (i=0; i<300*301; i++) assert(g1[i] <= 1);
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
     //Test matrix multiply, add, transpose, vector dot,
     mmMul(a1,3,3,a6,3,3,a5,3,3);
     printmArr(a5,3,3);
+    //GEMM epilogue: C = abs(0.5*A*I + C + rowBias)
+    m1 = _eyem(3);
+    matrixToArray(m1,a10,3,3);
+    for (i=0; i<9; i++) a5[i/3][i%3] = 1;
+    gemmEpilogueInit(&ep);
+    ep.alpha = 0.5; ep.beta = 1; ep.rowBias = bias; ep.op = EW_ABS;
+    mmMulEx(a6,3,3,a10,3,3,&ep,a5,3,3);
+    printmArr(a5,3,3);
+    assert(FLOAT_EQUY(a5[2][2], 8.5));
+    assert(FLOAT_EQUY(a5[0][0], 2.5));
+    //GEMM engine against the naive product, odd sizes hit every edge tile
+    g1 = slach_malloc(float, 67*45); g2 = slach_malloc(float, 45*131);
+    g3 = slach_malloc(float, 67*131); g4 = slach_malloc(float, 67*131);
+    for (i=0; i<67*45; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<45*131; i++) g2[i] = uRand(-1,1);
+    for (t=0; t<4; t++){
+        gemmEx(t&1, t>>1, 67, 131, 45, g1, (t&1)?67:45, g2, (t>>1)?45:131, g3, 131, NULL);
+        naiveMul(t&1, t>>1, 67, 131, 45, g1, g2, g4);
+        for (i=0; i<67*131; i++) assert(fabs(g3[i]-g4[i]) < 1e-4);
+    }
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
+    //one Strassen-Winograd level with every dimension odd, sampled against the definition
+    gemmSetAlgo(GEMM_ALGO_STRASSEN);
+    g1 = slach_malloc(float, 1031*1027); g2 = slach_malloc(float, 1027*1029);
+    g3 = slach_malloc(float, 1031*1029); g4 = slach_malloc(float, 1031*1029);
+    for (i=0; i<1031*1027; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<1027*1029; i++) g2[i] = uRand(-1,1);
+    for (i=0; i<1031*1029; i++) g3[i] = g4[i] = uRand(-1,1);
+    gemmEpilogueInit(&ep);
+    ep.beta = 1;
+    mmMulEx(g1,1031,1027,g2,1027,1029,&ep,g3,1031,1029);
+    for (t=0; t<500; t++){
+        i = t == 0 ? 1031*1029-1 : slach_rand_int_range_1(0, 1031*1029);
+        f = g4[i];
+        for (sum=0; sum<1027; sum++) f += g1[(i/1029)*1027+(int)sum]*g2[(int)sum*1029+i%1029];
+        assert(fabs(f-g3[i]) < 1e-3);
+    }
+    gemmSetAlgo(GEMM_ALGO_AUTO);
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
+    //batched small GEMM and LU solve, 13 and 11 problems leave partial lane groups
+    g1 = slach_malloc(float, 13*5*3); g2 = slach_malloc(float, 13*3*4);
+    g3 = slach_malloc(float, 13*5*4); g4 = slach_malloc(float, 5*4);
+    for (i=0; i<13*5*3; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<13*3*4; i++) g2[i] = uRand(-1,1);
+    gemmBatchStrided(0,0,5,4,3,1,g1,3,15,g2,4,12,0,g3,4,20,13);
+    for (t=0; t<13; t++){
+        naiveMul(0,0,5,4,3,g1+t*15,g2+t*12,g4);
+        for (i=0; i<20; i++) assert(fabs(g3[t*20+i]-g4[i]) < 1e-5);
+    }
+    gemvBatchStrided(1,3,4,1,g2,4,12,g1,15,0,g3,20,13);
+    naiveMul(1,0,4,1,3,g2+12,g1+15,g4);
+    for (i=0; i<4; i++) assert(fabs(g3[20+i]-g4[i]) < 1e-5);
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
+    g1 = slach_malloc(float, 11*16); g2 = slach_malloc(float, 11*16);
+    g3 = slach_malloc(float, 11*4); g4 = slach_malloc(float, 11*4);
+    for (i=0; i<11*16; i++) g1[i] = g2[i] = uRand(-1,1) + ((i%16)%5 == 0 ? 4 : 0);
+    for (i=0; i<11*4; i++) g3[i] = g4[i] = uRand(-1,1);
+    for (t=0; t<11; t++){
+        bp[t] = g2+t*16;
+        bq[t] = g4+t*4;
+    }
+    LUsolveBatchPtr(4,1,bp,bq,info,11);
+    for (t=0; t<11; t++){
+        assert(info[t] == 0);
+        for (i=0; i<4; i++){
+            f = 0;
+            for (sum=0; sum<4; sum++) f += g1[t*16+i*4+(int)sum]*g4[t*4+(int)sum];
+            assert(fabs(f-g3[t*4+i]) < 1e-4);
+        }
+    }
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
     mvMul(a1,3,3,a2,3,1,a3,3);
     printvArr(a3,3);
+    //BLAS interface: strided/negative increments, rank-1 updates, one triangle of syr
+    g1 = slach_malloc(float, 40*33); g2 = slach_malloc(float, 80);
+    g3 = slach_malloc(float, 40*33); g4 = slach_malloc(float, 40);
+    for (i=0; i<40*33; i++) g1[i] = g3[i] = uRand(-1,1);
+    for (i=0; i<80; i++) g2[i] = uRand(-1,1);
+    for (i=0; i<40; i++) g4[i] = g2[2*i];
+    slach_saxpy(40, 2, g2, 2, g4, -1);
+    for (i=0; i<40; i++) assert(fabs(g4[39-i]-(g2[2*(39-i)]+2*g2[2*i])) < 1e-6);
+    assert(fabs(slach_sdot(40, g2, 2, g2, 2)-slach_snrm2(40, g2, 2)*slach_snrm2(40, g2, 2)) < 1e-4);
+    slach_sger(40, 33, 0.5, g2, 1, g2+40, 1, g1, 33);
+    for (i=0; i<40*33; i++) assert(fabs(g1[i]-(g3[i]+0.5*g2[i/33]*g2[40+i%33])) < 1e-6);
+    slach_ssyr(SLACH_LOWER, 33, -1, g2, 2, g1, 33);
+    for (i=0; i<33*33; i++){
+        f = (i%33 <= i/33) ? -g2[2*(i/33)]*g2[2*(i%33)] : 0;
+        assert(fabs(g1[i]-(g3[i]+0.5*g2[i/33]*g2[40+i%33]+f)) < 1e-5);
+    }
+    slach_sgemv(SLACH_TRANS, 40, 33, 1, g3, 33, g2, 2, 0, g4, -1);
+    for (i=0; i<33; i++){
+        f = 0;
+        for (t=0; t<40; t++) f += g3[t*33+i]*g2[2*t];
+        assert(fabs(g4[32-i]-f) < 1e-4);
+    }
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
+    //vector*matrix: a7*a6 = {30,36,42}
+    mvMul(a7,1,3,(float*)a6,3,3,a3,3);
+    assert(FLOAT_EQUY(a3[0], 30) && FLOAT_EQUY(a3[2], 42));
+    //GEMV both ways against the naive product, large enough to be split over the pool
+    g1 = slach_malloc(float, 517*260); g2 = slach_malloc(float, 517);
+    g3 = slach_malloc(float, 517); g4 = slach_malloc(float, 517);
+    for (i=0; i<517*260; i++) g1[i] = i%260 < 257 ? uRand(-1,1) : 0; //zero padding past lda
+    for (i=0; i<517; i++) g2[i] = uRand(-1,1);
+    for (t=0; t<2; t++){
+        for (i=0; i<517; i++) g3[i] = 1;
+        gemvEx(t, 517, 257, 0.5, g1, 260, g2, 2, g3);
+        naiveMul(t, 0, t?260:517, 1, t?517:260, g1, g2, g4);
+        for (i=0; i<(t?257:517); i++) assert(fabs(g3[i]-(0.5*g4[i]+2)) < 1e-4);
+    }
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
     mmAdd(a1,3,3,a6,3,3,a5,3,3);
     printmArr(a5,3,3);
     vvAdd(a7,3,a2,3,a3,3);
     printvArr(a3,3);
     mT(a1,3,3,a5,3,3);
     printmArr(a5,3,3);
+    //blocked transpose against the definition, then in place (square and rectangular)
+    g1 = slach_malloc(float, 137*75); g2 = slach_malloc(float, 137*75);
+    for (i=0; i<137*75; i++) g1[i] = (float)i;
+    mT(g1,137,75,g2,75,137);
+    for (i=0; i<137*75; i++) assert(g2[(i%75)*137+i/75] == g1[i]);
+    mTInplace(g1,137,75);
+    for (i=0; i<137*75; i++) assert(g1[i] == g2[i]);
+    for (i=0; i<75*75; i++) g1[i] = (float)i;
+    mT(g1,75,75,g1,75,75);
+    for (i=0; i<75*75; i++) assert(g1[i] == (float)((i%75)*75+i/75));
+    slach_free(g1); slach_free(g2);
     printvArr(a7,3);printvArr(a2,3);
     Dot = dot(a7,3,a2,3);
 	printf("dot: %f\n",Dot);
@@ -151,6 +531,454 @@ int main(){
     QRsolvev(a1,3,3,a2,3,a3,3);
     printvArr(a3,3);
 
+    //SYRK: one triangle against the full product, the other one untouched unless mirrored
+    g1 = slach_malloc(float, 300*77); g2 = slach_malloc(float, 300*300);
+    g3 = slach_malloc(float, 300*300); g4 = slach_malloc(float, 300*300);
+    for (i=0; i<300*77; i++) g1[i] = uRand(-1,1);
+    for (t=0; t<8; t++){
+        up = t&1; tr = (t>>1)&1; un = t>>2;
+        for (i=0; i<300*300; i++) g2[i] = g3[i] = (float)(i%7);
+        syrkEx(up, tr, tr ? 77 : 300, tr ? 300 : 77, 2, g1, 77, 0.5, g2, 300, un);
+        mb = tr ? 77 : 300;
+        naiveMul(tr, !tr, mb, mb, 300*77/mb, g1, g1, g4);
+        for (i=0; i<mb*mb; i++){
+            size_t r = i/mb, c = i%mb;
+            int in = up == SLACH_LOWER ? c <= r : c >= r;
+            if (in) assert(fabs(g2[r*300+c]-(2*g4[i]+0.5*g3[r*300+c])) < 1e-3);
+            else if (un) assert(g2[r*300+c] == g2[c*300+r]);
+            else assert(g2[r*300+c] == g3[r*300+c]);
+        }
+    }
+    mGram(g1, 300, 77, g2, 77, 77);
+    naiveMul(1, 0, 77, 77, 300, g1, g1, g4);
+    for (i=0; i<77*77; i++) assert(fabs(g2[i]-g4[i]) < 1e-3);
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
+    //reproducible mode: the same bits with 1 and 4 threads, and close to the fast path
+    g1 = slach_malloc(float, 300001); g2 = slach_malloc(float, 300*300); g3 = slach_malloc(float, 300*300);
+    for (i=0; i<300001; i++) g1[i] = uRand(-1,1);
+    slach_set_reproducible(1);
+    slach_set_num_threads(1);
+    a3[0] = dotEx(g1, g1+1, 300000, SUM_FAST);
+    a3[1] = nrm2Ex(g1, 300001, SUM_PAIRWISE);
+    gemmEx(0, 1, 300, 300, 77, g1, 77, g1+5, 77, g2, 300, NULL);
+    gemvEx(1, 300, 300, 1, g2, 300, g1, 0, g2+300*299);
+    slach_set_num_threads(4);
+    assert(dotEx(g1, g1+1, 300000, SUM_KAHAN) == a3[0]);
+    assert(nrm2Ex(g1, 300001, SUM_FAST) == a3[1]);
+    gemmEx(0, 1, 300, 300, 77, g1, 77, g1+5, 77, g3, 300, NULL);
+    gemvEx(1, 300, 300, 1, g3, 300, g1, 0, g3+300*299);
+    assert(memcmp(g2, g3, 300*300*sizeof(float)) == 0);
+    slach_set_reproducible(0);
+    assert(fabs(dotEx(g1, g1+1, 300000, SUM_PAIRWISE)-a3[0]) < 1e-4*(1+fabs(a3[0])));
+    assert(fabs(nrm2Ex(g1, 300001, SUM_PAIRWISE)-a3[1]) < 1e-5*a3[1]);
+    naiveMul(0, 1, 299, 300, 77, g1, g1+5, g3);
+    for (i=0; i<299*300; i++) assert(fabs(g2[i]-g3[i]) < 1e-4);
+    slach_free(g1); slach_free(g2); slach_free(g3);
+    //singular values through the Gram matrix: sorted, and their squares add up to |A|_F^2
+    getS(a8,8,3,a9,3);
+    for (i=0, f=0; i<24; i++) f += a8[i/3][i%3]*a8[i/3][i%3];
+    assert(a9[0] >= a9[1] && a9[1] >= a9[2] && a9[2] > 0);
+    assert(fabs(a9[0]*a9[0]+a9[1]*a9[1]+a9[2]*a9[2]-f) < 1e-2*f);
+
+    //TRSM/TRMM in every flavour against a dense op(A), 150 crosses a diagonal block
+    g1 = slach_malloc(float, 150*150); g4 = slach_malloc(float, 150*150);
+    g2 = slach_malloc(float, 150*41); g3 = slach_malloc(float, 150*41); g5 = slach_malloc(float, 150*41);
+    for (i=0; i<150*150; i++) g1[i] = uRand(-1,1)/15;
+    for (i=0; i<150; i++) g1[i*150+i] = uRand(1,2);
+    for (i=0; i<150*41; i++) g2[i] = uRand(-1,1);
+    for (t=0; t<32; t++){
+        side = t&1; up = (t>>1)&1; tr = (t>>2)&1; un = (t>>3)&1;
+        mb = side == SLACH_LEFT ? 150 : 41; nbr = 150*41/mb;
+        na = side == SLACH_LEFT ? mb : nbr;
+        //dense op(A) with only the referenced triangle
+        for (i=0; i<na*na; i++){
+            size_t r = i/na, c = i%na, sr = tr ? c : r, sc = tr ? r : c;
+            g4[i] = (up == SLACH_LOWER ? sc <= sr : sc >= sr) ? g1[sr*na+sc] : 0;
+            if (r == c && un == SLACH_UNIT) g4[i] = 1;
+        }
+        memcpy(g3, g2, 150*41*sizeof(float));
+        if (t < 16){
+            trmmEx(side, up, tr, un, mb, nbr, 0.5, g1, na, g3, nbr);
+            if (side == SLACH_LEFT) naiveMul(0, 0, mb, nbr, mb, g4, g2, g5);
+            else naiveMul(0, 0, mb, nbr, nbr, g2, g4, g5);
+            for (i=0; i<150*41; i++) assert(fabs(g3[i]-0.5*g5[i]) < 1e-4);
+        }
+        else{
+            trsmEx(side, up, tr, un, mb, nbr, 2, g1, na, g3, nbr);
+            if (side == SLACH_LEFT) naiveMul(0, 0, mb, nbr, mb, g4, g3, g5);
+            else naiveMul(0, 0, mb, nbr, nbr, g3, g4, g5);
+            for (i=0; i<150*41; i++) assert(fabs(g5[i]-2*g2[i]) < 1e-4);
+        }
+    }
+    //blocked LU and QR solves on a random system, residual checked. The system is a scaled
+    //permutation plus noise, well-conditioned whatever the seed, and pivoting still has work
+    for (i=0; i<150*150; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<150; i++) g1[i*150+(i*7+3)%150] += i&1 ? -150 : 150;
+    LUsolvem(g1,150,150,g2,150,41,g3,150,41);
+    naiveMul(0, 0, 150, 41, 150, g1, g3, g5);
+    for (i=0; i<150*41; i++) assert(fabs(g5[i]-g2[i]) < 1e-2);
+    QRsolvem(g1,150,150,g2,150,41,g3,150,41);
+    naiveMul(0, 0, 150, 41, 150, g1, g3, g5);
+    for (i=0; i<150*41; i++) assert(fabs(g5[i]-g2[i]) < 1e-2);
+    LUsolvev(g1,150,150,g2,150,g3,150);
+    QRsolvev(g1,150,150,g2,150,g5,150);
+    for (i=0; i<150; i++) assert(fabs(g3[i]-g5[i]) < 1e-2*(1+fabs(g3[i])));
+    slach_free(g2); slach_free(g3); slach_free(g5);
+    g2 = slach_malloc(float, 150*150);
+    inv(g1,150,150,g4,150,150);
+    naiveMul(0, 0, 150, 150, 150, g1, g4, g2);
+    for (i=0; i<150*150; i++) assert(fabs(g2[i]-(i%151 == 0)) < 1e-2);
+    //one factorization, solves with A and A^T, and PA = LU from the extracted factors; the
+    //checks are backward errors relative to |A||x| and max|A|, so they hold for any matrix
+    lu = LUfactor(g1,150,150);
+    assert(LUfactorSize(lu) == 150 && !LUfactorSingular(lu));
+    for (i=0; i<150; i++) g4[i] = uRand(-1,1);
+    LUfactorSolvev(lu,1,g4,150,g4+150,150);
+    naiveMul(1, 0, 150, 1, 150, g1, g4+150, g2);
+    for (i=0; i<150; i++){
+        for (t=0, sum=fabs(g4[i]); t<150; t++) sum += fabs(g1[t*150+i]*g4[150+t]);
+        assert(fabs(g2[i]-g4[i]) < 1e-4*sum);
+    }
+    LUfactorSolvem(lu,0,g4,150,1,g4+150,150,1);
+    LUsolvev(g1,150,150,g4,150,g4+300,150);
+    for (i=0; i<150; i++) assert(g4[150+i] == g4[300+i]);
+    g3 = slach_malloc(float, 150*150);
+    ix = slach_malloc(size_t, 150);
+    LUfactorL(lu,g2,150,150);
+    LUfactorU(lu,g4,150,150);
+    naiveMul(0, 0, 150, 150, 150, g2, g4, g3);
+    LUfactorP(lu,g2,150,150,ix);
+    for (i=0, f=0; i<150*150; i++) f = MAX(f, fabs(g1[i]));
+    for (i=0; i<150*150; i++) assert(fabs(g3[i]-g1[ix[i/150]*150+i%150]) < 1e-5*f);
+    for (i=0; i<150; i++) assert(g2[i*150+ix[i]] == 1);
+    LUfactorDestroy(lu);
+    slach_free(g3); slach_free(ix);
+    slach_free(g1); slach_free(g2); slach_free(g4);
+
+    //tuning file: another CPU's section survives a save, ours is read back and drives GEMM
+    tf = fopen("slach_tune_test.tmp", "w");
+    fprintf(tf, "[other cpu]\ngemm_kc = 7\n");
+    fclose(tf);
+    slach_tune_default(&tn);
+    tn.gemmKC = 100; tn.gemmMC = 20; tn.gemmNC = 20; tn.trsmBlock = 40;
+    assert(slach_tune_save("slach_tune_test.tmp", &tn) == 0);
+    slach_tune_default(&tn);
+    slach_tune_set(&tn);
+    //thread pool: nested loops, pinned workers, a deferred executor, and a threaded GEMM
+    iv = slach_malloc(int, 64*1000);
+    slach_set_num_threads(4);
+    slach_parallel_for(64, 1, nestedFn, iv);
+    slach_set_affinity(1);
+    slach_parallel_for(64, 1, nestedFn, iv);
+    slach_set_affinity(0);
+    slach_set_executor(&ex);
+    slach_parallel_for(64*1000, 100, addOneFn, iv);
+    assert(tq.n == slach_get_num_threads()-1); //3, or 0 with -DSLACH_NO_THREADS
+    for (i=0; i<tq.n; i++) tq.fn[i](tq.arg[i]);
+    slach_set_executor(NULL);
+    for (i=0; i<64*1000; i++) assert(iv[i] == 3);
+    slach_free(iv);
+    g1 = slach_malloc(float, 400*300); g2 = slach_malloc(float, 300*500);
+    g3 = slach_malloc(float, 400*500); g4 = slach_malloc(float, 400*500);
+    for (i=0; i<400*300; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<300*500; i++) g2[i] = uRand(-1,1);
+    gemmEx(0, 0, 400, 500, 300, g1, 300, g2, 500, g3, 500, NULL);
+    naiveMul(0, 0, 400, 500, 300, g1, g2, g4);
+    for (i=0; i<400*500; i++) assert(fabs(g3[i]-g4[i]) < 1e-4);
+    complexArr = slach_malloc(complex, 64*64);
+    for (i=0; i<64*64; i++){ complexArr[i].re = uRand(-1,1); complexArr[i].im = 0; }
+    complexOut = FFT_CooleyTukey(complexArr, 64*64, 64, 64);
+    for (i=0, f=0; i<64*64; i++) f += complexArr[i].re;
+    assert(fabs(complexOut[0].re-f) < 1e-2 && fabs(complexOut[0].im) < 1e-2);
+    slach_free(complexArr); slach_free(complexOut);
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
+    //async: a solve feeds a GEMM that checks it, an FFT runs alongside, both gate a final task
+    g1 = slach_malloc(float, 64*64); g2 = slach_malloc(float, 64*8);
+    g3 = slach_malloc(float, 64*8); g4 = slach_malloc(float, 64*8);
+    for (i=0; i<64*64; i++) g1[i] = uRand(-1,1) + (i%65 == 0 ? 64 : 0);
+    for (i=0; i<64*8; i++) g2[i] = uRand(-1,1);
+    complexArr = slach_malloc(complex, 256);
+    for (i=0; i<256; i++){ complexArr[i].re = 1; complexArr[i].im = 0; }
+    t = 0;
+    tk[0] = slach_submit_LUsolvem(g1, 64, 64, g2, 64, 8, g3, 64, 8, NULL, 0);
+    tk[1] = slach_submit_gemmEx(0, 0, 64, 8, 64, g1, 64, g3, 8, g4, 8, NULL, tk, 1);
+    slach_on_complete(tk[1], countFn, &t);
+    tk[2] = slach_submit_FFT_CooleyTukey(complexArr, 256, 16, 16, &complexOut, NULL, 0);
+    tk[3] = slach_submit(countFn, &t, tk+1, 2);
+    slach_wait(tk[3]);
+    assert(slach_test(tk[0]) && slach_test(tk[1]) && slach_test(tk[2]) && t == 2);
+    slach_on_complete(tk[3], countFn, &t);
+    assert(t == 3);
+    for (i=0; i<64*8; i++) assert(fabs(g4[i]-g2[i]) < 1e-3);
+    assert(fabs(complexOut[0].re-256) < 1e-2 && fabs(complexOut[1].re) < 1e-2);
+    for (i=0; i<4; i++) slach_release(tk[i]);
+    slach_free(complexArr); slach_free(complexOut);
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
+    //lazy graph: inv -> product with a transpose -> scale, add, bias, sin all fused into the
+    //GEMM writing straight into its output; the second output is one fused element-wise pass
+    g1 = slach_malloc(float, 64*64); g2 = slach_malloc(float, 64*64); g3 = slach_malloc(float, 64*64);
+    g4 = slach_malloc(float, 64*64); g5 = slach_malloc(float, 64*64); g6 = slach_malloc(float, 2*64*64);
+    for (i=0; i<64*64; i++){
+        g1[i] = uRand(-1,1) + (i%65 == 0 ? 64 : 0);
+        g2[i] = uRand(-1,1);
+        g3[i] = uRand(-1,1);
+    }
+    gr = slach_graph_create();
+    nd[0] = slach_lazy_input(gr, g1, 64, 64);
+    nd[1] = slach_lazy_input(gr, g2, 64, 64);
+    nd[2] = slach_lazy_input(gr, g3, 64, 64);
+    nd[3] = slach_lazy_input(gr, g3, 1, 64);
+    nd[4] = slach_lazy_mmMul(gr, slach_lazy_inv(gr, nd[0]), slach_lazy_mT(gr, nd[1]));
+    nd[5] = slach_lazy_ewBinaryScalar(gr, EW_MUL, nd[4], 0.5f);
+    nd[6] = slach_lazy_ewBinary(gr, EW_ADD, slach_lazy_mmAdd(gr, nd[5], nd[2]), nd[3]);
+    nd[7] = slach_lazy_ew(gr, EW_SIN, 0, nd[6]);
+    nd[8] = slach_lazy_ew(gr, EW_EXP, 0, slach_lazy_ewBinaryScalar(gr, EW_MUL, nd[2], 0.1f));
+    nd[9] = slach_lazy_ewBinary(gr, EW_SUB, nd[8], nd[7]);
+    slach_lazy_output(gr, nd[7], g4, 64, 64);
+    slach_lazy_output(gr, nd[9], g5, 64, 64);
+    slach_lazy_mT(gr, nd[9]); //never used, dropped
+    assert(slach_eval(gr) == 64*64);
+    for (t=0; t<2; t++){
+        inv(g1, 64, 64, g6, 64, 64);
+        naiveMul(0, 1, 64, 64, 64, g6, g2, g6+64*64);
+        for (i=0; i<64*64; i++){
+            a3[0] = sinf(0.5f*g6[64*64+i] + g3[i] + g3[i%64]);
+            assert(fabs(g4[i]-a3[0]) < 1e-4);
+            assert(fabs(g5[i]-(expf(0.1f*g3[i])-a3[0])) < 1e-4);
+        }
+        //inputs changed: the same graph again
+        for (i=0; i<64*64; i++) g3[i] = uRand(-1,1);
+        if (t == 0) assert(slach_eval(gr) == 64*64);
+    }
+    slach_graph_destroy(gr);
+    //a chain of products needs two intermediate buffers whatever its length
+    gr = slach_graph_create();
+    nd[0] = slach_lazy_input(gr, g2, 64, 64);
+    for (nd[1]=nd[0], i=0; i<4; i++) nd[1] = slach_lazy_mmMul(gr, nd[1], nd[0]);
+    slach_lazy_output(gr, nd[1], g4, 64, 64);
+    assert(slach_eval(gr) == 2*64*64);
+    naiveMul(0, 0, 64, 64, 64, g2, g2, g5);
+    naiveMul(0, 0, 64, 64, 64, g5, g5, g6);
+    naiveMul(0, 0, 64, 64, 64, g6, g2, g5);
+    for (i=0; i<64*64; i++) assert(fabs(g4[i]-g5[i]) < 1e-2*(1+fabs(g5[i])));
+    slach_graph_destroy(gr);
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4); slach_free(g5); slach_free(g6);
+    //matrix functions: exp of a rotation generator, exp(A)exp(-A) = I, powers against repeated
+    //products and the inverse, square root of an SPD matrix squared back
+    a4[0][0] = 0; a4[0][1] = -20; a4[1][0] = 20; a4[1][1] = 0;
+    mExp(a4, 2, 2, a4, 2, 2);
+    assert(fabs(a4[0][0]-cos(20)) < 1e-4 && fabs(a4[1][0]-sin(20)) < 1e-4 && fabs(a4[0][1]+sin(20)) < 1e-4);
+    g1 = slach_malloc(float, 40*40); g2 = slach_malloc(float, 40*40); g3 = slach_malloc(float, 40*40);
+    g4 = slach_malloc(float, 40*40); g5 = slach_malloc(float, mfuncWorkSize(40));
+    for (i=0; i<40*40; i++) g1[i] = uRand(-0.3,0.3);
+    mExpEx(40, g1, g2, g5);
+    for (i=0; i<40*40; i++) g4[i] = -g1[i];
+    mExpEx(40, g4, g3, g5);
+    naiveMul(0, 0, 40, 40, 40, g2, g3, g4);
+    for (i=0; i<40*40; i++) assert(fabs(g4[i]-(i%41 == 0)) < 1e-4);
+    for (i=0; i<40*40; i++) g1[i] = uRand(-1,1)/8 + (i%41 == 0);
+    mPowEx(40, g1, 5, g2, g5);
+    naiveMul(0, 0, 40, 40, 40, g1, g1, g3);
+    naiveMul(0, 0, 40, 40, 40, g3, g3, g4);
+    naiveMul(0, 0, 40, 40, 40, g4, g1, g3);
+    for (i=0; i<40*40; i++) assert(fabs(g2[i]-g3[i]) < 1e-3*(1+fabs(g3[i])));
+    mPow(g1, 40, 40, -2, g2, 40, 40);
+    naiveMul(0, 0, 40, 40, 40, g2, g1, g3);
+    naiveMul(0, 0, 40, 40, 40, g3, g1, g4);
+    for (i=0; i<40*40; i++) assert(fabs(g4[i]-(i%41 == 0)) < 1e-4);
+    mPowEx(40, g1, 0, g2, g5);
+    for (i=0; i<40*40; i++) assert(g2[i] == (i%41 == 0));
+    naiveMul(0, 1, 40, 40, 40, g1, g1, g3);
+    mSqrt(g3, 40, 40, g2, 40, 40);
+    naiveMul(0, 0, 40, 40, 40, g2, g2, g4);
+    for (i=0; i<40*40; i++) assert(fabs(g4[i]-g3[i]) < 1e-4*(1+fabs(g3[i])));
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4); slach_free(g5);
+    //distance matrices over several tiles against direct sums, then kNN against sorted rows
+    g1 = slach_malloc(float, 300*20); g2 = slach_malloc(float, 1500*20);
+    g3 = slach_malloc(float, 300*1500); g4 = slach_malloc(float, 300*1500);
+    g5 = slach_malloc(float, 300*7); ix = slach_malloc(size_t, 300*7);
+    for (i=0; i<300*20; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<1500*20; i++) g2[i] = uRand(-1,1);
+    for (i=0; i<300*1500; i++){
+        for (t=0, f=0; t<20; t++) f += (g1[i/1500*20+t]-g2[i%1500*20+t])*(g1[i/1500*20+t]-g2[i%1500*20+t]);
+        g3[i] = f;
+    }
+    pdist(DIST_SQEUCLIDEAN, g1, 300, 20, g2, 1500, 20, g4, 300, 1500);
+    for (i=0; i<300*1500; i++) assert(fabs(g4[i]-g3[i]) < 1e-4*(1+g3[i]));
+    pdistEx(DIST_EUCLIDEAN, 300, 1500, 20, g1, 20, g2, 20, g4, 1500);
+    for (i=0; i<300*1500; i++) assert(fabs(g4[i]-sqrt(g3[i])) < 1e-4*(1+g3[i]));
+    pdistEx(DIST_COSINE, 300, 1500, 20, g1, 20, g2, 20, g4, 1500);
+    for (i=0; i<300*1500; i++){
+        for (t=0, f=0, sum=0, vn=0; t<20; t++){
+            f += g1[i/1500*20+t]*g2[i%1500*20+t];
+            sum += g1[i/1500*20+t]*g1[i/1500*20+t];
+            vn += g2[i%1500*20+t]*g2[i%1500*20+t];
+        }
+        assert(fabs(g4[i]-(1-f/sqrt(sum*vn))) < 1e-4);
+    }
+    knnEx(DIST_EUCLIDEAN, 300, 1500, 20, g1, 20, g2, 20, 7, g5, ix);
+    for (i=0; i<300; i++){
+        for (t=0; t<7; t++) assert(fabs(g5[i*7+t]-sqrt(g3[i*1500+ix[i*7+t]])) < 1e-4);
+        qsort(g3+i*1500, 1500, sizeof(float), floatCmp);
+        for (t=0; t<7; t++) assert(fabs(g5[i*7+t]-sqrt(g3[i*1500+t])) < 1e-4);
+    }
+    knnEx(DIST_SQEUCLIDEAN, 300, 300, 20, g1, 20, g1, 20, 1, g5, ix);
+    for (i=0; i<300; i++) assert(ix[i] == (size_t)i && g5[i] < 1e-4);
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4); slach_free(g5); slach_free(ix);
+    //every convolution algorithm against the direct sum: padded 3x3, strided 5x4, deep 3x3, 11x11
+    g1 = slach_malloc(float, 16*40*40); g2 = slach_malloc(float, 8*16*11*11);
+    g3 = slach_malloc(float, 8*40*40); g4 = slach_malloc(float, 8*40*40);
+    for (i=0; i<16*40*40; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<8*16*11*11; i++) g2[i] = uRand(-1,1);
+    naiveConv(0, 3, 23, 29, g1, 3, 3, 3, g2, bias, 1, 1, g3);
+    for (t=CONV_GEMM; t<=CONV_FFT; t++){
+        conv2dEx(t, 0, 3, 23, 29, g1, 3, 3, 3, g2, bias, 1, 1, g4);
+        for (i=0; i<3*23*29; i++) assert(fabs(g4[i]-g3[i]) < 1e-4*(1+fabs(g3[i])));
+    }
+    naiveConv(1, 4, 23, 29, g1, 3, 5, 4, g2, NULL, 2, 2, g3);
+    for (t=CONV_AUTO; t<=CONV_FFT; t++){
+        conv2dEx(t, 1, 4, 23, 29, g1, 3, 5, 4, g2, NULL, 2, 2, g4);
+        for (i=0; i<3*12*15; i++) assert(fabs(g4[i]-g3[i]) < 1e-4*(1+fabs(g3[i])));
+    }
+    naiveConv(0, 16, 40, 40, g1, 8, 3, 3, g2, NULL, 1, 0, g3);
+    conv2dEx(CONV_AUTO, 0, 16, 40, 40, g1, 8, 3, 3, g2, NULL, 1, 0, g4);
+    for (i=0; i<8*38*38; i++) assert(fabs(g4[i]-g3[i]) < 1e-4*(1+fabs(g3[i])));
+    naiveConv(1, 1, 40, 37, g1, 1, 11, 11, g2, NULL, 1, 5, g3);
+    conv2d(g1, 40, 37, g2, 11, 11, 1, 5, g4, 40, 37);
+    for (i=0; i<40*37; i++) assert(fabs(g4[i]-g3[i]) < 1e-4*(1+fabs(g3[i])));
+    naiveConv(0, 1, 40, 37, g1, 1, 11, 11, g2, NULL, 3, 0, g3);
+    corr2d(g1, 40, 37, g2, 11, 11, 3, 0, g4, 10, 9);
+    for (i=0; i<10*9; i++) assert(fabs(g4[i]-g3[i]) < 1e-4*(1+fabs(g3[i])));
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
+    //Walsh-Hadamard against the +-1 matrix, then blocked and strided transforms applied twice
+    g1 = slach_malloc(float, 1<<14); g2 = slach_malloc(float, 1<<14); g3 = slach_malloc(float, 1024*7);
+    for (i=0; i<64; i++) g1[i] = g2[i] = uRand(-1,1);
+    fwht(g1, 64);
+    for (i=0; i<64; i++){
+        for (t=0, f=0; t<64; t++) f += (__builtin_popcount(i & t) & 1 ? -1 : 1)*g2[t];
+        assert(fabs(g1[i]-f) < 1e-4);
+    }
+    for (i=0; i<(1<<14); i++) g1[i] = g2[i] = uRand(-1,1);
+    fwht(g1, 1<<14); fwht(g1, 1<<14);
+    for (i=0; i<(1<<14); i++) assert(fabs(g1[i]/(1<<14)-g2[i]) < 1e-4);
+    for (i=0; i<1024*7; i++) g3[i] = g2[i];
+    fwhtEx(1024, 5, g3, 7); fwhtEx(1024, 5, g3, 7);
+    for (i=0; i<1024*7; i++) assert(fabs(g3[i]/(i%7 < 5 ? 1024 : 1)-g2[i]) < 1e-4);
+    slach_free(g1); slach_free(g2); slach_free(g3);
+    //tall QR: exact system, then the least squares residual is orthogonal to the columns
+    g1 = slach_malloc(float, 3000*8); g2 = slach_malloc(float, 3000); g3 = slach_malloc(float, 8);
+    g4 = slach_malloc(float, 400*8); g5 = slach_malloc(float, 3000);
+    for (i=0; i<3000*8; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<8; i++) a12[i] = i - 3.5f;
+    naiveMul(0, 0, 60, 1, 8, g1, a12, g2);
+    QRsolvev(g1, 60, 8, g2, 60, g3, 8);
+    for (i=0; i<8; i++) assert(fabs(g3[i]-a12[i]) < 1e-4);
+    for (i=0; i<60; i++) g2[i] += uRand(-1,1);
+    QRsolvem(g1, 60, 8, g2, 60, 1, g3, 8, 1);
+    naiveMul(0, 0, 60, 1, 8, g1, g3, g5);
+    for (i=0; i<60; i++) g5[i] = g2[i] - g5[i];
+    naiveMul(1, 0, 8, 1, 60, g1, g5, a13);
+    for (i=0; i<8; i++) assert(fabs(a13[i]) < 1e-4);
+    //every sketch keeps norms of the column space and solves an exact system
+    naiveMul(0, 0, 3000, 1, 8, g1, a12, g2);
+    for (t=SKETCH_SRHT; t<=SKETCH_GAUSSIAN; t++){
+        sk = sketchCreate(t, 400, 3000, 0);
+        sketchApply(sk, 8, g1, 8, g4, 8);
+        for (i=0; i<8; i++) a13[i] = uRand(-1,1);
+        naiveMul(0, 0, 3000, 1, 8, g1, a13, g5);
+        for (i=0, sum=0; i<3000; i++) sum += g5[i]*g5[i];
+        naiveMul(0, 0, 400, 1, 8, g4, a13, g5);
+        for (i=0, f=0; i<400; i++) f += g5[i]*g5[i];
+        assert(f > 0.5*sum && f < 1.5*sum);
+        sketchDestroy(sk);
+        sketchSolve(t, 400, g1, 3000, 8, g2, 3000, 1, g3, 8, 1);
+        for (i=0; i<8; i++) assert(fabs(g3[i]-a12[i]) < 1e-3);
+    }
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4); slach_free(g5);
+    //two processes share a gemm and an FFT through a segment, rank 0 checks the results
+    //under a name still held by a job that died during setup: magic set, one of two ranks joined
+    snprintf(line, sizeof(line), "/slach_test_%d", (int)getpid());
+    ix = slach_malloc(size_t, 4);
+    ((unsigned int*)ix)[0] = 0x534c4348u; ((unsigned int*)ix)[1] = 1; ((unsigned int*)ix)[4] = 2;
+    ix[3] = (64*48 + 48*80 + 64*80)*sizeof(float) + 3*48*sizeof(complex);
+    t = shm_open(line, O_CREAT | O_RDWR, 0600);
+    assert(t >= 0 && ftruncate(t, 4096 + ix[3]) == 0 && write(t, ix, 4*sizeof(size_t)) == 4*sizeof(size_t));
+    close(t);
+    slach_free(ix);
+    pid = fork();
+    assert(pid >= 0);
+    if (pid != 0) usleep(100000); //rank 1 finds the stale segment first
+    sh = slach_shard_open(line, 2, pid == 0, (64*48 + 48*80 + 64*80)*sizeof(float) + 3*48*sizeof(complex));
+    g1 = (float*)slach_shard_data(sh); g2 = g1 + 64*48; g3 = g2 + 48*80;
+    complexArr = (complex*)(g3 + 64*80);
+    if (pid != 0){
+        for (i=0; i<64*48; i++) g1[i] = uRand(-1,1);
+        for (i=0; i<48*80; i++) g2[i] = uRand(-1,1);
+        for (i=0; i<48; i++){
+            complexArr[i].re = uRand(-1,1); complexArr[i].im = uRand(-1,1);
+        }
+    }
+    slach_shard_barrier(sh);
+    slach_shard_gemmEx(sh, 0, 0, 64, 80, 48, g1, 48, g2, 80, g3, 80, NULL);
+    slach_shard_fft(sh, complexArr, 48, 6, 8, complexArr + 48, complexArr + 96);
+    if (pid == 0){
+        slach_shard_close(sh);
+        _exit(0);
+    }
+    g4 = slach_malloc(float, 64*80);
+    naiveMul(0, 0, 64, 80, 48, g1, g2, g4);
+    for (i=0; i<64*80; i++) assert(fabs(g3[i]-g4[i]) < 1e-4);
+    complexOut = FFT_CooleyTukey(complexArr, 48, 6, 8);
+    for (i=0; i<48; i++) assert(fabs(complexOut[i].re-complexArr[96+i].re) < 1e-4 && fabs(complexOut[i].im-complexArr[96+i].im) < 1e-4);
+    slach_free(complexOut); slach_free(g4);
+    slach_shard_close(sh);
+    assert(waitpid(pid, &t, 0) == pid && WIFEXITED(t) && WEXITSTATUS(t) == 0);
+    //out-of-core product on files in 64x64 tiles with an epilogue, then in one tile
+    g1 = slach_malloc(float, 300*200); g2 = slach_malloc(float, 200*250);
+    g3 = slach_malloc(float, 300*250); g4 = slach_malloc(float, 300*250); g5 = slach_malloc(float, 250);
+    for (i=0; i<300*200; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<200*250; i++) g2[i] = uRand(-1,1);
+    for (i=0; i<300*250; i++) g4[i] = 1;
+    for (i=0; i<250; i++) g5[i] = i;
+    tf = fopen("slach_ooc_a.tmp", "wb"); assert(fwrite(g1, sizeof(float), 300*200, tf) == 300*200); fclose(tf);
+    tf = fopen("slach_ooc_b.tmp", "wb"); assert(fwrite(g2, sizeof(float), 200*250, tf) == 200*250); fclose(tf);
+    tf = fopen("slach_ooc_c.tmp", "wb"); assert(fwrite(g4, sizeof(float), 300*250, tf) == 300*250); fclose(tf);
+    assert(oocTileSize(5*sizeof(float)*64*64) == 64);
+    gemmEpilogueInit(&ep);
+    ep.alpha = 2; ep.beta = 1; ep.rowBias = g5;
+    oocGemmEx("slach_ooc_a.tmp", "slach_ooc_b.tmp", "slach_ooc_c.tmp", 300, 250, 200, 5*sizeof(float)*64*64, &ep);
+    naiveMul(0, 0, 300, 250, 200, g1, g2, g3);
+    tf = fopen("slach_ooc_c.tmp", "rb"); assert(fread(g4, sizeof(float), 300*250, tf) == 300*250); fclose(tf);
+    for (i=0; i<300*250; i++) assert(fabs(g4[i]-(2*g3[i]+1+i%250)) < 1e-3);
+    remove("slach_ooc_c.tmp");
+    oocGemmEx("slach_ooc_a.tmp", "slach_ooc_b.tmp", "slach_ooc_c.tmp", 300, 250, 200, 1<<24, NULL);
+    tf = fopen("slach_ooc_c.tmp", "rb"); assert(fread(g4, sizeof(float), 300*250, tf) == 300*250); fclose(tf);
+    for (i=0; i<300*250; i++) assert(fabs(g4[i]-g3[i]) < 1e-4);
+    //k == 0 leaves epilogue(beta*C), tile by tile
+    ep.alpha = 1; ep.beta = 2;
+    oocGemmEx("slach_ooc_a.tmp", "slach_ooc_b.tmp", "slach_ooc_c.tmp", 300, 250, 0, 5*sizeof(float)*64*64, &ep);
+    tf = fopen("slach_ooc_c.tmp", "rb"); assert(fread(g3, sizeof(float), 300*250, tf) == 300*250); fclose(tf);
+    for (i=0; i<300*250; i++) assert(g3[i] == 2*g4[i]+i%250);
+    remove("slach_ooc_a.tmp"); remove("slach_ooc_b.tmp"); remove("slach_ooc_c.tmp");
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4); slach_free(g5);
+    assert(slach_tune_load("slach_tune_test.tmp") == 0);
+    assert(slach_tune()->gemmKC == 100 && slach_tune()->gemmMC == 24 && slach_tune()->gemmNC == 20 &&
+           slach_tune()->trsmBlock == 40);
+    tf = fopen("slach_tune_test.tmp", "r");
+    assert(fgets(line, sizeof(line), tf) != NULL && strcmp(line, "[other cpu]\n") == 0);
+    fclose(tf);
+    remove("slach_tune_test.tmp");
+    g1 = slach_malloc(float, 150*300); g2 = slach_malloc(float, 300*41);
+    g3 = slach_malloc(float, 150*41); g4 = slach_malloc(float, 150*41);
+    for (i=0; i<150*300; i++) g1[i] = uRand(-1,1);
+    for (i=0; i<300*41; i++) g2[i] = uRand(-1,1);
+    gemmEx(0, 0, 150, 41, 300, g1, 300, g2, 41, g3, 41, NULL);
+    naiveMul(0, 0, 150, 41, 300, g1, g2, g4);
+    for (i=0; i<150*41; i++) assert(fabs(g3[i]-g4[i]) < 1e-4);
+    slach_free(g1); slach_free(g2); slach_free(g3); slach_free(g4);
+    slach_tune_default(&tn);
+    slach_tune_set(&tn);
+
     /*
     Test SVD
    */
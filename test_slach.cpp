@@ -0,0 +1,80 @@
+#include "./include/slach.hpp"
+#include <cassert>
+#include <cmath>
+
+/*
+test of the C++ front end (include/slach.hpp): expression results against plain loops, with
+destinations that alias an operand
+ */
+
+/*
+fills a with a(i, j) = i*cols + j + 1, so a is not symmetric
+ */
+static void fill(slach::DynMatrix& a){
+    std::size_t i, j;
+    for (i=0; i<a.rows(); i++)
+        for (j=0; j<a.cols(); j++)
+            a(i, j) = (float)(i*a.cols()+j+1);
+}
+
+int main(){
+    std::size_t i, j, k;
+    float sum;
+    slach::DynMatrix a(3, 3), b(3, 3), c(3, 3), d(3, 3), x(3, 3), ref(3, 3);
+
+    //fixed-size matrices
+    slach::Matrix<float, 2, 2> m = slach::Matrix<float, 2, 2>::identity();
+    slach::Matrix<float, 2, 2> n = 2.0f*m + m;
+    n = n*slach::transpose(n);
+    assert(n(0, 0) == 9 && n(0, 1) == 0 && n(1, 1) == 9);
+
+    //products and sums through gemmEx and axpby
+    fill(a); fill(b);
+    c = a*b;
+    for (i=0; i<3; i++)
+        for (j=0; j<3; j++){
+            for (sum=0, k=0; k<3; k++) sum += a(i, k)*b(k, j);
+            assert(c(i, j) == sum);
+        }
+    d = 2*a.t()*b + c;
+    for (i=0; i<3; i++)
+        for (j=0; j<3; j++){
+            for (sum=0, k=0; k<3; k++) sum += 2*a(k, i)*b(k, j);
+            assert(d(i, j) == sum + c(i, j));
+        }
+    d = 3*a + b;
+    for (i=0; i<3; i++)
+        for (j=0; j<3; j++) assert(d(i, j) == 3*a(i, j) + b(i, j));
+
+    //destinations aliasing an operand with another layout: the result must be symmetric
+    fill(x);
+    x = x.t() + x;
+    for (i=0; i<3; i++)
+        for (j=0; j<3; j++) assert(x(i, j) == a(i, j) + a(j, i));
+    fill(x);
+    x = 2*x.t();
+    for (i=0; i<3; i++)
+        for (j=0; j<3; j++) assert(x(i, j) == 2*a(j, i));
+    fill(x);
+    x.view() = x.t();
+    for (i=0; i<3; i++)
+        for (j=0; j<3; j++) assert(x(i, j) == a(j, i));
+    fill(x);
+    x += 2*x.t();
+    for (i=0; i<3; i++)
+        for (j=0; j<3; j++) assert(x(i, j) == a(i, j) + 2*a(j, i));
+    fill(x);
+    ref = a*a + a;
+    x = x*x + x;
+    for (i=0; i<3; i++)
+        for (j=0; j<3; j++) assert(x(i, j) == ref(i, j));
+    //a row-shifted view of the same buffer overlaps without being the same view
+    slach::DynMatrix y(4, 3);
+    fill(y);
+    slach::MatrixView top(y.data(), 3, 3), bottom(y.data()+3, 3, 3);
+    bottom = top + bottom;
+    for (i=0; i<3; i++)
+        for (j=0; j<3; j++) assert(y(i+1, j) == (float)(i*3+j+1 + (i+1)*3+j+1));
+
+    return 0;
+}